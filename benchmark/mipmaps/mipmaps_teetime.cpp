@@ -22,6 +22,7 @@
 #include <teetime/stages/CollectorSink.h>
 #include <teetime/stages/DistributorStage.h>
 #include <teetime/stages/MergerStage.h>
+#include <teetime/stages/MipChainStage.h>
 #include <teetime/Configuration.h>
 #include <teetime/Image.h>
 #include <teetime/logging.h>
@@ -39,22 +40,7 @@ std::string getImageInputDirectory(int num, int size);
 std::string getImageOutputDirectory();
 
 namespace {
-  struct MipMapTask
-  {
-    MipMapTask() = default;
-    MipMapTask(const MipMapTask&) = default;
-    MipMapTask(MipMapTask&& task)
-      : sourceImage(std::move(task.sourceImage))
-      , filename(std::move(task.filename))
-      , level(task.level)
-    {}
-
-    shared_ptr<const Image> sourceImage;
-    std::string filename;
-    size_t level;
-  };
-
-  class Producer : public AbstractProducerStage<MipMapTask>
+  class Producer : public AbstractProducerStage<Image>
   {
   public:
     Producer(int num, int size)
@@ -75,62 +61,35 @@ namespace {
         if (!bf.load(dir + "/" +f))
           continue;
 
-        auto image = std::make_shared<Image>();
-        if (!image->loadFromMemory(bf.data(), bf.size(), bf.path()))
+        //the relative name becomes the filename of all mip levels (see MipLevel)
+        Image image;
+        if (!image.loadFromMemory(bf.data(), bf.size(), f.c_str()))
           continue;
 
-        size_t level = 0;
-        size_t width = image->getWidth();
-        size_t height = image->getHeight();
-
-
-
-        while (height > 0 || width > 0)
-        {
-          MipMapTask task;
-          task.sourceImage = image;
-          task.filename = f;
-          task.level = level;
-
-          getOutputPort().send(std::move(task));
-
-          level += 1;
-          width /= 2;
-          height /= 2;
-        }
+        getOutputPort().send(std::move(image));
       }
 
-      AbstractProducerStage<MipMapTask>::terminate();
+      AbstractProducerStage<Image>::terminate();
     }
 
     int m_size;
     int m_num;
   };
 
-  class MipMap : public AbstractFilterStage<MipMapTask, std::string>
+  class SaveMipLevel : public AbstractFilterStage<MipLevel, std::string>
   {
   public:
-    MipMap()
+    SaveMipLevel()
       : m_outputdir(getImageOutputDirectory())
     {
     }
 
   private:
-    virtual void execute(MipMapTask&& task) override
+    virtual void execute(MipLevel&& level) override
     {
-      if (!task.sourceImage)
-        return;
-
-      size_t width = task.sourceImage->getWidth() / (size_t(1) << task.level);
-      size_t height = task.sourceImage->getHeight() / (size_t(1) << task.level);
-      width = std::max<size_t>(width, 1);
-      height = std::max<size_t>(height, 1);
-
-      auto image = task.sourceImage->resize(width, height);
-
       char filename[256];
-      sprintf(filename, "%s/%d_%s", m_outputdir.c_str(), static_cast<int>(task.level), task.filename.c_str());
-      image.saveToPngFile(filename);
+      sprintf(filename, "%s/%d_%s", m_outputdir.c_str(), static_cast<int>(level.level), level.filename.c_str());
+      level.image.saveToPngFile(filename);
 
       getOutputPort().send(std::string(filename));
     }
@@ -149,7 +108,7 @@ namespace {
       CpuDispenser cpus(affinity);
 
       auto producer = createStage<Producer>(num, size);
-      auto dist = createStage<DistributorStage<MipMapTask>>();
+      auto dist = createStage<DistributorStage<Image>>();
       auto merger = createStage<MergerStage<std::string>>();
       auto sink = createStage<CollectorSink<std::string>>();
 
@@ -159,12 +118,15 @@ namespace {
       connectPorts(producer->getOutputPort(), dist->getInputPort());
       connectPorts(merger->getOutputPort(), sink->getInputPort());
 
+      //each worker derives all levels of an image from the previous level (see MipChainStage)
       for (int i = 0; i < threads; ++i)
       {
-        auto mipmap = createStage<MipMap>();
-        declareStageActive(mipmap);
-        connectPorts(dist->getNewOutputPort(), mipmap->getInputPort());
-        connectPorts(mipmap->getOutputPort(), merger->getNewInputPort());
+        auto mipchain = createStage<MipChainStage>();
+        auto save = createStage<SaveMipLevel>();
+        declareStageActive(mipchain);
+        connectPorts(dist->getNewOutputPort(), mipchain->getInputPort());
+        connectPorts(mipchain->getOutputPort(), save->getInputPort());
+        connectPorts(save->getOutputPort(), merger->getNewInputPort());
       }
     }
   };
@@ -0,0 +1,157 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "common.h"
+#include "platform.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace teetime
+{
+  class FileBuffer;
+
+  /**
+   * Archives store many (small) files in a few large segment files, to avoid per-file
+   * metadata operations (open, create, close, directory updates).
+   * An archive 'base' consists of:
+   *   - segment files 'base.seg0', 'base.seg1', ...: the concatenated content of all entries
+   *   - index file 'base.idx': name, segment, offset and length of each entry (in host byte order)
+   */
+
+  /**
+   * Location of an archive entry.
+   */
+  struct ArchiveEntry
+  {
+    std::string name;
+    uint32 segment;
+    uint64 offset;
+    uint64 length;
+  };
+
+  /**
+   * Appends entries to a new archive.
+   */
+  class ArchiveWriter final
+  {
+  public:
+    static const uint64 DefaultSegmentSize = uint64(1) << 30;
+    static const size_t DefaultBufferSize = 1024 * 1024;
+
+    /**
+     * @param segmentSize segment files are not grown beyond this size (unless a single entry is bigger)
+     * @param bufferSize entries are collected in a buffer of this size, before they are written
+     */
+    explicit ArchiveWriter(uint64 segmentSize = DefaultSegmentSize, size_t bufferSize = DefaultBufferSize);
+    ~ArchiveWriter();
+
+    ArchiveWriter(const ArchiveWriter&) = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    /**
+     * Create a new archive (existing files are overwritten).
+     */
+    bool open(const std::string& basePath);
+
+    /**
+     * Append an entry.
+     */
+    bool add(const std::string& name, const uint8* data, size_t size);
+
+    /**
+     * Flush all buffered content and write the index.
+     */
+    bool close();
+
+    bool isOpen() const;
+
+  private:
+    bool flush();
+    bool nextSegment();
+
+    const uint64              m_segmentSize;
+    std::vector<uint8>        m_buffer;
+    std::string               m_basePath;
+    platform::FileHandle      m_segment;
+    uint32                    m_segmentIndex;
+    uint64                    m_segmentOffset; //offset of m_buffer within current segment
+    std::vector<ArchiveEntry> m_entries;
+  };
+
+  /**
+   * Reads entries of an existing archive. Each entry is read by a single positional read.
+   * Reading is threadsafe.
+   */
+  class ArchiveReader final
+  {
+  public:
+    ArchiveReader() = default;
+    ~ArchiveReader();
+
+    ArchiveReader(const ArchiveReader&) = delete;
+    ArchiveReader& operator=(const ArchiveReader&) = delete;
+
+    bool open(const std::string& basePath);
+    void close();
+
+    /**
+     * @return entry of the given name, nullptr if archive has no such entry
+     */
+    const ArchiveEntry* find(const std::string& name) const;
+
+    /**
+     * Read the content of an entry. 'buffer.path' is set to the name of the entry.
+     */
+    bool read(const ArchiveEntry& entry, FileBuffer& buffer) const;
+    bool read(const std::string& name, FileBuffer& buffer) const;
+
+    /**
+     * All entries, in the order they have been added to the archive.
+     */
+    const std::vector<ArchiveEntry>& entries() const
+    {
+      return m_entries;
+    }
+
+    const std::string& basePath() const
+    {
+      return m_basePath;
+    }
+
+  private:
+    std::string                             m_basePath;
+    std::vector<ArchiveEntry>               m_entries;
+    std::unordered_map<std::string, size_t> m_lookup;
+    std::vector<platform::FileHandle>       m_segments;
+  };
+
+  /**
+   * Load the index of an archive.
+   * @return false if index is missing or corrupt
+   */
+  bool readArchiveIndex(const std::string& basePath, std::vector<ArchiveEntry>& entries);
+
+  inline std::string archiveSegmentPath(const std::string& basePath, uint32 segment)
+  {
+    return basePath + ".seg" + std::to_string(segment);
+  }
+
+  inline std::string archiveIndexPath(const std::string& basePath)
+  {
+    return basePath + ".idx";
+  }
+}
@@ -15,6 +15,7 @@
 */
 #pragma once
 #include <teetime/common.h>
+#include <teetime/MappedFileBuffer.h>
 #include <vector>
 #include <string>
 
@@ -34,6 +35,7 @@ namespace teetime
     BufferedFile(BufferedFile&& f)
       : m_path(std::move(f.m_path))
       , m_bytes(std::move(f.m_bytes))
+      , m_mapped(std::move(f.m_mapped))
     {
     }
 
@@ -41,6 +43,7 @@ namespace teetime
     {
       m_path = std::move(f.m_path);
       m_bytes = std::move(f.m_bytes);
+      m_mapped = std::move(f.m_mapped);
       return *this;
     }
 
@@ -49,11 +52,11 @@ namespace teetime
     }
 
     size_t size() const {
-      return m_bytes.size();
+      return m_mapped.size() > 0 ? m_mapped.size() : m_bytes.size();
     }
 
     const uint8* data() const {
-      return m_bytes.data();
+      return m_mapped.size() > 0 ? m_mapped.data() : m_bytes.data();
     }
 
     bool load(const char* path);
@@ -63,8 +66,19 @@ namespace teetime
       return load(path.c_str());
     }
 
+    /**
+     * Like 'load', but maps the file read-only into memory instead of copying it.
+     */
+    bool map(const char* path);
+
+    bool map(const std::string& path)
+    {
+      return map(path.c_str());
+    }
+
   private:
     std::string m_path;
     std::vector<uint8> m_bytes;
+    MappedFileBuffer m_mapped;
   };
 }
\ No newline at end of file
@@ -15,12 +15,17 @@
  */
 #pragma once
 #include "stages/AbstractStage.h"
+#include "stages/DistributorStage.h"
+#include "stages/MergerStage.h"
 #include "pipes/SpscValueQueue.h"
 #include "pipes/SynchedPipe.h"
 #include "pipes/UnsynchedPipe.h"
+#include "MemoryBudget.h"
+#include <algorithm>
 #include <map>
 #include <set>
 #include <type_traits>
+#include <vector>
 #include <functional>
 
 namespace teetime
@@ -61,23 +66,30 @@ namespace internal
   };
 
   using CreatePipeCallback = void*(size_t capacity, bool synched);
-  using ConnectCallback = void(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, bool synched);
+  using ConnectCallback = void(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, size_t byteCapacity, bool synched, const shared_ptr<MemoryBudget>& budget);
 
   template<typename T>
-  void connectPortsCallback(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, bool synched)
+  void connectPortsCallback(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, size_t byteCapacity, const std::function<size_t(const T&)>& sizeOf, bool synched, const shared_ptr<MemoryBudget>& budget)
   {
     auto typed_out = unsafe_dynamic_cast<OutputPort<T>>(out);
     auto typed_in = unsafe_dynamic_cast<InputPort<T>>(in);
 
     if (synched)
     {
-      typed_out->m_pipe.reset(new SynchedPipe<T, SpscValueQueue>((uint32)capacity));
+      auto pipe = new SynchedPipe<T, SpscValueQueue>((uint32)capacity, budget);
+      typed_out->m_pipe.reset(pipe);
+
+      if (byteCapacity > 0 || sizeOf)
+      {
+        pipe->setByteCapacity(byteCapacity, sizeOf);
+      }
     }
     else
     {
       typed_out->m_pipe.reset(new UnsynchedPipe<T>(typed_in->owner()));
     }
 
+    typed_out->m_pipe->setSender(typed_out->owner());
     typed_in->m_pipe = typed_out->m_pipe.get();
   }
 }
@@ -106,6 +118,28 @@ namespace internal
      */
     void executeBlocking();
 
+    /**
+     * Cancel execution. All stages discard their input from now on and producer stages
+     * are asked to terminate as soon as possible. Can be called from any thread, while
+     * the configuration is executing.
+     */
+    void cancel();
+
+    /**
+     * Limit the total number of bytes queued up in all synched pipes of this configuration.
+     * Once the budget is exhausted, stages sending into a synched pipe are stalled until downstream
+     * stages have consumed enough elements. To avoid deadlocks, an empty pipe always accepts one element,
+     * so the number of queued bytes is bounded by the budget plus one element per pipe.
+     * Element sizes are determined by 'elementSize'. Must be called before 'executeBlocking'.
+     * @param bytes maximum number of queued bytes, 0 to disable the budget (default).
+     */
+    void setMemoryBudget(size_t bytes);
+
+    /**
+     * @return memory budget of this configuration or nullptr, if no budget was set.
+     */
+    shared_ptr<const MemoryBudget> getMemoryBudget() const;
+
   protected:
     //create arbitrary stage
     template<typename T, typename ...TArgs>
@@ -171,6 +205,26 @@ namespace internal
      */
     template<typename T, template<typename> class TQueue = SpscValueQueue>
     void connectPorts(OutputPort<T>& output, InputPort<T>& input, size_t capacity = 1024)
+    {
+      connectPorts<T, TQueue>(output, input, capacity, 0);
+    }
+
+    /**
+     * @brief connect an output port to an input port. Connection is automatically
+     *        synched if the stages are running in different threads.
+     *        If synched, the connection is bounded by the number of queued elements
+     *        and by the number of queued bytes, whatever limit is reached first.
+     * @param output output port
+     * @param input input port
+     * @param capacity queue capacity in elements (if connection must be synched by a queue/pipe)
+     * @param byteCapacity queue capacity in bytes (if connection must be synched by a queue/pipe), 0 for no limit.
+     *                     If the queue is empty, one element is always accepted, no matter how big it is.
+     * @param sizeOf function to determine the size of an element in bytes. If empty, 'elementSize' is used.
+     * @tparam T element type to be passed from output to input
+     * @tparam TQueue queue implementation to use for synched pipe
+     */
+    template<typename T, template<typename> class TQueue = SpscValueQueue>
+    void connectPorts(OutputPort<T>& output, InputPort<T>& input, size_t capacity, size_t byteCapacity, typename SynchedPipe<T, TQueue>::SizeFunction sizeOf = nullptr)
     {
       if (isPortConnected(output)) {
         throw std::logic_error("output port is already connected");
@@ -185,7 +239,10 @@ namespace internal
       ca.in = &input;
       ca.out = &output;
       ca.capacity = capacity;
-      ca.connectCallback = &internal::connectPortsCallback<T>;
+      ca.byteCapacity = byteCapacity;
+      ca.connectCallback = [sizeOf](AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, size_t byteCapacity, bool synched, const shared_ptr<MemoryBudget>& budget) {
+        internal::connectPortsCallback<T>(out, in, capacity, byteCapacity, sizeOf, synched, budget);
+      };
       m_connections.push_back(ca);
 
       //make sure, both stages are known to the configuration
@@ -193,6 +250,62 @@ namespace internal
       m_stages.insert(input.owner()->shared_from_this());
     }
 
+    /**
+     * @brief connect one output port to many input ports by a tree of distributor stages.
+     *        Each distributor feeds at most 'fanOut' ports, so no single thread has to serve
+     *        all input ports. All distributors are declared active. A distributor's CPU affinity
+     *        is the union of the affinities of the stages it (transitively) feeds, so declare
+     *        those stages active before calling this method to let the tree follow their placement.
+     * @param output output port
+     * @param inputs input ports to distribute elements to
+     * @param fanOut maximum number of output ports per distributor (must be at least 2)
+     * @param capacity queue capacity of each connection
+     * @tparam T element type
+     * @tparam TDistributionPolicy distribution policy used by every distributor of the tree
+     */
+    template<typename T, typename TDistributionPolicy = BlockingRoundRobinDistribution<T>>
+    void connectPortsFanOut(OutputPort<T>& output, const std::vector<InputPort<T>*>& inputs, size_t fanOut = 8, size_t capacity = 1024)
+    {
+      if (inputs.empty()) {
+        throw std::logic_error("no input ports to connect to");
+      }
+
+      if (fanOut < 2) {
+        throw std::logic_error("fan-out must be at least 2");
+      }
+
+      unsigned cpus = 0;
+      InputPort<T>& root = createFanOutTree<T, TDistributionPolicy>(inputs.data(), inputs.size(), fanOut, capacity, cpus);
+      connectPorts(output, root, capacity);
+    }
+
+    /**
+     * @brief connect many output ports to one input port by a tree of merger stages.
+     *        Each merger reads from at most 'fanIn' ports. All mergers are declared active.
+     *        A merger's CPU affinity is the union of the affinities of the stages it (transitively)
+     *        reads from, so declare those stages active before calling this method.
+     * @param outputs output ports to merge
+     * @param input input port
+     * @param fanIn maximum number of input ports per merger (must be at least 2)
+     * @param capacity queue capacity of each connection
+     * @tparam T element type
+     */
+    template<typename T>
+    void connectPortsFanIn(const std::vector<OutputPort<T>*>& outputs, InputPort<T>& input, size_t fanIn = 8, size_t capacity = 1024)
+    {
+      if (outputs.empty()) {
+        throw std::logic_error("no output ports to connect from");
+      }
+
+      if (fanIn < 2) {
+        throw std::logic_error("fan-in must be at least 2");
+      }
+
+      unsigned cpus = 0;
+      OutputPort<T>& root = createFanInTree<T>(outputs.data(), outputs.size(), fanIn, capacity, cpus);
+      connectPorts(root, input, capacity);
+    }
+
     /**
      * Declare stage active.
      * @param stage stage to make active
@@ -216,12 +329,123 @@ namespace internal
      */
     bool isPortConnected(const AbstractOutputPort& port) const;
 
+    /**
+     * @return CPU affinity mask of the given stage, 0 if it has no affinity (or is not active).
+     */
+    unsigned getCpuAffinity(const AbstractStage* stage) const;
+
+    /**
+     * @return all stages known to this configuration (including stages created by fan-out/fan-in trees).
+     */
+    std::vector<shared_ptr<AbstractStage>> getStages() const;
+
   private:
     /**
      * Instantiate all port connections by creating pipes.
      */
     void createConnections();
 
+    /**
+     * Build (sub)tree of distributors feeding the given input ports.
+     * @param cpus receives the union of the CPU affinities of all stages fed by the subtree,
+     *        0 (no affinity) if any of them has no affinity.
+     * @return input port of the root of the subtree.
+     */
+    template<typename T, typename TDistributionPolicy>
+    InputPort<T>& createFanOutTree(InputPort<T>* const* inputs, size_t count, size_t fanOut, size_t capacity, unsigned& cpus)
+    {
+      assert(count > 0);
+
+      if (count == 1)
+      {
+        cpus = getCpuAffinity(inputs[0]->owner());
+        return *inputs[0];
+      }
+
+      auto distributor = createStage<DistributorStage<T, TDistributionPolicy>>("FanOutDistributorStage");
+
+      //split ports into (at most) 'fanOut' subtrees of about the same size
+      const size_t numChildren = std::min(fanOut, count);
+      size_t first = 0;
+      bool unrestricted = false;
+      cpus = 0;
+
+      for (size_t i = 0; i < numChildren; ++i)
+      {
+        const size_t childCount = count / numChildren + (i < count % numChildren ? 1 : 0);
+
+        unsigned childCpus = 0;
+        InputPort<T>& child = createFanOutTree<T, TDistributionPolicy>(inputs + first, childCount, fanOut, capacity, childCpus);
+        connectPorts(distributor->getNewOutputPort(), child, capacity);
+
+        //a child without affinity may run on any CPU, so the parent must not be restricted either
+        if (childCpus == 0)
+          unrestricted = true;
+
+        cpus |= childCpus;
+        first += childCount;
+      }
+
+      assert(first == count);
+
+      if (unrestricted)
+        cpus = 0;
+
+      declareStageActive(distributor, cpus);
+
+      return distributor->getInputPort();
+    }
+
+    /**
+     * Build (sub)tree of mergers reading from the given output ports.
+     * @param cpus receives the union of the CPU affinities of all stages read by the subtree,
+     *        0 (no affinity) if any of them has no affinity.
+     * @return output port of the root of the subtree.
+     */
+    template<typename T>
+    OutputPort<T>& createFanInTree(OutputPort<T>* const* outputs, size_t count, size_t fanIn, size_t capacity, unsigned& cpus)
+    {
+      assert(count > 0);
+
+      if (count == 1)
+      {
+        cpus = getCpuAffinity(outputs[0]->owner());
+        return *outputs[0];
+      }
+
+      auto merger = createStage<MergerStage<T>>("FanInMergerStage");
+
+      const size_t numChildren = std::min(fanIn, count);
+      size_t first = 0;
+      bool unrestricted = false;
+      cpus = 0;
+
+      for (size_t i = 0; i < numChildren; ++i)
+      {
+        const size_t childCount = count / numChildren + (i < count % numChildren ? 1 : 0);
+
+        unsigned childCpus = 0;
+        OutputPort<T>& child = createFanInTree<T>(outputs + first, childCount, fanIn, capacity, childCpus);
+        connectPorts(child, merger->getNewInputPort(), capacity);
+
+        //a child without affinity may run on any CPU, so the parent must not be restricted either
+        if (childCpus == 0)
+          unrestricted = true;
+
+        cpus |= childCpus;
+        first += childCount;
+      }
+
+      assert(first == count);
+
+      if (unrestricted)
+        cpus = 0;
+
+      declareStageActive(merger, cpus);
+
+      return merger->getOutputPort();
+    }
+
     /**
      * settings associated with a single stage.
      */
@@ -243,8 +467,9 @@ namespace internal
       AbstractOutputPort* out; //output port
       AbstractInputPort* in; //input port
       size_t capacity; //queue capacity
+      size_t byteCapacity; //queue capacity in bytes (0 = unlimited)
       internal::CreatePipeCallback* createPipeCallback;
-      internal::ConnectCallback* connectCallback;
+      std::function<internal::ConnectCallback> connectCallback;
     };
 
     //all connections between ports.
@@ -257,5 +482,8 @@ namespace internal
 
     //lookup map to store settings for each stage.
     std::map<AbstractStage*, stageSettings> m_stageSettings;
+
+    //shared by all synched pipes (optional)
+    shared_ptr<MemoryBudget> m_memoryBudget;
   };
 }
\ No newline at end of file
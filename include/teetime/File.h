@@ -55,4 +55,28 @@ namespace teetime
 
     std::string path;
   };
+
+  /**
+   * Path relative to the given base directory (the directory prefix and following separators are removed).
+   * Returns 'path' unchanged, if it is not inside the base directory (or the base directory is empty).
+   */
+  inline std::string relativePath(const std::string& path, const std::string& baseDirectory)
+  {
+    if (baseDirectory.empty() || path.compare(0, baseDirectory.size(), baseDirectory) != 0)
+      return path;
+
+    auto isSeparator = [](char c) { return c == '/' || c == '\\'; };
+
+    //prefix must end at a path separator ('dir' is no base of 'dir2/file')
+    size_t start = baseDirectory.size();
+    if (start < path.size() && !isSeparator(baseDirectory.back()) && !isSeparator(path[start]))
+      return path;
+
+    while (start < path.size() && isSeparator(path[start]))
+    {
+      ++start;
+    }
+
+    return path.substr(start);
+  }
 }
\ No newline at end of file
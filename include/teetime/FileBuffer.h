@@ -17,6 +17,7 @@
 #include <string>
 #include <vector>
 #include "common.h"
+#include "RecyclingPool.h"
 
 namespace teetime
 {
@@ -36,4 +37,17 @@ namespace teetime
      */
     std::vector<uint8> bytes;
   };
+
+  /**
+   * Pool of spent file contents (see FileBuffer::bytes), to reuse their memory.
+   */
+  using FileBufferPool = RecyclingPool<std::vector<uint8>>;
+
+  /**
+   * Size of a file buffer in bytes (see MemoryBudget).
+   */
+  inline size_t elementSize(const FileBuffer& buffer)
+  {
+    return sizeof(FileBuffer) + buffer.bytes.size();
+  }
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <string>
+#include <vector>
+#include "common.h"
+
+namespace teetime
+{
+  /**
+   * Part of a file's content.
+   */
+  class FileChunk
+  {
+  public:
+    FileChunk()
+      : offset(0)
+      , last(false)
+    {}
+
+    /**
+     * Original file path.
+     */
+    std::string path;
+
+    /**
+     * Position of this chunk within the file.
+     */
+    uint64 offset;
+
+    /**
+     * Chunk content.
+     */
+    std::vector<uint8> bytes;
+
+    /**
+     * True if this is the last chunk of the file (end of file).
+     */
+    bool last;
+  };
+
+  /**
+   * Size of a file chunk in bytes (see MemoryBudget).
+   */
+  inline size_t elementSize(const FileChunk& chunk)
+  {
+    return sizeof(FileChunk) + chunk.bytes.size();
+  }
+}
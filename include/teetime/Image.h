@@ -16,6 +16,7 @@
 #pragma once
 #include "common.h"
 #include <string>
+#include <vector>
 
 namespace teetime
 {
@@ -26,11 +27,55 @@ namespace teetime
   {
     Png,
     Tga,
-    Bmp
+    Bmp,
+    Qoi  //lossless and fast to encode/decode, meant for intermediate results (see QoiCodec.h)
+  };
+
+  /**
+   * Pixel layouts, 8 bit per channel, channels are interleaved.
+   */
+  enum class PixelFormat
+  {
+    Gray8,
+    GrayAlpha8,
+    Rgb8,
+    Rgba8
+  };
+
+  inline unsigned numChannels(PixelFormat format)
+  {
+    return static_cast<unsigned>(format) + 1;
+  }
+
+  inline bool hasAlpha(PixelFormat format)
+  {
+    return format == PixelFormat::GrayAlpha8 || format == PixelFormat::Rgba8;
+  }
+
+  /**
+   * Pixel format with the given number of channels (1 to 4).
+   */
+  inline PixelFormat pixelFormatFromChannels(unsigned channels)
+  {
+    assert(channels >= 1 && channels <= 4);
+    return static_cast<PixelFormat>(channels - 1);
+  }
+
+  /**
+   * Image properties read from the file header.
+   */
+  struct ImageInfo
+  {
+    size_t   width;
+    size_t   height;
+    unsigned channels; //channels stored in the file (see PixelFormat)
   };
 
   /**
    * Simple image class.
+   * Pixel memory comes from PixelPool::instance(), so buffers of destroyed images get reused.
+   * Images are RGBA by default. Loading with 'nativeFormat' keeps the channels stored in the file,
+   * so grayscale or RGB images need less memory.
    */
   class Image
   {
@@ -54,7 +99,18 @@ namespace teetime
 
     size_t getWidth() const;
     size_t getHeight() const;
-
+    PixelFormat getFormat() const;
+    unsigned getChannels() const;
+
+    /**
+     * Interleaved pixel data, rows are width * getChannels() bytes without padding.
+     */
+    const uint8* getPixels() const;
+    uint8*       getPixels();
+
+    /**
+     * Pixel data of an Rgba8 image.
+     */
     const Rgba* getRgba() const;
     Rgba*       getRgba();
 
@@ -63,20 +119,69 @@ namespace teetime
     bool loadFromFile(const std::string& filename);
     bool loadFromMemory(const uint8* data, size_t dataSize, const char* filename);
 
+    /**
+     * Load an image at reduced resolution, width and height are divided by 'scale' (1, 2, 4 or 8) and rounded up.
+     * JPEGs are decoded at that resolution directly (only the low frequency part of each block is transformed),
+     * which is much faster than decoding the full image. Other formats are decoded and then shrunk.
+     * @param nativeFormat keep the channels stored in the file instead of converting to Rgba8
+     */
+    bool loadFromFile(const std::string& filename, unsigned scale, bool nativeFormat = false);
+    bool loadFromMemory(const uint8* data, size_t dataSize, const char* filename, unsigned scale, bool nativeFormat = false);
+
+    /**
+     * Read dimensions and channel count from the file header, without decoding pixels.
+     * @return false if the format is unknown or the header is broken.
+     */
+    static bool probe(const uint8* data, size_t dataSize, ImageInfo& info);
+    static bool probe(const std::string& filename, ImageInfo& info);
+
     bool saveToFile(const std::string& filename) const;
     bool saveToFile(const std::string& filename, ImageFileFormat format) const;
     bool saveToPngFile(const std::string& filename) const;
     bool saveToTgaFile(const std::string& filename) const;
     bool saveToBmpFile(const std::string& filename) const;
+    bool saveToQoiFile(const std::string& filename) const;
+
+    /**
+     * Encode this image into 'data' (replacing its content), instead of writing a file.
+     */
+    bool saveToMemory(ImageFileFormat format, std::vector<uint8>& data) const;
 
     void reset();
 
+    /**
+     * Change the dimensions (and format) of this image. The pixel buffer is kept if it is big enough,
+     * pixel content is undefined afterwards.
+     */
+    void setSize(size_t width, size_t height, PixelFormat format = PixelFormat::Rgba8);
+
     Image resize(size_t width, size_t height) const;
 
+    /**
+     * Resize this image into 'target' (which must be a different image), reusing target's pixel buffer.
+     * Power-of-two reductions (see countHalvingSteps) use a 2x2 box filter, other sizes stb_image_resize.
+     * @return true on success.
+     */
+    bool resizeInto(Image& target, size_t width, size_t height) const;
+
+    /**
+     * Convert the pixels to another format. Gray is derived from RGB by the Rec. 601 luma weights,
+     * missing alpha becomes opaque.
+     */
+    Image convert(PixelFormat format) const;
+    void convertInto(Image& target, PixelFormat format) const;
+
   private:
+    //take ownership of decoded pixels, shrink them by 'scale'
+    bool takePixels(uint8* pixels, int width, int height, int channels, unsigned scale, const std::string& filename);
+
+    //shrink the freshly decoded pixels by 'scale'
+    bool finishLoading(unsigned scale, const std::string& filename);
+
     size_t m_width;
     size_t m_height;
-    Rgba* m_data;
+    PixelFormat m_format;
+    uint8* m_data;
     std::string m_filename;
   };
 
@@ -90,18 +195,48 @@ namespace teetime
     return m_height;
   }
 
-  inline const Image::Rgba* Image::getRgba() const
+  inline PixelFormat Image::getFormat() const
+  {
+    return m_format;
+  }
+
+  inline unsigned Image::getChannels() const
+  {
+    return numChannels(m_format);
+  }
+
+  inline const uint8* Image::getPixels() const
   {
     return m_data;
   }
 
-  inline Image::Rgba* Image::getRgba()
+  inline uint8* Image::getPixels()
   {
     return m_data;
   }
 
+  inline const Image::Rgba* Image::getRgba() const
+  {
+    assert(m_format == PixelFormat::Rgba8);
+    return reinterpret_cast<const Rgba*>(m_data);
+  }
+
+  inline Image::Rgba* Image::getRgba()
+  {
+    assert(m_format == PixelFormat::Rgba8);
+    return reinterpret_cast<Rgba*>(m_data);
+  }
+
   inline std::string Image::getFilename() const
   {
     return m_filename;
   }
+
+  /**
+   * Size of an image in bytes (see MemoryBudget).
+   */
+  inline size_t elementSize(const Image& image)
+  {
+    return sizeof(Image) + image.getWidth() * image.getHeight() * image.getChannels();
+  }
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "PlanarImage.h"
+
+namespace teetime
+{
+  /**
+   * Luma of the color planes (same weights as Image::convert), alpha is kept.
+   * 'dst' becomes Gray8 or GrayAlpha8.
+   */
+  void grayscale(const PlanarImage& src, PlanarImage& dst);
+
+  /**
+   * Raise the color planes to the power of 1/gamma, alpha is not changed.
+   */
+  void gammaCorrect(PlanarImage& image, float gamma);
+
+  /**
+   * Kernel radius of gaussianBlur and sharpen: ceil(3 * sigma), at least 1.
+   * Tiles filtered separately (see ImageTile) need a halo of this size.
+   */
+  size_t gaussianRadius(float sigma);
+
+  /**
+   * Separable gaussian blur of all planes, kernel radius is gaussianRadius(sigma), edges are clamped.
+   * Color is weighted by alpha (blurred premultiplied, then divided by the blurred alpha), so colors of
+   * transparent pixels don't bleed into visible ones. Fully transparent results get color 0.
+   * 'src' and 'dst' must be different images.
+   */
+  void gaussianBlur(const PlanarImage& src, PlanarImage& dst, float sigma);
+
+  /**
+   * Unsharp mask: dst = src + amount * (src - gaussianBlur(src, sigma)) for the color planes, alpha is kept.
+   * The blur is alpha weighted like gaussianBlur, so transparent neighbours don't affect the sharpened color.
+   * 'src' and 'dst' must be different images.
+   */
+  void sharpen(const PlanarImage& src, PlanarImage& dst, float sigma, float amount);
+}
@@ -0,0 +1,62 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "Image.h"
+#include <vector>
+
+namespace teetime
+{
+  /**
+   * Size of an image dimension after halving (mip level convention): max(1, size/2).
+   */
+  inline size_t halfSize(size_t size)
+  {
+    return size > 1 ? size / 2 : 1;
+  }
+
+  /**
+   * Halve an RGBA image by averaging 2x2 blocks (rounded to nearest).
+   * Destination size is halfSize(srcWidth) x halfSize(srcHeight). For odd sizes, the last column (row)
+   * of the destination averages the last three source columns (rows), so no source pixel is dropped.
+   * Uses SSE2 or NEON if available.
+   * @param srcStride distance between source rows in pixels
+   * @param dstStride distance between destination rows in pixels
+   */
+  void downsample2x2(const Image::Rgba* src, size_t srcWidth, size_t srcHeight, size_t srcStride, Image::Rgba* dst, size_t dstStride);
+
+  /**
+   * Same as above, for images of any pixel format (Gray8 and GrayAlpha8 use SSE2 or NEON too).
+   * Strides are in pixels.
+   */
+  void downsample2x2(const uint8* src, size_t srcWidth, size_t srcHeight, size_t srcStride, uint8* dst, size_t dstStride, PixelFormat format);
+
+  /**
+   * Number of halving steps that turn an image of srcWidth x srcHeight into width x height.
+   * @return number of steps, 0 if the target size is no power-of-two reduction.
+   */
+  unsigned countHalvingSteps(size_t srcWidth, size_t srcHeight, size_t width, size_t height);
+
+  /**
+   * Create the mip levels 1, 2, ... of an image (each level halves the previous one, see downsample2x2).
+   * Levels have the pixel format of the source.
+   * Levels are computed row by row, interleaved: as soon as two rows of a level are available, the next
+   * row of the following level is derived from them. This way all levels are created in one pass over
+   * the source while the rows involved are still in cache.
+   * @param levels receives the levels (existing images are reused, see Image::setSize)
+   * @param maxLevels maximum number of levels, 0 creates all levels down to 1x1
+   */
+  void createMipChain(const Image& source, std::vector<Image>& levels, unsigned maxLevels = 0);
+}
@@ -0,0 +1,80 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "common.h"
+#include "Image.h"
+#include <vector>
+
+namespace teetime
+{
+  /**
+   * How the target image of tiled processing relates to the source image.
+   */
+  enum class ImageTileTarget
+  {
+    SameSize, //filters
+    HalfSize  //2x2 downsampling (see downsample2x2)
+  };
+
+  /**
+   * Rectangular part of an image, processed independently of the other tiles of the same image.
+   * A tile computes the pixels of its target region directly into the (shared, preallocated) target
+   * image, reading from its source region. The source region covers all source pixels the target
+   * region depends on, plus a halo (e.g. for filter kernels), clamped to the source image.
+   * Tiles of the same image write disjoint regions, so they can be processed by different threads.
+   */
+  struct ImageTile
+  {
+    shared_ptr<const Image> source;
+    shared_ptr<Image>       target;
+
+    //target region
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+
+    //source region (including halo)
+    size_t sourceX;
+    size_t sourceY;
+    size_t sourceWidth;
+    size_t sourceHeight;
+
+    //position among all tiles of the target image
+    size_t index;
+    size_t count;
+  };
+
+  /**
+   * Size of a tile in bytes (see MemoryBudget). Pixels are shared by all tiles, so only the tile itself is accounted.
+   */
+  inline size_t elementSize(const ImageTile&)
+  {
+    return sizeof(ImageTile);
+  }
+
+  /**
+   * Split an image into tiles of (at most) tileSize x tileSize target pixels.
+   * Allocates the target image.
+   */
+  std::vector<ImageTile> createImageTiles(shared_ptr<const Image> source, size_t tileSize, size_t halo, ImageTileTarget mode);
+
+  /**
+   * Compute the target region of a tile by 2x2 downsampling (tile must be created with ImageTileTarget::HalfSize).
+   * The result is identical to downsampling the whole image at once.
+   */
+  ImageTile downsampleTile(ImageTile tile);
+}
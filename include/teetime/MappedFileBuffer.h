@@ -0,0 +1,87 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <string>
+#include "common.h"
+
+namespace teetime
+{
+  /**
+   * Read-only file content, mapped into memory instead of being copied to the heap.
+   * Bytes are read straight from the page cache. Copies share the same mapping,
+   * the file is unmapped once the last copy has been destroyed.
+   */
+  class MappedFileBuffer
+  {
+  public:
+    MappedFileBuffer();
+
+    /**
+     * Original file path.
+     */
+    std::string path;
+
+    /**
+     * Map the file at the given path. Replaces any previous mapping of this buffer.
+     * @return true if file was mapped successfully (or is empty).
+     */
+    bool map(const char* path);
+
+    bool map(const std::string& path)
+    {
+      return map(path.c_str());
+    }
+
+    /**
+     * Zero-copy view of a range of this buffer. The view shares (and keeps alive) the mapping.
+     * @param offset first byte of the view
+     * @param size number of bytes, offset + size must not exceed size()
+     * @param path path of the view
+     */
+    MappedFileBuffer slice(size_t offset, size_t size, const std::string& path) const;
+
+    /**
+     * Drop the mapping of this buffer.
+     */
+    void reset();
+
+    /**
+     * File content, nullptr for empty files.
+     */
+    const uint8* data() const
+    {
+      return m_data.get();
+    }
+
+    size_t size() const
+    {
+      return m_size;
+    }
+
+  private:
+    shared_ptr<const uint8> m_data;
+    size_t m_size;
+  };
+
+  /**
+   * Size of a mapped file buffer in bytes (see MemoryBudget).
+   * Mapped pages belong to the page cache, so only the buffer object itself is accounted.
+   */
+  inline size_t elementSize(const MappedFileBuffer&)
+  {
+    return sizeof(MappedFileBuffer);
+  }
+}
@@ -0,0 +1,135 @@
+/**
+ * Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "common.h"
+#include "platform.h"
+#include <atomic>
+#include <thread>
+
+namespace teetime
+{
+  /**
+   * Size of a data element in bytes, used to account for queued elements.
+   * Overload this function for your own element types (in the namespace of that type),
+   * if their memory footprint is not reflected by 'sizeof'.
+   */
+  template<typename T>
+  size_t elementSize(const T&)
+  {
+    return sizeof(T);
+  }
+
+  /**
+   * Byte budget shared by multiple pipes.
+   * Tracks the number of bytes currently queued. Reservations beyond the capacity
+   * are rejected, except if the budget is completely unused. This way a single element
+   * that exceeds the whole budget can still pass (one at a time).
+   * Access is threadsafe and lock-free.
+   */
+  class MemoryBudget final
+  {
+  public:
+    explicit MemoryBudget(size_t capacity)
+      : m_capacity(capacity)
+      , m_used(0)
+    {
+    }
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    /**
+     * Try to reserve bytes. Does not block.
+     * @return true if bytes were reserved, false if budget is exhausted.
+     */
+    bool tryAcquire(size_t bytes)
+    {
+      size_t used = m_used.load(std::memory_order_relaxed);
+
+      do
+      {
+        if (used > 0 && used + bytes > m_capacity)
+        {
+          return false;
+        }
+      } while (!m_used.compare_exchange_weak(used, used + bytes, std::memory_order_relaxed));
+
+      return true;
+    }
+
+    /**
+     * Reserve bytes. Blocks until the budget has enough room left.
+     */
+    void acquire(size_t bytes)
+    {
+      acquire(bytes, [] { return false; });
+    }
+
+    /**
+     * Reserve bytes. Blocks until the budget has enough room left or 'mayExceed' returns true,
+     * in the latter case the bytes are reserved even if that exceeds the capacity.
+     */
+    template<typename F>
+    void acquire(size_t bytes, F mayExceed)
+    {
+      while (!tryAcquire(bytes))
+      {
+        if (mayExceed())
+        {
+          forceAcquire(bytes);
+          return;
+        }
+
+        std::this_thread::yield();
+      }
+    }
+
+    /**
+     * Reserve bytes, even if that exceeds the capacity. Never blocks.
+     */
+    void forceAcquire(size_t bytes)
+    {
+      m_used.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /**
+     * Give back previously reserved bytes.
+     */
+    void release(size_t bytes)
+    {
+      assert(m_used.load(std::memory_order_relaxed) >= bytes);
+      m_used.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const
+    {
+      return m_capacity;
+    }
+
+    size_t used() const
+    {
+      return m_used.load(std::memory_order_relaxed);
+    }
+
+  private:
+    const size_t m_capacity;
+
+    //make sure counter is stored on it's own cacheline.
+    char _padding0[platform::CacheLineSize];
+    std::atomic<size_t> m_used;
+    char _padding1[platform::CacheLineSize];
+  };
+}
@@ -0,0 +1,115 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "common.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace teetime
+{
+  /**
+   * Size-class pool for pixel memory (and the decoders' temporary buffers).
+   * Block sizes are rounded up to the next size class (4 per power of two, so at most 25% and
+   * typically about 12% are wasted), released blocks are kept per size class and handed out again
+   * by 'allocate'. This way, processing images of recurring sizes allocates nothing in steady state,
+   * and reused blocks are already paged in.
+   * Small blocks (< 4 KB, mostly the codecs' temporary buffers) are passed straight to malloc
+   * and never take the pool's lock.
+   * Blocks can be released by any thread. Access is threadsafe.
+   */
+  class PixelPool final
+  {
+  public:
+    static const size_t DefaultCapacity = 64 * 1024 * 1024;
+
+    /**
+     * @param capacity maximum number of bytes kept in the pool. 0 disables pooling.
+     */
+    explicit PixelPool(size_t capacity = DefaultCapacity);
+    ~PixelPool();
+
+    PixelPool(const PixelPool&) = delete;
+    PixelPool& operator=(const PixelPool&) = delete;
+
+    /**
+     * Pool used by Image (and the image codecs).
+     */
+    static PixelPool& instance();
+
+    /**
+     * Allocate a block of at least 'size' bytes (16 byte aligned).
+     * @return block, nullptr if out of memory
+     */
+    void* allocate(size_t size);
+
+    /**
+     * Grow or shrink a block (like realloc). Content is preserved up to the smaller size.
+     */
+    void* reallocate(void* block, size_t size);
+
+    /**
+     * Give a block back to the pool. nullptr is ignored.
+     */
+    void release(void* block);
+
+    /**
+     * Usable size of a block, may be bigger than requested.
+     */
+    static size_t blockSize(const void* block);
+
+    /**
+     * Change the capacity, surplus blocks are freed.
+     */
+    void setCapacity(size_t capacity);
+    size_t capacity() const;
+
+    /**
+     * Number of bytes currently kept in the pool (free blocks).
+     */
+    size_t pooledBytes() const;
+
+    /**
+     * Free all pooled blocks.
+     */
+    void clear();
+
+    /**
+     * Number of bytes currently handed out (allocated and not released yet), small blocks included.
+     */
+    size_t usedBytes() const;
+
+    /**
+     * Maximum of usedBytes() since the pool was created or resetPeakUsedBytes() was called.
+     */
+    size_t peakUsedBytes() const;
+    void resetPeakUsedBytes();
+
+  private:
+    //4 KB up to 2 GB, 4 size classes per octave
+    static const unsigned NumSizeClasses = 76;
+
+    void trim();
+    void addUsedBytes(size_t bytes);
+
+    mutable std::mutex m_mutex;
+    size_t             m_capacity;
+    size_t             m_pooledBytes;
+    std::atomic<size_t> m_usedBytes;
+    std::atomic<size_t> m_peakUsedBytes;
+    std::vector<void*> m_blocks[NumSizeClasses];
+  };
+}
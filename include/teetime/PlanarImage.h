@@ -0,0 +1,118 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "common.h"
+#include "Image.h"
+#include <vector>
+
+namespace teetime
+{
+  /**
+   * Image stored as one float plane per channel (structure of arrays), values are in [0, 1].
+   * Per-pixel math on planes consists of plain loops over contiguous floats, which the compiler
+   * turns into full width vector instructions (see TEETIME_ENABLE_NATIVE_ARCH).
+   * Convert from and to interleaved images with deinterleave() and interleave().
+   */
+  class PlanarImage
+  {
+  public:
+    PlanarImage();
+
+    /**
+     * Change dimensions and format, the memory is kept if it is big enough.
+     * Plane content is undefined afterwards.
+     */
+    void setSize(size_t width, size_t height, PixelFormat format);
+
+    size_t getWidth() const;
+    size_t getHeight() const;
+    PixelFormat getFormat() const;
+    unsigned getNumPlanes() const;
+
+    /**
+     * True if the last plane holds alpha (GrayAlpha8, Rgba8).
+     */
+    bool hasAlpha() const;
+
+    const float* getPlane(unsigned index) const;
+    float*       getPlane(unsigned index);
+
+    /**
+     * Set this image to the content of 'image' (any pixel format).
+     */
+    void deinterleave(const Image& image);
+
+    /**
+     * Set this image to the region (x, y, width, height) of 'image' (e.g. the source region of an ImageTile).
+     */
+    void deinterleave(const Image& image, size_t x, size_t y, size_t width, size_t height);
+
+    /**
+     * Write this image into 'image', which gets the size and format of this image (its buffer is reused).
+     * Values are clamped to [0, 1] and rounded to 8 bit.
+     */
+    void interleave(Image& image) const;
+
+    /**
+     * Write the region (x, y, width, height) of this image into 'image' at (targetX, targetY), like interleave().
+     * 'image' must have the format of this image and contain the target region, its size is not changed.
+     */
+    void interleave(Image& image, size_t x, size_t y, size_t width, size_t height, size_t targetX, size_t targetY) const;
+
+  private:
+    size_t             m_width;
+    size_t             m_height;
+    PixelFormat        m_format;
+    std::vector<float> m_data;
+  };
+
+  inline size_t PlanarImage::getWidth() const
+  {
+    return m_width;
+  }
+
+  inline size_t PlanarImage::getHeight() const
+  {
+    return m_height;
+  }
+
+  inline PixelFormat PlanarImage::getFormat() const
+  {
+    return m_format;
+  }
+
+  inline unsigned PlanarImage::getNumPlanes() const
+  {
+    return numChannels(m_format);
+  }
+
+  inline bool PlanarImage::hasAlpha() const
+  {
+    return teetime::hasAlpha(m_format);
+  }
+
+  inline const float* PlanarImage::getPlane(unsigned index) const
+  {
+    assert(index < getNumPlanes());
+    return m_data.data() + index * m_width * m_height;
+  }
+
+  inline float* PlanarImage::getPlane(unsigned index)
+  {
+    assert(index < getNumPlanes());
+    return m_data.data() + index * m_width * m_height;
+  }
+}
@@ -0,0 +1,65 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "common.h"
+#include <string>
+#include <vector>
+
+namespace teetime
+{
+  class Image;
+
+  /**
+   * PNG row filters (see PNG specification, section 9).
+   */
+  enum class PngFilter
+  {
+    None,
+    Sub,
+    Up,
+    Average,
+    Paeth,
+    Adaptive,    //per row, the filter with the smallest sum of absolute differences (like stb_image_write)
+    AdaptiveFast //like Adaptive, but estimated on every 8th pixel only
+  };
+
+  struct PngEncodeOptions
+  {
+    PngEncodeOptions()
+      : numThreads(0)
+      , bandRows(0)
+      , compressionLevel(4)
+      , filter(PngFilter::Adaptive)
+    {}
+
+    unsigned  numThreads;       //0: one per hardware thread
+    size_t    bandRows;         //rows per band, 0: bands of about 1MiB
+    int       compressionLevel; //0 (stored, fastest) to 9 (smallest)
+    PngFilter filter;
+  };
+
+  /**
+   * Encode an image as PNG using multiple threads. The PNG color type follows the pixel format of the image.
+   * The image is split into bands of rows. Bands are filtered and deflated independently (each band
+   * may reference the previous 32KiB of data, like a single stream would), and each band ends with a
+   * sync flush, so the compressed bands simply concatenate into one valid zlib stream. Each band is
+   * written as its own IDAT chunk, the Adler-32 checksums of the bands are combined.
+   * @return true on success
+   */
+  bool encodePng(const Image& image, const PngEncodeOptions& options, std::vector<uint8>& png);
+
+  bool writePngFile(const Image& image, const std::string& filename, const PngEncodeOptions& options);
+}
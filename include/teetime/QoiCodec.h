@@ -0,0 +1,53 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "common.h"
+#include <string>
+#include <vector>
+
+namespace teetime
+{
+  class Image;
+  struct ImageInfo;
+
+  /**
+   * Encode an image in the QOI format ("Quite OK Image", see qoiformat.org). QOI is lossless and a lot
+   * faster to encode and decode than PNG (at the cost of bigger files), which makes it a good fit for
+   * intermediate results that are written and read back by the pipeline itself.
+   * QOI only knows RGB and RGBA: gray images are stored as RGB (or RGBA) with equal color channels.
+   * @return true on success
+   */
+  bool encodeQoi(const Image& image, std::vector<uint8>& qoi);
+
+  bool writeQoiFile(const Image& image, const std::string& filename);
+
+  /**
+   * Check the magic bytes of a QOI header.
+   */
+  bool isQoi(const uint8* data, size_t dataSize);
+
+  /**
+   * Read dimensions and channel count from a QOI header (the first 14 bytes of the file).
+   */
+  bool probeQoi(const uint8* data, size_t dataSize, ImageInfo& info);
+
+  /**
+   * Decode a QOI image into 'image', as Rgba8, or with the channels stored in the file (Rgb8 or Rgba8),
+   * if 'nativeFormat' is set.
+   * @return false if the data is not a valid QOI image or truncated ('image' is reset then).
+   */
+  bool decodeQoi(const uint8* data, size_t dataSize, Image& image, bool nativeFormat);
+}
@@ -0,0 +1,100 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "common.h"
+#include <mutex>
+#include <vector>
+
+namespace teetime
+{
+  /**
+   * Pool of spent objects (e.g. buffers), that can be reused instead of allocating new ones.
+   * Consumers put objects back by 'recycle', producers take them by 'take'. Objects keep their
+   * state (e.g. the capacity of a std::vector), so steady-state allocations on the hot path
+   * drop to zero. Share the pool between stages by a shared_ptr.
+   * Access is threadsafe.
+   * @tparam T type of pooled objects (must be movable)
+   */
+  template<typename T>
+  class RecyclingPool final
+  {
+  public:
+    /**
+     * @param capacity maximum number of pooled objects. Objects recycled into a full pool are destroyed.
+     */
+    explicit RecyclingPool(size_t capacity = 64)
+      : m_capacity(capacity)
+    {
+      m_objects.reserve(capacity);
+    }
+
+    RecyclingPool(const RecyclingPool&) = delete;
+    RecyclingPool& operator=(const RecyclingPool&) = delete;
+
+    /**
+     * Take a spent object from the pool.
+     * @return true if an object was taken, false if pool was empty ('value' is not modified in this case).
+     */
+    bool take(T& value)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+
+      if (m_objects.empty())
+        return false;
+
+      value = std::move(m_objects.back());
+      m_objects.pop_back();
+      return true;
+    }
+
+    /**
+     * Put a spent object back into the pool.
+     * @return true if object was pooled, false if pool was full and the object was destroyed.
+     */
+    bool recycle(T&& value)
+    {
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if (m_objects.size() < m_capacity)
+        {
+          m_objects.push_back(std::move(value));
+          return true;
+        }
+      }
+
+      //destroy value outside of the lock
+      T discard(std::move(value));
+      return false;
+    }
+
+    size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_objects.size();
+    }
+
+    size_t capacity() const
+    {
+      return m_capacity;
+    }
+
+  private:
+    const size_t       m_capacity;
+    mutable std::mutex m_mutex;
+    std::vector<T>     m_objects;
+  };
+}
@@ -21,7 +21,8 @@ namespace teetime
   {
     None,
     Start,
-    Terminating
+    Terminating,
+    Cancel //sent upstream, from receiver to sender
   };
 
   class AbstractStage;
@@ -46,6 +47,8 @@ namespace teetime
       return "SignalType::Start";
     case SignalType::Terminating:
       return "SignalType::Terminating";
+    case SignalType::Cancel:
+      return "SignalType::Cancel";
     default:
       break;
     }
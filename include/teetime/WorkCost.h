@@ -0,0 +1,60 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "common.h"
+#include "MemoryBudget.h"
+
+namespace teetime
+{
+  class File;
+  class FileBuffer;
+  class MappedFileBuffer;
+  class Image;
+
+  /**
+   * Estimated processing cost of a work item, used to order and assign items of very different size
+   * (see LargestFirstStage and LeastLoadedDistribution). Only the ratio between items matters.
+   * By default, the cost is the memory footprint of the element (see elementSize).
+   */
+  template<typename T>
+  struct ElementCost
+  {
+    uint64 operator()(const T& value) const
+    {
+      return elementSize(value);
+    }
+  };
+
+  /**
+   * Size of the file on disk (stat), the file is not opened. 0 if the file does not exist.
+   */
+  struct FileSizeCost
+  {
+    uint64 operator()(const File& file) const;
+  };
+
+  /**
+   * Pixel count of an image, read from the header of the file (see Image::probe), pixels are not decoded.
+   * Falls back to the file size, if the format is unknown.
+   */
+  struct ImagePixelCost
+  {
+    uint64 operator()(const File& file) const;
+    uint64 operator()(const FileBuffer& buffer) const;
+    uint64 operator()(const MappedFileBuffer& buffer) const;
+    uint64 operator()(const Image& image) const;
+  };
+}
@@ -19,12 +19,15 @@
 namespace teetime
 {
   struct Signal;
+  class AbstractStage;
 
   class AbstractPipe
   {
   public:
     AbstractPipe()
     : m_closed(false)
+    , m_canceled(false)
+    , m_sender(nullptr)
     {
     }
 
@@ -43,10 +46,39 @@ namespace teetime
       m_closed = true;
     }
 
+    /**
+     * Check if the receiving stage has canceled this pipe.
+     * Elements added to a canceled pipe are discarded.
+     */
+    bool isCanceled() const
+    {
+      return m_canceled.load(std::memory_order_relaxed);
+    }
+
+    void cancel()
+    {
+      m_canceled = true;
+    }
+
+    /**
+     * Stage that sends elements through this pipe.
+     */
+    AbstractStage* sender() const
+    {
+      return m_sender;
+    }
+
+    void setSender(AbstractStage* stage)
+    {
+      m_sender = stage;
+    }
+
   private:
-    //make sure closed flag is stored on it's own cacheline.
+    //make sure closed and canceled flags are stored on their own cacheline.
     char padding0[64];
     std::atomic<bool> m_closed;
+    std::atomic<bool> m_canceled;
     char padding1[64];
+    AbstractStage* m_sender;
   };
 }
\ No newline at end of file
@@ -18,6 +18,7 @@
 #include <exception>
 #include <stdexcept>
 #include <atomic>
+#include <functional>
 #include "Pipe.h"
 #include "../stages/AbstractStage.h"
 #include "../BlockingQueue.h"
@@ -25,6 +26,7 @@
 #include "../Signal.h"
 #include "../Optional.h"
 #include "../platform.h"
+#include "../MemoryBudget.h"
 
 #include "SpscQueue.h"
 
@@ -45,18 +47,63 @@ namespace teetime
   class SynchedPipe final : public Pipe<T>
   {
   public:
-    explicit SynchedPipe(uint32 initialCapacity)
+    using SizeFunction = std::function<size_t(const T&)>;
+
+    /**
+     * @param initialCapacity queue capacity (number of elements)
+     * @param budget optional memory budget to account queued bytes to
+     * @param throttle if true, adding elements blocks while the budget is exhausted and the pipe is not empty
+     *                 (an empty pipe always accepts one element, so the pipeline can't deadlock).
+     *                 Otherwise queued bytes are accounted only.
+     */
+    explicit SynchedPipe(uint32 initialCapacity, shared_ptr<MemoryBudget> budget = nullptr, bool throttle = true)
      : m_queue(initialCapacity)
+     , m_budget(std::move(budget))
+     , m_throttle(throttle)
+     , m_accounting(m_budget != nullptr)
+     , m_sizeOf(&defaultElementSize)
+    {
+    }
+
+    /**
+     * Limit the number of queued bytes (in addition to the number of queued elements).
+     * Adding elements blocks while the limit is exceeded. If the pipe is empty, one element is
+     * always accepted, no matter how big it is.
+     * Must be called before elements are added.
+     * @param byteCapacity maximum number of queued bytes, 0 for no limit
+     * @param sizeOf function to determine the size of an element in bytes. If empty, 'elementSize' is used.
+     */
+    void setByteCapacity(size_t byteCapacity, SizeFunction sizeOf = nullptr)
+    {
+      assert(isEmpty());
+
+      m_byteCapacity.reset(byteCapacity > 0 ? new MemoryBudget(byteCapacity) : nullptr);
+      m_sizeOf = sizeOf ? std::move(sizeOf) : SizeFunction(&defaultElementSize);
+      m_accounting = (m_budget || m_byteCapacity);
+    }
+
+    /**
+     * @return number of currently queued bytes, or 0 if no byte capacity was set.
+     */
+    size_t bytes() const
     {
+      return m_byteCapacity ? m_byteCapacity->used() : 0;
     }
 
     virtual Optional<T> removeLast() override
     {
       if (T* p = m_queue.frontPtr())
       {
+        const size_t bytes = m_accounting ? m_sizeOf(*p) : 0;
+
         Optional<T> ret(std::move(*p));
         m_queue.popFront();
 
+        if (m_accounting)
+        {
+          release(bytes);
+        }
+
         return ret;
       }
 
@@ -65,13 +112,57 @@ namespace teetime
 
     virtual bool tryAdd(T&& t) override
     {
-      return m_queue.write(std::move(t));
+      if (this->isCanceled())
+      {
+        //receiver is not interested in any more elements, discard it.
+        return true;
+      }
+
+      if (!m_accounting)
+      {
+        return m_queue.write(std::move(t));
+      }
+
+      const size_t bytes = m_sizeOf(t);
+      if (!reserve(bytes, false))
+      {
+        return false;
+      }
+
+      if (!m_queue.write(std::move(t)))
+      {
+        release(bytes);
+        return false;
+      }
+
+      return true;
     }
 
     virtual void add(T&& t) override
     {
+      if (this->isCanceled())
+      {
+        //receiver is not interested in any more elements, discard it.
+        return;
+      }
+
+      if (m_accounting)
+      {
+        reserve(m_sizeOf(t), true);
+      }
+
       while (!m_queue.write(std::move(t)))
       {
+        if (this->isCanceled())
+        {
+          if (m_accounting)
+          {
+            release(m_sizeOf(t));
+          }
+
+          return;
+        }
+
         std::this_thread::yield();
       }
     }
@@ -117,8 +208,75 @@ namespace teetime
     }
 
   private:
+    static size_t defaultElementSize(const T& t)
+    {
+      return elementSize(t);
+    }
+
+    bool reserve(size_t bytes, bool blocking)
+    {
+      if (m_byteCapacity)
+      {
+        if (blocking)
+        {
+          m_byteCapacity->acquire(bytes);
+        }
+        else if (!m_byteCapacity->tryAcquire(bytes))
+        {
+          return false;
+        }
+      }
+
+      if (m_budget)
+      {
+        if (!m_throttle)
+        {
+          m_budget->forceAcquire(bytes);
+        }
+        else if (blocking)
+        {
+          m_budget->acquire(bytes, [this] { return isEmpty() || this->isCanceled(); });
+        }
+        else if (!m_budget->tryAcquire(bytes))
+        {
+          //an empty pipe always takes one element
+          if (!isEmpty())
+          {
+            if (m_byteCapacity)
+            {
+              m_byteCapacity->release(bytes);
+            }
+
+            return false;
+          }
+
+          m_budget->forceAcquire(bytes);
+        }
+      }
+
+      return true;
+    }
+
+    void release(size_t bytes)
+    {
+      if (m_byteCapacity)
+      {
+        m_byteCapacity->release(bytes);
+      }
+
+      if (m_budget)
+      {
+        m_budget->release(bytes);
+      }
+    }
+
     //TODO(johl): merge m_signals and m_buffer into one queue, so order is always preserved?
     BlockingQueue<Signal> m_signals;
     TQueue<T> m_queue;
+    shared_ptr<MemoryBudget> m_budget;
+    unique_ptr<MemoryBudget> m_byteCapacity;
+    bool m_throttle;
+    bool m_accounting;
+    SizeFunction m_sizeOf;
   };
 }
\ No newline at end of file
@@ -47,6 +47,12 @@ namespace teetime
 
     virtual void add(T&& t) override
     {
+      if (this->isCanceled())
+      {
+        //receiver is not interested in any more elements, discard it.
+        return;
+      }
+
       //TODO(johl): what to do if pipe is non-empty?
       assert(!m_value);
       m_value.set(std::move(t));
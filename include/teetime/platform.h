@@ -17,6 +17,7 @@
 #include "common.h"
 #include <vector>
 #include <string>
+#include <cstdint>
 
 namespace teetime
 {
@@ -26,21 +27,29 @@ namespace platform
   bool createDirectory(const char* path);
   bool isFile(const char* path);
   bool isDirectory(const char* path);
+  bool getFileSize(const char* path, uint64& size);
   bool removeFile(const char* path);
+  bool removeDirectory(const char* path, bool recursive);
   bool listFiles(const char* directory, std::vector<std::string>& entries, bool recursive);
   bool listSubDirectories(const char* directory, std::vector<std::string>& entries, bool recursive);
+  bool listDirectory(const char* directory, std::vector<std::string>& files, std::vector<std::string>& subDirectories);
   bool getCurrentWorkingDirectory(char* buffer, size_t buffersize);
 
   inline bool createDirectory(const std::string& path) { return createDirectory(path.c_str()); }
   inline bool isFile(const std::string& path) { return isFile(path.c_str()); }
   inline bool isDirectory(const std::string& path) { return isDirectory(path.c_str()); }
+  inline bool getFileSize(const std::string& path, uint64& size) { return getFileSize(path.c_str(), size); }
   inline bool removeFile(const std::string& path) { return removeFile(path.c_str());  }
+  inline bool removeDirectory(const std::string& path, bool recursive) { return removeDirectory(path.c_str(), recursive); }
   inline bool listFiles(const std::string& path, std::vector<std::string>& entries, bool recursive) {
     return listFiles(path.c_str(), entries, recursive);
   }
   inline bool listSubDirectories(const std::string& path, std::vector<std::string>& entries, bool recursive) {
     return listSubDirectories(path.c_str(), entries, recursive);
   }
+  inline bool listDirectory(const std::string& path, std::vector<std::string>& files, std::vector<std::string>& subDirectories) {
+    return listDirectory(path.c_str(), files, subDirectories);
+  }
   inline bool getCurrentWorkingDirectory(std::string& s) {
     char buffer[256];
     if (getCurrentWorkingDirectory(buffer, sizeof(buffer))) {
@@ -53,6 +62,86 @@ namespace platform
 
   void setThreadAffinityMask(unsigned mask);
 
+  /**
+   * Map a whole file read-only into memory.
+   * Empty files can't be mapped, for those 'data' is set to nullptr and 'size' to 0 (but true is returned).
+   * @return true if file was mapped successfully.
+   */
+  bool mapFile(const char* path, const void*& data, size_t& size);
+  void unmapFile(const void* data, size_t size);
+
+  /**
+   * Handle of a file opened for reading at arbitrary offsets.
+   */
+  using FileHandle = intptr_t;
+  static const FileHandle InvalidFileHandle = -1;
+
+  /**
+   * Open a file for (mostly sequential) reading.
+   * @return file handle or InvalidFileHandle, if file could not be opened.
+   */
+  FileHandle openFile(const char* path, uint64& size);
+  void closeFile(FileHandle file);
+
+  /**
+   * Read up to 'size' bytes at the given offset (independent of previous reads).
+   * @return number of bytes read, 0 at end of file or on error.
+   */
+  size_t readFile(FileHandle file, uint64 offset, void* buffer, size_t size);
+
+  /**
+   * Hint that the given range of the file will be read soon, so the OS can start reading ahead.
+   */
+  void prefetchFile(FileHandle file, uint64 offset, size_t size);
+
+  /**
+   * Read a whole file (by openFile/readFile). 'bytes' is resized to the file size, its capacity is reused.
+   * @return true on success.
+   */
+  bool readWholeFile(const char* path, std::vector<uint8>& bytes);
+
+  inline bool readWholeFile(const std::string& path, std::vector<uint8>& bytes) { return readWholeFile(path.c_str(), bytes); }
+
+  /**
+   * Create a file for writing (existing files are truncated).
+   * @param directIO bypass the OS' page cache, if supported. In this mode, writes must start at offsets
+   *                 that are multiples of DirectIOAlignment and must write from buffers aligned to
+   *                 DirectIOAlignment in multiples of DirectIOAlignment bytes.
+   * @return file handle or InvalidFileHandle, if file could not be created.
+   */
+  FileHandle createFile(const char* path, bool directIO);
+
+  /**
+   * Write 'size' bytes at the given offset.
+   * @return number of bytes written, less than 'size' on error.
+   */
+  size_t writeFile(FileHandle file, uint64 offset, const void* data, size_t size);
+
+  /**
+   * Truncate or extend file to the given size.
+   */
+  bool resizeFile(FileHandle file, uint64 size);
+
+  /**
+   * Flush written data of the given file to the storage device.
+   */
+  bool syncFile(FileHandle file);
+
+  /**
+   * Copy a whole file, including its permissions. An existing destination is replaced only if 'overwrite' is set.
+   * Content is copied inside the kernel if possible (copy_file_range, which may just share extents
+   * on copy-on-write file systems, or sendfile), otherwise through a user space buffer.
+   * The copy is written to a temporary file in the destination's directory and renamed once complete.
+   * Without 'overwrite', the copy is only moved into place if the destination still doesn't exist then.
+   * @return true on success, false if 'to' refers to the source file itself (same path or hard link),
+   *         or if it exists and 'overwrite' is not set.
+   */
+  bool copyFile(const char* from, const char* to, bool overwrite = true);
+
+  inline bool copyFile(const std::string& from, const std::string& to, bool overwrite = true) { return copyFile(from.c_str(), to.c_str(), overwrite); }
+
+  static const size_t DirectIOAlignment = 4096;
+
   void* aligned_malloc(size_t size, size_t align);
   void  aligned_free(void* p);
 
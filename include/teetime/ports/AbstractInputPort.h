@@ -18,6 +18,8 @@
 
 namespace teetime
 {
+  class AbstractPipe;
+
   /**
    * Abstract input port.
    */
@@ -31,5 +33,14 @@ namespace teetime
     virtual ~AbstractInputPort() = default;
 
     virtual void waitForStartSignal() = 0;
+
+    /**
+     * Cancel the connection to this port. Elements sent to this port
+     * are discarded from now on and the sending stage is notified by a 'Cancel' signal.
+     */
+    void cancel();
+
+  private:
+    virtual AbstractPipe* getPipe() = 0;
   };
 }
\ No newline at end of file
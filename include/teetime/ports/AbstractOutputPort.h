@@ -35,6 +35,11 @@ namespace teetime
 
     void sendSignal(const Signal& signal);
 
+    /**
+     * Check if the receiving stage is not interested in any more elements.
+     */
+    bool isCanceled();
+
   private:
     virtual AbstractPipe* getPipe() = 0;
 
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <functional>
 #include "AbstractInputPort.h"
 #include "../pipes/Pipe.h"
 
@@ -22,6 +23,7 @@ namespace teetime
   //forward decls
 
   class AbstractOutputPort;
+  class MemoryBudget;
 
   template<typename T>
   class InputPort;
@@ -32,7 +34,7 @@ namespace teetime
   namespace internal
   {
     template<typename T>
-    void connectPortsCallback(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, bool synched);
+    void connectPortsCallback(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, size_t byteCapacity, const std::function<size_t(const T&)>& sizeOf, bool synched, const shared_ptr<MemoryBudget>& budget);
   }
 
   class AbstractStage;
@@ -47,6 +49,7 @@ namespace teetime
   public:
     explicit InputPort(AbstractStage* owner)
      : AbstractInputPort(owner)
+     , m_pipe(nullptr)
     {
     }
 
@@ -67,7 +70,12 @@ namespace teetime
     }
 
   private:
-    friend void internal::connectPortsCallback<T>(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, bool synched);
+    virtual AbstractPipe* getPipe() override
+    {
+      return m_pipe;
+    }
+
+    friend void internal::connectPortsCallback<T>(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, size_t byteCapacity, const std::function<size_t(const T&)>& sizeOf, bool synched, const shared_ptr<MemoryBudget>& budget);
 
     Pipe<T>* m_pipe;
   };
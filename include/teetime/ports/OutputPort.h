@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 #pragma once
+#include <functional>
 #include "AbstractOutputPort.h"
 #include "../pipes/Pipe.h"
 #include "../Signal.h"
@@ -22,6 +23,7 @@ namespace teetime
 {
   //forward decls.
   class AbstractInputPort;
+  class MemoryBudget;
 
   template<typename T>
   class InputPort;
@@ -32,7 +34,7 @@ namespace teetime
   namespace internal
   {
     template<typename T>
-    void connectPortsCallback(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, bool synched);
+    void connectPortsCallback(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, size_t byteCapacity, const std::function<size_t(const T&)>& sizeOf, bool synched, const shared_ptr<MemoryBudget>& budget);
   }
 
   /**
@@ -69,7 +71,7 @@ namespace teetime
       return m_pipe.get();
     }
 
-    friend void internal::connectPortsCallback<T>(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, bool synched);
+    friend void internal::connectPortsCallback<T>(AbstractOutputPort* out, AbstractInputPort* in, size_t capacity, size_t byteCapacity, const std::function<size_t(const T&)>& sizeOf, bool synched, const shared_ptr<MemoryBudget>& budget);
 
     unique_ptr<Pipe<T>> m_pipe;
   };
@@ -59,6 +59,7 @@ namespace teetime
      * the stage terminates.
      * If no input was received but input port is not closed,
      * the stage yields.
+     * If the stage was canceled, received input is discarded.
      */
     virtual void execute() override final
     {
@@ -68,7 +69,10 @@ namespace teetime
       auto v = m_inputport->receive();
       if(v)
       {
-        execute(std::move(*v));
+        if(!isCanceled())
+        {
+          execute(std::move(*v));
+        }
       }
       else if(m_inputport->isClosed())
       {
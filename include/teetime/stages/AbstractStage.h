@@ -16,6 +16,7 @@
 #pragma once
 #include "../common.h"
 #include <vector>
+#include <atomic>
 
 namespace teetime
 {
@@ -57,6 +58,16 @@ namespace teetime
 
     void onSignal(const Signal& signal);
 
+    /**
+     * Cancel this stage. All elements received from now on are discarded.
+     * The cancellation propagates upstream: a stage gets canceled as soon as
+     * all of its output ports have been canceled. Producer stages should check
+     * 'isCanceled' regularly and terminate early.
+     * Can be called from any thread.
+     */
+    void cancel();
+    bool isCanceled() const;
+
     uint32 numInputPorts() const;
     uint32 numOutputPorts() const;
     AbstractInputPort* getInputPort(uint32 index);
@@ -104,8 +115,12 @@ namespace teetime
     template<typename T>
     using pointers = std::vector<unique_ptr<T>>;
 
+    bool allOutputPortsCanceled() const;
+
     //current state
     StageState                   m_state;
+    //canceled flag (set by other stages or threads)
+    std::atomic<bool>            m_canceled;
     //all input ports
     pointers<AbstractInputPort>  m_inputPorts;
     //all output ports
@@ -200,6 +215,11 @@ namespace teetime
     return m_outputPorts[index].get();
   }
 
+  inline bool AbstractStage::isCanceled() const
+  {
+    return m_canceled.load(std::memory_order_relaxed);
+  }
+
   inline const char* AbstractStage::debugName() const
   {
     return m_debugName.c_str();
@@ -0,0 +1,43 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractFilterStage.h>
+#include <string>
+
+namespace teetime
+{
+  class MappedFileBuffer;
+
+  /**
+   * Emits all entries of an archive (see Archive.h, input is the archive's base path).
+   * Segment files are mapped into memory, each entry is a zero-copy view into its segment
+   * (MappedFileBuffer::path is the entry name). Compared to Directory2Files and File2FileBuffer,
+   * this avoids any per-file system calls and reads the segments sequentially.
+   * Entries of a segment that can't be mapped are skipped (and counted, see numEntriesSkipped).
+   */
+  class Archive2MappedFileBuffer final : public AbstractFilterStage<std::string, MappedFileBuffer>
+  {
+  public:
+    explicit Archive2MappedFileBuffer(const char* debugName = "Archive2MappedFileBuffer");
+
+    size_t numEntriesSkipped() const;
+
+  private:
+    virtual void execute(std::string&& value) override;
+
+    size_t m_numEntriesSkipped;
+  };
+}
@@ -0,0 +1,73 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractStage.h>
+#include <teetime/Archive.h>
+#include <teetime/FileBuffer.h>
+
+namespace teetime
+{
+  template<typename T>
+  class InputPort;
+
+  /**
+   * Appends file buffers to an archive (see Archive.h), instead of writing one file per buffer.
+   * FileBuffer::path is used as entry name. A directory tree is packed by connecting
+   * Directory2Files, File2FileBuffer and ArchiveSink. The index is written once the input port is closed.
+   * This stage must be declared active.
+   */
+  class ArchiveSink final : public AbstractStage
+  {
+  public:
+    /**
+     * @param basePath archive to create (segment and index files get a suffix)
+     * @param segmentSize maximum size of a segment file
+     * @param debugName stage name
+     */
+    explicit ArchiveSink(const std::string& basePath, uint64 segmentSize = ArchiveWriter::DefaultSegmentSize, const char* debugName = "ArchiveSink");
+
+    InputPort<FileBuffer>& getInputPort();
+
+    /**
+     * Store entry names relative to the given directory (the directory prefix is removed from
+     * FileBuffer::path), so packed directory trees can be moved around.
+     */
+    void setBaseDirectory(const std::string& directory);
+
+    /**
+     * Put spent buffers (see FileBuffer::bytes) into the given pool, after they have been appended.
+     */
+    void setRecyclingPool(shared_ptr<FileBufferPool> pool);
+
+    size_t numEntriesWritten() const;
+    size_t numEntriesFailed() const;
+
+  private:
+    virtual void execute() override;
+    virtual unique_ptr<Runnable> createRunnable() override;
+
+    std::string entryName(const std::string& path) const;
+
+    InputPort<FileBuffer>*     m_inputPort;
+    const std::string          m_basePath;
+    std::string                m_baseDirectory;
+    ArchiveWriter              m_writer;
+    bool                       m_opened;
+    shared_ptr<FileBufferPool> m_pool;
+    size_t                     m_numEntriesWritten;
+    size_t                     m_numEntriesFailed;
+  };
+}
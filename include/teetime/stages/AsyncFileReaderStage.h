@@ -0,0 +1,97 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractStage.h>
+#include <teetime/File.h>
+#include <teetime/FileBuffer.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace teetime
+{
+  template<typename T>
+  class InputPort;
+
+  template<typename T>
+  class OutputPort;
+
+  /**
+   * Reads files asynchronously. Accepts up to 'queueDepth' requests, which are executed by a pool of
+   * reader threads doing blocking reads. So the number of reads the storage device actually sees at once
+   * equals the number of threads, further requests wait in the stage. By default there is one thread
+   * per request, so the device queue depth is 'queueDepth'.
+   * Buffers are emitted as soon as their read has completed, so the order of buffers may differ from the order of files.
+   * Files that can't be read are skipped.
+   * This stage must be declared active.
+   */
+  class AsyncFileReaderStage final : public AbstractStage
+  {
+  public:
+    /**
+     * @param queueDepth maximum number of requests in flight (submitted, but not yet emitted)
+     * @param numThreads number of reader threads, i.e. the number of concurrent reads (at most 'queueDepth').
+     *                   0 uses 'queueDepth' threads.
+     * @param debugName stage name
+     */
+    explicit AsyncFileReaderStage(size_t queueDepth = 16, size_t numThreads = 0, const char* debugName = "AsyncFileReaderStage");
+    ~AsyncFileReaderStage();
+
+    InputPort<File>& getInputPort();
+    OutputPort<FileBuffer>& getOutputPort();
+
+    /**
+     * Reuse spent buffers from the given pool (instead of allocating new ones), if possible.
+     * Must be called before the stage is executed.
+     */
+    void setRecyclingPool(shared_ptr<FileBufferPool> pool);
+
+  private:
+    struct Completion
+    {
+      FileBuffer buffer;
+      bool success;
+    };
+
+    virtual void execute() override;
+    virtual unique_ptr<Runnable> createRunnable() override;
+
+    void startThreads();
+    void stopThreads();
+    void readerThread();
+
+    void submit(File&& file);
+    bool sendCompleted(bool wait);
+
+    InputPort<File>*           m_inputPort;
+    OutputPort<FileBuffer>*    m_outputPort;
+    shared_ptr<FileBufferPool> m_pool;
+
+    const size_t             m_queueDepth;
+    const size_t             m_numThreads;
+    size_t                   m_inFlight; //only accessed by stage thread
+    std::vector<std::thread> m_threads;
+
+    std::mutex               m_mutex;
+    std::condition_variable  m_requestCond;
+    std::condition_variable  m_completionCond;
+    std::deque<File>         m_requests;
+    std::deque<Completion>   m_completions;
+    bool                     m_stopping;
+  };
+}
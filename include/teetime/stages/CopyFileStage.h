@@ -0,0 +1,63 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractFilterStage.h>
+#include <teetime/File.h>
+#include <string>
+
+namespace teetime
+{
+  /**
+   * Copies files into a target directory and sends the copies.
+   * Files inside the base directory (see setBaseDirectory) keep their path relative to it, missing
+   * subdirectories are created. Other files are copied directly into the target directory.
+   * Existing files are not overwritten (the copy fails), unless overwriting is enabled.
+   * Content is copied by the kernel if possible (see platform::copyFile), so routing and archival
+   * pipelines don't have to read files into memory (like File2FileBuffer does).
+   */
+  class CopyFileStage final : public AbstractFilterStage<File, File>
+  {
+  public:
+    /**
+     * @param targetDirectory directory files are copied to (must exist)
+     * @param debugName stage name
+     */
+    explicit CopyFileStage(const std::string& targetDirectory, const char* debugName = "CopyFileStage");
+
+    /**
+     * Keep paths relative to the given directory (see relativePath), so files with the same name
+     * in different subdirectories don't collide.
+     */
+    void setBaseDirectory(const std::string& directory);
+
+    /**
+     * Replace existing files in the target directory.
+     */
+    void setOverwrite(bool overwrite);
+
+    size_t numFilesCopied() const;
+    size_t numFilesFailed() const;
+
+  private:
+    virtual void execute(File&& value) override;
+
+    std::string m_targetDirectory;
+    std::string m_baseDirectory;
+    bool        m_overwrite;
+    size_t      m_numFilesCopied;
+    size_t      m_numFilesFailed;
+  };
+}
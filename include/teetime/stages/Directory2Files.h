@@ -20,12 +20,30 @@ namespace teetime
 {
   class File;
 
+  /**
+   * Recursively lists all files of a directory.
+   * Files are sent as soon as they are discovered, the directory tree is never held in memory as a whole.
+   */
   class Directory2Files final : public AbstractFilterStage<std::string, File>
   {
   public:
     explicit Directory2Files(const char* debugName = "Directory2Files");
 
+    /**
+     * @param sorted if true, files are sent in lexicographical order of their paths. Sorted output
+     *               needs to list one directory at a time, so 'numThreads' is ignored in this case.
+     * @param numThreads number of threads scanning directories in parallel (if output is not sorted).
+     * @param debugName stage name
+     */
+    Directory2Files(bool sorted, size_t numThreads, const char* debugName = "Directory2Files");
+
   private:
     virtual void execute(std::string&& value) override;
+
+    void walkSequential(const std::string& directory);
+    void walkParallel(const std::string& directory);
+
+    bool   m_sorted;
+    size_t m_numThreads;
   };
 }
\ No newline at end of file
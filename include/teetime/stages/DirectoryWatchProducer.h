@@ -0,0 +1,51 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractProducerStage.h>
+#include <teetime/File.h>
+#include <string>
+
+namespace teetime
+{
+  /**
+   * Continuously reports the files of a directory tree ("hot folder").
+   * First, all existing files are sent. Afterwards, files are sent as soon as they have been closed after writing
+   * or have been moved into the tree (based on inotify).
+   * Existing files and events of the same file are debounced: a file is sent once it had no new events
+   * (including writes) for the given time, so a file listed while it is still written is sent only once.
+   * If the kernel's event queue overflows, the whole tree is scanned again and all files are sent again,
+   * so consumers must tolerate duplicates.
+   * The stage runs until it gets canceled. On platforms without inotify, only the initial scan is done.
+   */
+  class DirectoryWatchProducer final : public AbstractProducerStage<File>
+  {
+  public:
+    static const unsigned DefaultDebounceMilliseconds = 50;
+
+    /**
+     * @param directory root of the watched tree
+     * @param debounceMilliseconds quiet period after the last event of a file, before the file is sent
+     * @param debugName stage name
+     */
+    explicit DirectoryWatchProducer(const std::string& directory, unsigned debounceMilliseconds = DefaultDebounceMilliseconds, const char* debugName = "DirectoryWatchProducer");
+
+  private:
+    virtual void execute() override;
+
+    std::string m_directory;
+    unsigned    m_debounceMilliseconds;
+  };
+}
@@ -13,7 +13,11 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
+#pragma once
 #include <teetime/stages/AbstractConsumerStage.h>
+#include <teetime/WorkCost.h>
+#include <algorithm>
+#include <vector>
 
 namespace teetime
 {
@@ -97,6 +101,76 @@ namespace teetime
     size_t m_next;
   };
 
+  /**
+   * Sends each element to the output port with the smallest total cost assigned so far (greedy list scheduling).
+   * Fed in order of decreasing cost (see LargestFirstStage), this is longest-processing-time-first scheduling.
+   * Completion is not observed, so assigned costs only grow. Ports that are full are skipped (their worker is
+   * behind its estimate), which corrects wrong estimates if the connections have small capacities.
+   * Blocks only if all ports are full.
+   * @tparam TCost cost estimation, returns uint64 for a const T&
+   */
+  template<typename T, typename TCost = ElementCost<T>>
+  class LeastLoadedDistribution
+  {
+  public:
+    explicit LeastLoadedDistribution(TCost cost = TCost())
+      : m_cost(cost)
+    {}
+
+    LeastLoadedDistribution(const LeastLoadedDistribution&) = default;
+    ~LeastLoadedDistribution() = default;
+    LeastLoadedDistribution& operator=(const LeastLoadedDistribution&) = default;
+
+    void operator()(const std::vector<unique_ptr<AbstractOutputPort>>& ports, T&& value)
+    {
+      const size_t numOutputPorts = ports.size();
+      assert(numOutputPorts > 0);
+
+      if (m_load.size() != numOutputPorts)
+      {
+        m_load.resize(numOutputPorts, 0);
+        m_order.resize(numOutputPorts);
+      }
+
+      //every element counts, even if its estimated cost is 0
+      const uint64 cost = (std::max)(m_cost(value), uint64(1));
+
+      for (size_t i = 0; i < numOutputPorts; ++i)
+      {
+        m_order[i] = i;
+      }
+
+      std::sort(m_order.begin(), m_order.end(), [this](size_t a, size_t b) {
+        return m_load[a] < m_load[b] || (m_load[a] == m_load[b] && a < b);
+      });
+
+      for (size_t index : m_order)
+      {
+        auto typedPort = unsafe_dynamic_cast<OutputPort<T>>(ports[index].get());
+        assert(typedPort);
+
+        if (typedPort->trySend(std::move(value)))
+        {
+          m_load[index] += cost;
+          return;
+        }
+      }
+
+      //all ports are full: wait for the least loaded one
+      const size_t index = m_order[0];
+      auto typedPort = unsafe_dynamic_cast<OutputPort<T>>(ports[index].get());
+      assert(typedPort);
+
+      typedPort->send(std::move(value));
+      m_load[index] += cost;
+    }
+
+  private:
+    TCost               m_cost;
+    std::vector<uint64> m_load;  //total cost assigned to each port
+    std::vector<size_t> m_order; //ports by load, reused for each element
+  };
+
   template<typename T>
   class CopyDistribution
   {
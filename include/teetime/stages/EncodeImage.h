@@ -0,0 +1,44 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractFilterStage.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/Image.h>
+
+namespace teetime
+{
+  /**
+   * Encodes images into file content (see Image::saveToMemory), e.g. to write them with FileWriterSink.
+   * The path of each buffer is the filename of the image with its extension replaced by the one of the format.
+   * Qoi is the cheapest format for intermediate results that are read back later (see ReadImage).
+   */
+  class EncodeImage final : public AbstractFilterStage<Image, FileBuffer>
+  {
+  public:
+    explicit EncodeImage(ImageFileFormat format = ImageFileFormat::Qoi, const char* debugName = "EncodeImage");
+
+    /**
+     * Take the memory of output buffers from the given pool (e.g. the pool FileWriterSink recycles into).
+     */
+    void setRecyclingPool(shared_ptr<FileBufferPool> pool);
+
+  private:
+    virtual void execute(Image&& image) override;
+
+    ImageFileFormat m_format;
+    shared_ptr<FileBufferPool> m_pool;
+  };
+}
@@ -13,19 +13,26 @@
 * See the License for the specific language governing permissions and
 * limitations under the License.
 */
+#pragma once
 #include <teetime/stages/AbstractFilterStage.h>
 #include <teetime/File.h>
+#include <teetime/FileBuffer.h>
 
 namespace teetime
 {
-  class FileBuffer;
-
   class File2FileBuffer final : public AbstractFilterStage<File, FileBuffer>
   {
   public:
     explicit File2FileBuffer(const char* debugName = "File2FileBuffer");
 
+    /**
+     * Reuse spent buffers from the given pool (instead of allocating new ones), if possible.
+     */
+    void setRecyclingPool(shared_ptr<FileBufferPool> pool);
+
   private:
     virtual void execute(File&& value) override;
+
+    shared_ptr<FileBufferPool> m_pool;
   };
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractFilterStage.h>
+#include <teetime/File.h>
+
+namespace teetime
+{
+  class MappedFileBuffer;
+
+  /**
+   * Maps files into memory (read-only) instead of reading them into a heap buffer like File2FileBuffer.
+   */
+  class File2MappedFileBuffer final : public AbstractFilterStage<File, MappedFileBuffer>
+  {
+  public:
+    explicit File2MappedFileBuffer(const char* debugName = "File2MappedFileBuffer");
+
+  private:
+    virtual void execute(File&& value) override;
+  };
+}
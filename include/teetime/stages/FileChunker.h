@@ -0,0 +1,61 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractFilterStage.h>
+#include <teetime/File.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/FileChunk.h>
+
+namespace teetime
+{
+  /**
+   * Splits files into chunks, so files can be processed in a streaming fashion
+   * (even if they are larger than the available memory). Every file results in at least
+   * one chunk (empty files in one empty chunk), the last chunk of a file is marked by 'FileChunk::last'.
+   * Memory is bounded by chunk size times the number of queued chunks.
+   */
+  class FileChunker final : public AbstractFilterStage<File, FileChunk>
+  {
+  public:
+    static const size_t DefaultChunkSize = 1024 * 1024;
+
+    /**
+     * @param chunkSize maximum size of a chunk in bytes
+     * @param debugName stage name
+     */
+    explicit FileChunker(size_t chunkSize = DefaultChunkSize, const char* debugName = "FileChunker");
+
+    /**
+     * Align chunks to a delimiter: Each chunk (except the last one) ends right after the last occurrence
+     * of 'delimiter' (e.g. '\n' to never split lines). If a chunk does not contain the delimiter at all,
+     * it is split at 'chunkSize' anyway.
+     */
+    void setDelimiter(uint8 delimiter);
+
+    /**
+     * Reuse spent buffers from the given pool (see FileChunk::bytes), if possible.
+     */
+    void setRecyclingPool(shared_ptr<FileBufferPool> pool);
+
+  private:
+    virtual void execute(File&& value) override;
+
+    const size_t               m_chunkSize;
+    bool                       m_useDelimiter;
+    uint8                      m_delimiter;
+    shared_ptr<FileBufferPool> m_pool;
+  };
+}
@@ -0,0 +1,110 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractStage.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/platform.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace teetime
+{
+  template<typename T>
+  class InputPort;
+
+  /**
+   * Writes file buffers to disk (FileBuffer::path is the destination, FileBuffer::bytes the content).
+   * Buffers are collected into batches of about 'batchSize' bytes, which are written by a separate
+   * writer thread, so the pipeline never stalls on disk latency (as long as the disk keeps up).
+   * A partial batch is handed over when the input closes, or when its first buffer has waited for
+   * a while (about 10ms) and the writer thread has room for it, so slow producers still get batched.
+   * Optionally, files are written with direct I/O (bypassing the page cache) and/or synced to disk
+   * once per batch. Files that fail to sync are counted as failed.
+   * This stage must be declared active.
+   */
+  class FileWriterSink final : public AbstractStage
+  {
+  public:
+    static const size_t DefaultBatchSize = 4 * 1024 * 1024;
+
+    /**
+     * @param batchSize number of bytes collected before they are handed to the writer thread
+     * @param debugName stage name
+     */
+    explicit FileWriterSink(size_t batchSize = DefaultBatchSize, const char* debugName = "FileWriterSink");
+    ~FileWriterSink();
+
+    InputPort<FileBuffer>& getInputPort();
+
+    /**
+     * Bypass the page cache (O_DIRECT/FILE_FLAG_NO_BUFFERING), if supported by the file system.
+     * Content is staged in aligned buffers of 'batchSize' bytes.
+     */
+    void setDirectIO(bool enabled);
+
+    /**
+     * Sync all files of a batch to disk, before they are closed.
+     */
+    void setSync(bool enabled);
+
+    /**
+     * Put spent buffers (see FileBuffer::bytes) into the given pool, after they have been written.
+     */
+    void setRecyclingPool(shared_ptr<FileBufferPool> pool);
+
+    size_t numFilesWritten() const;
+    size_t numFilesFailed() const;
+
+    /**
+     * Number of batches handed to the writer thread so far.
+     */
+    size_t numBatches() const;
+
+  private:
+    virtual void execute() override;
+    virtual unique_ptr<Runnable> createRunnable() override;
+
+    void startThread();
+    void stopThread();
+    void writerThread();
+
+    bool submitBatch(bool wait);
+    bool writeFile(const FileBuffer& buffer, uint8* staging, std::vector<std::pair<platform::FileHandle, const FileBuffer*>>& openFiles);
+
+    InputPort<FileBuffer>*     m_inputPort;
+    const size_t               m_batchSize;
+    bool                       m_directIO;
+    bool                       m_sync;
+    shared_ptr<FileBufferPool> m_pool;
+
+    std::vector<FileBuffer>    m_batch; //only accessed by stage thread
+    size_t                     m_batchBytes;
+    uint64                     m_batchStart; //time (microseconds) the first buffer of m_batch arrived
+    std::thread                m_thread;
+
+    mutable std::mutex                  m_mutex;
+    std::condition_variable             m_cond;
+    std::deque<std::vector<FileBuffer>> m_batches;
+    bool                                m_stopping;
+    size_t                              m_numFilesWritten;
+    size_t                              m_numFilesFailed;
+    size_t                              m_numBatches;
+  };
+}
@@ -0,0 +1,39 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractFilterStage.h>
+#include <teetime/ImageTile.h>
+#include <unordered_map>
+
+namespace teetime
+{
+  /**
+   * Collects processed tiles (see SplitImage) and sends each target image once all of its tiles have arrived.
+   * Tiles have written their pixels into the target image already, so nothing is copied.
+   * Tiles of different images may arrive interleaved and in any order.
+   */
+  class GatherImage final : public AbstractFilterStage<ImageTile, Image>
+  {
+  public:
+    explicit GatherImage(const char* debugName = "GatherImage");
+
+  private:
+    virtual void execute(ImageTile&& value) override;
+
+    //number of tiles still missing per target image
+    std::unordered_map<const Image*, size_t> m_missingTiles;
+  };
+}
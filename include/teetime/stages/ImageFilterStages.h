@@ -0,0 +1,141 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractFilterStage.h>
+#include <teetime/PlanarImage.h>
+#include <teetime/ImageTile.h>
+
+namespace teetime
+{
+  /**
+   * Base of filter stages working on planar images (see PlanarImage and ImageFilters.h).
+   * Each image is deinterleaved, filtered and interleaved back into the same image (buffer is reused).
+   * Planar images are kept between executions, so no memory is allocated once sizes are stable.
+   */
+  class AbstractPlanarFilterStage : public AbstractFilterStage<Image, Image>
+  {
+  protected:
+    explicit AbstractPlanarFilterStage(const char* debugName);
+
+  private:
+    virtual void execute(Image&& image) override final;
+    virtual void apply(const PlanarImage& src, PlanarImage& dst) = 0;
+
+    PlanarImage m_source;
+    PlanarImage m_target;
+  };
+
+  /**
+   * Converts images to Gray8 (GrayAlpha8 if they have alpha).
+   */
+  class GrayscaleStage final : public AbstractPlanarFilterStage
+  {
+  public:
+    explicit GrayscaleStage(const char* debugName = "GrayscaleStage");
+
+  private:
+    virtual void apply(const PlanarImage& src, PlanarImage& dst) override;
+  };
+
+  class GaussianBlurStage final : public AbstractPlanarFilterStage
+  {
+  public:
+    explicit GaussianBlurStage(float sigma, const char* debugName = "GaussianBlurStage");
+
+  private:
+    virtual void apply(const PlanarImage& src, PlanarImage& dst) override;
+
+    float m_sigma;
+  };
+
+  /**
+   * Unsharp mask (see teetime::sharpen).
+   */
+  class SharpenStage final : public AbstractPlanarFilterStage
+  {
+  public:
+    SharpenStage(float sigma, float amount, const char* debugName = "SharpenStage");
+
+  private:
+    virtual void apply(const PlanarImage& src, PlanarImage& dst) override;
+
+    float m_sigma;
+    float m_amount;
+  };
+
+  /**
+   * Base of filter stages working on tiles (see ImageTile, SplitImage and GatherImage).
+   * The source region (including halo) is deinterleaved and filtered, the target region of the result is
+   * interleaved into the tile's target image. Tiles must be created with ImageTileTarget::SameSize.
+   */
+  class AbstractPlanarTileFilterStage : public AbstractFilterStage<ImageTile, ImageTile>
+  {
+  protected:
+    explicit AbstractPlanarTileFilterStage(const char* debugName);
+
+  private:
+    virtual void execute(ImageTile&& tile) override final;
+    virtual void apply(const PlanarImage& src, PlanarImage& dst) = 0;
+
+    PlanarImage m_source;
+    PlanarImage m_target;
+  };
+
+  /**
+   * Tiled GaussianBlurStage. With a halo of at least gaussianRadius(sigma) the result is identical to
+   * blurring the whole image (edges are clamped at the image borders only).
+   */
+  class GaussianBlurTileStage final : public AbstractPlanarTileFilterStage
+  {
+  public:
+    explicit GaussianBlurTileStage(float sigma, const char* debugName = "GaussianBlurTileStage");
+
+  private:
+    virtual void apply(const PlanarImage& src, PlanarImage& dst) override;
+
+    float m_sigma;
+  };
+
+  /**
+   * Tiled SharpenStage, needs the same halo as GaussianBlurTileStage.
+   */
+  class SharpenTileStage final : public AbstractPlanarTileFilterStage
+  {
+  public:
+    SharpenTileStage(float sigma, float amount, const char* debugName = "SharpenTileStage");
+
+  private:
+    virtual void apply(const PlanarImage& src, PlanarImage& dst) override;
+
+    float m_sigma;
+    float m_amount;
+  };
+
+  /**
+   * Gamma correction of the color channels (alpha is kept).
+   * Input and output are 8 bit, so this is a table lookup on the interleaved image, no planar conversion.
+   */
+  class GammaStage final : public AbstractFilterStage<Image, Image>
+  {
+  public:
+    explicit GammaStage(float gamma, const char* debugName = "GammaStage");
+
+  private:
+    virtual void execute(Image&& image) override;
+
+    uint8 m_table[256];
+  };
+}
@@ -40,6 +40,9 @@ namespace teetime
     {
       for (auto& e : m_elements)
       {
+        if (AbstractProducerStage<T>::isCanceled())
+          break;
+
         AbstractProducerStage<T>::getOutputPort().send(std::move(e));
       }
 
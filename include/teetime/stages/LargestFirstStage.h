@@ -0,0 +1,139 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include "../common.h"
+#include "../ports/InputPort.h"
+#include "../ports/OutputPort.h"
+#include "../Runnable.h"
+#include "../WorkCost.h"
+#include "AbstractStage.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace teetime
+{
+  /**
+   * Bounded lookahead buffer, which reorders elements by estimated cost, most expensive first.
+   * Up to 'lookahead' elements are buffered. Once the buffer is full, each incoming element pushes out the
+   * most expensive buffered one. When the input port is closed, the rest is sent in order of decreasing cost.
+   * Put it in front of a distributor (see LeastLoadedDistribution), so big items start first and small
+   * ones fill the gaps at the end (longest-processing-time-first), instead of one worker finishing the
+   * biggest item long after the others are done. Elements of equal cost keep their order.
+   * This stage must be declared active.
+   * @tparam T element type
+   * @tparam TCost cost estimation, returns uint64 for a const T& (evaluated once per element)
+   */
+  template<typename T, typename TCost = ElementCost<T>>
+  class LargestFirstStage final : public AbstractStage
+  {
+  public:
+    explicit LargestFirstStage(size_t lookahead, const char* debugName = "LargestFirstStage", TCost cost = TCost())
+      : AbstractStage(debugName)
+      , m_cost(cost)
+      , m_lookahead(lookahead)
+      , m_sequence(0)
+    {
+      m_inputPort = this->addNewInputPort<T>();
+      m_outputPort = this->addNewOutputPort<T>();
+      assert(m_inputPort);
+      assert(m_outputPort);
+
+      m_heap.reserve(lookahead + 1);
+    }
+
+    InputPort<T>& getInputPort()
+    {
+      assert(m_inputPort);
+      return *m_inputPort;
+    }
+
+    OutputPort<T>& getOutputPort()
+    {
+      assert(m_outputPort);
+      return *m_outputPort;
+    }
+
+  private:
+    struct Entry
+    {
+      uint64 cost;
+      uint64 sequence;
+      T      value;
+    };
+
+    //heap order: most expensive first, ties by arrival
+    static bool heapOrder(const Entry& a, const Entry& b)
+    {
+      if (a.cost != b.cost)
+        return a.cost < b.cost;
+
+      return a.sequence > b.sequence;
+    }
+
+    void sendLargest()
+    {
+      std::pop_heap(m_heap.begin(), m_heap.end(), &heapOrder);
+      m_outputPort->send(std::move(m_heap.back().value));
+      m_heap.pop_back();
+    }
+
+    virtual void execute() override final
+    {
+      auto v = m_inputPort->receive();
+      if (v)
+      {
+        if (isCanceled())
+          return;
+
+        const uint64 cost = m_cost(*v);
+        m_heap.push_back(Entry{ cost, m_sequence++, std::move(*v) });
+        std::push_heap(m_heap.begin(), m_heap.end(), &heapOrder);
+
+        if (m_heap.size() > m_lookahead)
+        {
+          sendLargest();
+        }
+      }
+      else if (m_inputPort->isClosed())
+      {
+        while (!m_heap.empty() && !isCanceled())
+        {
+          sendLargest();
+        }
+
+        m_heap.clear();
+        terminate();
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+
+    virtual unique_ptr<Runnable> createRunnable() override final
+    {
+      return unique_ptr<Runnable>(new ConsumerStageRunnable(this));
+    }
+
+    InputPort<T>*      m_inputPort;
+    OutputPort<T>*     m_outputPort;
+    TCost              m_cost;
+    size_t             m_lookahead;
+    uint64             m_sequence;
+    std::vector<Entry> m_heap;
+  };
+}
@@ -19,12 +19,16 @@
 namespace teetime
 {
   class Md5Hash;
+  class FileBuffer;
+  class MappedFileBuffer;
 
   Md5Hash md5hash(int i);
   Md5Hash md5hash(float f);
   Md5Hash md5hash(const char* s);
   Md5Hash md5hash(const std::string& s);
   Md5Hash md5hash(const std::vector<char>& bytes);
+  Md5Hash md5hash(const FileBuffer& buffer);
+  Md5Hash md5hash(const MappedFileBuffer& buffer);
 
   template<typename T>
   class Md5Hashing final : public AbstractFilterStage<T, Md5Hash>
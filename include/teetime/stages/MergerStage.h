@@ -63,7 +63,10 @@ namespace teetime
         auto v = typedPort->receive();
         if(v)
         {
-          m_outputPort->send(std::move(*v));
+          if(!isCanceled())
+          {
+            m_outputPort->send(std::move(*v));
+          }
         }
         else if(typedPort->isClosed())
         {
@@ -0,0 +1,71 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractConsumerStage.h>
+#include <teetime/Image.h>
+#include <string>
+#include <vector>
+
+namespace teetime
+{
+  /**
+   * Mip level of an image.
+   */
+  struct MipLevel
+  {
+    Image image;
+    unsigned level;       //1 is half the size of the source image, 2 a quarter, ...
+    std::string filename; //filename of the source image
+  };
+
+  inline size_t elementSize(const MipLevel& level)
+  {
+    return sizeof(MipLevel) + level.image.getWidth() * level.image.getHeight() * level.image.getChannels();
+  }
+
+  /**
+   * Creates all mip levels of each image in one pass, each level from the previous one (see createMipChain).
+   * Levels are sent to the output port of their level (see getLevelOutputPort), if there is one, and to the
+   * common output port (see getOutputPort) otherwise. Levels without any port are dropped.
+   */
+  class MipChainStage final : public AbstractConsumerStage<Image>
+  {
+  public:
+    /**
+     * @param maxLevels maximum number of levels per image, 0 creates all levels down to 1x1
+     * @param debugName stage name
+     */
+    explicit MipChainStage(unsigned maxLevels = 0, const char* debugName = "MipChainStage");
+
+    /**
+     * Common output port for all levels.
+     */
+    OutputPort<MipLevel>& getOutputPort();
+
+    /**
+     * Dedicated output port for one level (e.g. to process levels by different workers).
+     */
+    OutputPort<MipLevel>& getLevelOutputPort(unsigned level);
+
+  private:
+    virtual void execute(Image&& value) override;
+
+    unsigned                            m_maxLevels;
+    OutputPort<MipLevel>*               m_outputPort;
+    std::vector<OutputPort<MipLevel>*>  m_levelOutputPorts;
+    std::vector<Image>                  m_levels;
+  };
+}
@@ -0,0 +1,193 @@
+/**
+ * Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "../common.h"
+#include "../ports/InputPort.h"
+#include "../ports/OutputPort.h"
+#include "../Runnable.h"
+#include "../Optional.h"
+#include "AbstractStage.h"
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace teetime
+{
+  /**
+   * Merges multiple sorted input streams into one sorted output stream (k-way merge).
+   * Each input port must deliver its elements in order (according to TCompare). The stage
+   * buffers one element per input port and only emits an element once every input port, that is
+   * not closed yet, has delivered its next element. The smallest buffered element is found
+   * by a binary heap, so each element costs O(log N) comparisons for N input ports.
+   * This stage should be declared active.
+   * @tparam T type of elements to merge
+   * @tparam TCompare strict weak ordering of elements
+   */
+  template<typename T, typename TCompare = std::less<T>>
+  class OrderedMergerStage final : public AbstractStage
+  {
+  public:
+    explicit OrderedMergerStage(const char* debugName = "OrderedMergerStage", TCompare compare = TCompare())
+      : AbstractStage(debugName)
+      , m_compare(compare)
+      , m_initialized(false)
+    {
+      m_outputPort = this->addNewOutputPort<T>();
+      assert(m_outputPort);
+    }
+
+    OutputPort<T>& getOutputPort()
+    {
+      assert(m_outputPort);
+      return *m_outputPort;
+    }
+
+    InputPort<T>& getNewInputPort()
+    {
+      InputPort<T>* p = this->addNewInputPort<T>();
+      assert(p);
+      return *p;
+    }
+
+  private:
+    OutputPort<T>* m_outputPort;
+
+    //comparison used for the heap: ports with the smallest element go first.
+    //ties are resolved by port index, so merging is stable.
+    bool heapOrder(uint32 a, uint32 b) const
+    {
+      const T& ta = *m_heads[a];
+      const T& tb = *m_heads[b];
+
+      if (m_compare(tb, ta))
+        return true;
+
+      if (m_compare(ta, tb))
+        return false;
+
+      return a > b;
+    }
+
+    void initialize()
+    {
+      const uint32 numInputPorts = this->numInputPorts();
+
+      m_heads.resize(numInputPorts);
+      m_heap.reserve(numInputPorts);
+      m_pending.reserve(numInputPorts);
+
+      for (uint32 i = 0; i < numInputPorts; ++i)
+      {
+        m_pending.push_back(i);
+      }
+
+      m_initialized = true;
+    }
+
+    /**
+     * Try to receive the next element of all ports that are missing one.
+     * @return true if all non-closed ports have delivered their next element.
+     */
+    bool fillHeads()
+    {
+      auto isDone = [this](uint32 index) {
+        auto typedPort = unsafe_dynamic_cast<InputPort<T>>(getInputPort(index));
+
+        auto v = typedPort->receive();
+        if (v)
+        {
+          m_heads[index].set(std::move(*v));
+          m_heap.push_back(index);
+          std::push_heap(m_heap.begin(), m_heap.end(), [this](uint32 a, uint32 b) { return heapOrder(a, b); });
+          return true;
+        }
+
+        return typedPort->isClosed();
+      };
+
+      m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), isDone), m_pending.end());
+      return m_pending.empty();
+    }
+
+    void discardInput()
+    {
+      const uint32 numInputPorts = this->numInputPorts();
+      uint32 closedPorts = 0;
+
+      for (uint32 i = 0; i < numInputPorts; ++i)
+      {
+        auto typedPort = unsafe_dynamic_cast<InputPort<T>>(getInputPort(i));
+
+        if (!typedPort->receive() && typedPort->isClosed())
+        {
+          closedPorts += 1;
+        }
+      }
+
+      if (closedPorts == numInputPorts)
+      {
+        terminate();
+      }
+    }
+
+    virtual void execute() override final
+    {
+      if (!m_initialized)
+      {
+        initialize();
+      }
+
+      if (isCanceled())
+      {
+        discardInput();
+        return;
+      }
+
+      if (!fillHeads())
+      {
+        std::this_thread::yield();
+        return;
+      }
+
+      if (m_heap.empty())
+      {
+        //all input ports are closed
+        terminate();
+        return;
+      }
+
+      std::pop_heap(m_heap.begin(), m_heap.end(), [this](uint32 a, uint32 b) { return heapOrder(a, b); });
+      const uint32 index = m_heap.back();
+      m_heap.pop_back();
+
+      m_outputPort->send(std::move(*m_heads[index]));
+      m_heads[index].reset();
+      m_pending.push_back(index);
+    }
+
+    virtual unique_ptr<Runnable> createRunnable() override final
+    {
+      return unique_ptr<Runnable>(new ConsumerStageRunnable(this));
+    }
+
+    TCompare                 m_compare;
+    bool                     m_initialized;
+    std::vector<Optional<T>> m_heads;   //next element of each input port (lookahead)
+    std::vector<uint32>      m_heap;    //ports with a buffered element, ordered by that element
+    std::vector<uint32>      m_pending; //non-closed ports without a buffered element
+  };
+}
@@ -16,20 +16,51 @@
 #pragma once
 #include <teetime/stages/AbstractConsumerStage.h>
 #include <teetime/FileBuffer.h>
+#include <teetime/MappedFileBuffer.h>
 
 namespace teetime
 {
   class Image;
 
-  class ReadImage final : public AbstractConsumerStage<FileBuffer>
+  /**
+   * Decodes images from file content.
+   * @tparam TBuffer file content type, FileBuffer or MappedFileBuffer
+   */
+  template<typename TBuffer>
+  class BasicReadImage final : public AbstractConsumerStage<TBuffer>
   {
   public:
-    explicit ReadImage(const char* debugName = "ReadImage");
+    explicit BasicReadImage(const char* debugName = "ReadImage");
     OutputPort<Image>& getOutputPort();
 
+    /**
+     * Put spent file contents into the given pool, after the image has been decoded.
+     * Mapped file buffers are not recycled (their memory belongs to the page cache).
+     */
+    void setRecyclingPool(shared_ptr<FileBufferPool> pool);
+
+    /**
+     * Decode images at 1/scale of their size (1, 2, 4 or 8), see Image::loadFromMemory.
+     */
+    void setScale(unsigned scale);
+
+    /**
+     * Keep the channels stored in the file (e.g. Gray8 for grayscale images) instead of converting to Rgba8.
+     */
+    void setNativeFormat(bool nativeFormat);
+
   private:
-    virtual void execute(FileBuffer&& buffer) override;
+    virtual void execute(TBuffer&& buffer) override;
 
     OutputPort<Image>* m_outputPort;
+    shared_ptr<FileBufferPool> m_pool;
+    unsigned m_scale;
+    bool m_nativeFormat;
   };
+
+  extern template class BasicReadImage<FileBuffer>;
+  extern template class BasicReadImage<MappedFileBuffer>;
+
+  using ReadImage = BasicReadImage<FileBuffer>;
+  using ReadMappedImage = BasicReadImage<MappedFileBuffer>;
 }
\ No newline at end of file
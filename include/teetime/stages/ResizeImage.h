@@ -16,6 +16,7 @@
 #pragma once
 #include <teetime/stages/FunctionStage.h>
 #include <teetime/Image.h>
+#include <teetime/ImageTile.h>
 
 namespace teetime
 {
@@ -26,10 +27,15 @@ namespace teetime
     size_t height;
   };
 
-  inline Image resizeImage(ImageToResize& image)
+  inline Image resizeImage(const ImageToResize& image)
   {
     return image.image.resize(image.width, image.height);
   }
 
   using ResizeImage = FunctionStage<const ImageToResize&, Image, resizeImage>;
+
+  /**
+   * Halves tiles of an image (see SplitImage with ImageTileTarget::HalfSize).
+   */
+  using DownsampleImageTile = FunctionStage<ImageTile, ImageTile, downsampleTile>;
 }
\ No newline at end of file
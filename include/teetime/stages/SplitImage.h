@@ -0,0 +1,47 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#pragma once
+#include <teetime/stages/AbstractFilterStage.h>
+#include <teetime/ImageTile.h>
+
+namespace teetime
+{
+  /**
+   * Splits images into tiles (see createImageTiles), so a single large image can be processed
+   * by a farm of workers. Use GatherImage to collect the processed images.
+   */
+  class SplitImage final : public AbstractFilterStage<Image, ImageTile>
+  {
+  public:
+    //128x128 RGBA pixels (64KiB), so the source and target region of a tile fit into L2 cache
+    static const size_t DefaultTileSize = 128;
+
+    /**
+     * @param tileSize edge length of tiles (in target pixels)
+     * @param halo number of additional source pixels around each tile (e.g. for filter kernels)
+     * @param mode size of the target image
+     * @param debugName stage name
+     */
+    explicit SplitImage(size_t tileSize = DefaultTileSize, size_t halo = 0, ImageTileTarget mode = ImageTileTarget::SameSize, const char* debugName = "SplitImage");
+
+  private:
+    virtual void execute(Image&& value) override;
+
+    size_t          m_tileSize;
+    size_t          m_halo;
+    ImageTileTarget m_mode;
+  };
+}
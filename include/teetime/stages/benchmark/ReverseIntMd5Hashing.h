@@ -45,6 +45,9 @@ namespace teetime
       int reversed = -1;
       for(int i=0; i<INT_MAX; ++i)
       {
+        if(isCanceled())
+          return;
+
         if(hash == Md5Hash::generate(&i, sizeof(i)))
         {
           reversed = i;
@@ -0,0 +1,282 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/Archive.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/logging.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+using namespace teetime;
+
+namespace
+{
+  const char IndexMagic[8] = { 'T', 'T', 'A', 'R', 'C', 'H', '0', '1' };
+
+  template<typename T>
+  void writeValue(std::ofstream& out, const T& value)
+  {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  template<typename T>
+  bool readValue(std::ifstream& in, T& value)
+  {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+  }
+}
+
+ArchiveWriter::ArchiveWriter(uint64 segmentSize, size_t bufferSize)
+  : m_segmentSize((std::max)(segmentSize, uint64(1)))
+  , m_segment(platform::InvalidFileHandle)
+  , m_segmentIndex(0)
+  , m_segmentOffset(0)
+{
+  m_buffer.reserve((std::max)(bufferSize, size_t(1)));
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+  close();
+}
+
+bool ArchiveWriter::isOpen() const
+{
+  return m_segment != platform::InvalidFileHandle;
+}
+
+bool ArchiveWriter::open(const std::string& basePath)
+{
+  close();
+
+  m_basePath = basePath;
+  m_segmentIndex = 0;
+  m_segmentOffset = 0;
+  m_entries.clear();
+  m_buffer.clear();
+
+  m_segment = platform::createFile(archiveSegmentPath(m_basePath, m_segmentIndex).c_str(), false);
+  return isOpen();
+}
+
+bool ArchiveWriter::flush()
+{
+  assert(isOpen());
+
+  if (m_buffer.empty())
+    return true;
+
+  const size_t size = m_buffer.size();
+  const size_t written = platform::writeFile(m_segment, m_segmentOffset, m_buffer.data(), size);
+  m_segmentOffset += size;
+  m_buffer.clear();
+
+  return written == size;
+}
+
+bool ArchiveWriter::nextSegment()
+{
+  bool success = flush();
+  platform::closeFile(m_segment);
+
+  m_segmentIndex += 1;
+  m_segmentOffset = 0;
+  m_segment = platform::createFile(archiveSegmentPath(m_basePath, m_segmentIndex).c_str(), false);
+
+  return success && isOpen();
+}
+
+bool ArchiveWriter::add(const std::string& name, const uint8* data, size_t size)
+{
+  if (!isOpen())
+    return false;
+
+  //start a new segment, if entry does not fit into current one (but never leave a segment empty)
+  const uint64 segmentUsed = m_segmentOffset + m_buffer.size();
+  if (segmentUsed > 0 && segmentUsed + size > m_segmentSize)
+  {
+    if (!nextSegment())
+      return false;
+  }
+
+  ArchiveEntry entry;
+  entry.name = name;
+  entry.segment = m_segmentIndex;
+  entry.offset = m_segmentOffset + m_buffer.size();
+  entry.length = size;
+
+  if (m_buffer.size() + size > m_buffer.capacity())
+  {
+    if (!flush())
+      return false;
+  }
+
+  if (size > m_buffer.capacity())
+  {
+    //too big for the buffer, write directly
+    if (platform::writeFile(m_segment, m_segmentOffset, data, size) != size)
+      return false;
+
+    m_segmentOffset += size;
+  }
+  else if (size > 0)
+  {
+    m_buffer.insert(m_buffer.end(), data, data + size);
+  }
+
+  m_entries.push_back(std::move(entry));
+  return true;
+}
+
+bool ArchiveWriter::close()
+{
+  if (!isOpen())
+    return false;
+
+  bool success = flush();
+  platform::closeFile(m_segment);
+  m_segment = platform::InvalidFileHandle;
+
+  std::ofstream index(archiveIndexPath(m_basePath), std::ios::binary | std::ios::trunc);
+  index.write(IndexMagic, sizeof(IndexMagic));
+
+  for (const auto& e : m_entries)
+  {
+    writeValue(index, static_cast<uint32>(e.name.size()));
+    index.write(e.name.data(), e.name.size());
+    writeValue(index, e.segment);
+    writeValue(index, e.offset);
+    writeValue(index, e.length);
+  }
+
+  m_entries.clear();
+  return success && static_cast<bool>(index);
+}
+
+ArchiveReader::~ArchiveReader()
+{
+  close();
+}
+
+bool teetime::readArchiveIndex(const std::string& basePath, std::vector<ArchiveEntry>& entries)
+{
+  entries.clear();
+
+  std::ifstream index(archiveIndexPath(basePath), std::ios::binary);
+
+  char magic[sizeof(IndexMagic)];
+  if (!index.read(magic, sizeof(magic)) || std::memcmp(magic, IndexMagic, sizeof(magic)) != 0)
+  {
+    TEETIME_DEBUG() << "invalid archive index: " << archiveIndexPath(basePath);
+    return false;
+  }
+
+  uint32 nameLength = 0;
+  while (readValue(index, nameLength))
+  {
+    ArchiveEntry entry;
+    entry.name.resize(nameLength);
+
+    if ((nameLength > 0 && !index.read(&entry.name[0], nameLength)) ||
+        !readValue(index, entry.segment) ||
+        !readValue(index, entry.offset) ||
+        !readValue(index, entry.length))
+    {
+      TEETIME_DEBUG() << "truncated archive index: " << archiveIndexPath(basePath);
+      entries.clear();
+      return false;
+    }
+
+    entries.push_back(std::move(entry));
+  }
+
+  return true;
+}
+
+bool ArchiveReader::open(const std::string& basePath)
+{
+  close();
+
+  if (!readArchiveIndex(basePath, m_entries))
+    return false;
+
+  uint32 numSegments = 0;
+  for (size_t i = 0; i < m_entries.size(); ++i)
+  {
+    numSegments = (std::max)(numSegments, m_entries[i].segment + 1);
+    m_lookup[m_entries[i].name] = i;
+  }
+
+  for (uint32 i = 0; i < numSegments; ++i)
+  {
+    uint64 size = 0;
+    auto segment = platform::openFile(archiveSegmentPath(basePath, i).c_str(), size);
+
+    if (segment == platform::InvalidFileHandle)
+    {
+      TEETIME_DEBUG() << "missing archive segment: " << archiveSegmentPath(basePath, i);
+      close();
+      return false;
+    }
+
+    m_segments.push_back(segment);
+  }
+
+  m_basePath = basePath;
+  return true;
+}
+
+void ArchiveReader::close()
+{
+  for (auto s : m_segments)
+  {
+    platform::closeFile(s);
+  }
+
+  m_segments.clear();
+  m_entries.clear();
+  m_lookup.clear();
+  m_basePath.clear();
+}
+
+const ArchiveEntry* ArchiveReader::find(const std::string& name) const
+{
+  auto it = m_lookup.find(name);
+  if (it == m_lookup.end())
+    return nullptr;
+
+  return &m_entries[it->second];
+}
+
+bool ArchiveReader::read(const ArchiveEntry& entry, FileBuffer& buffer) const
+{
+  if (entry.segment >= m_segments.size())
+    return false;
+
+  buffer.path = entry.name;
+  buffer.bytes.resize(static_cast<size_t>(entry.length));
+
+  return entry.length == 0 || platform::readFile(m_segments[entry.segment], entry.offset, buffer.bytes.data(), buffer.bytes.size()) == entry.length;
+}
+
+bool ArchiveReader::read(const std::string& name, FileBuffer& buffer) const
+{
+  auto entry = find(name);
+  if (!entry)
+    return false;
+
+  return read(*entry, buffer);
+}
@@ -41,6 +41,7 @@ bool BufferedFile::load(const char* path)
   file.seekg(0, std::ios::beg);
 
   m_path = path;
+  m_mapped.reset();
   m_bytes.resize(static_cast<size_t>(size));
 
   //don't try to read if size is 0 anyway (because buffer.bytes.data() may return null in this case)
@@ -50,4 +51,18 @@ bool BufferedFile::load(const char* path)
   }
 
   return false;
-}
\ No newline at end of file
+}
+
+bool BufferedFile::map(const char* path)
+{
+  assert(path);
+
+  m_bytes.clear();
+  m_bytes.shrink_to_fit();
+
+  if (!m_mapped.map(path))
+    return false;
+
+  m_path = path;
+  return true;
+}
@@ -34,10 +34,27 @@ void Configuration::createConnections()
   for (auto conn : m_connections)
   {
     auto settings = m_stageSettings[conn.in->owner()];
-    (*conn.connectCallback)(conn.out, conn.in, conn.capacity, settings.isActive);
+    conn.connectCallback(conn.out, conn.in, conn.capacity, conn.byteCapacity, settings.isActive, m_memoryBudget);
   }
 }
 
+void Configuration::setMemoryBudget(size_t bytes)
+{
+  if (bytes > 0)
+  {
+    m_memoryBudget = std::make_shared<MemoryBudget>(bytes);
+  }
+  else
+  {
+    m_memoryBudget.reset();
+  }
+}
+
+shared_ptr<const MemoryBudget> Configuration::getMemoryBudget() const
+{
+  return m_memoryBudget;
+}
+
 void Configuration::declareStageActive(shared_ptr<AbstractStage> stage, unsigned cpus)
 {
   m_stages.insert(stage);
@@ -53,6 +70,32 @@ void Configuration::declareStageNonActive(shared_ptr<AbstractStage> stage)
   s.isActive = false;
 }
 
+unsigned Configuration::getCpuAffinity(const AbstractStage* stage) const
+{
+  auto it = m_stageSettings.find(const_cast<AbstractStage*>(stage));
+  if (it == m_stageSettings.end() || !it->second.isActive)
+  {
+    return 0;
+  }
+
+  return it->second.cpuAffinity;
+}
+
+std::vector<shared_ptr<AbstractStage>> Configuration::getStages() const
+{
+  return std::vector<shared_ptr<AbstractStage>>(m_stages.begin(), m_stages.end());
+}
+
+void Configuration::cancel()
+{
+  TEETIME_DEBUG() << "canceling configuration";
+
+  for (const auto& s : m_stages)
+  {
+    s->cancel();
+  }
+}
+
 bool Configuration::isPortConnected(const AbstractInputPort& port) const
 {
   for (const auto& c : m_connections)
@@ -14,8 +14,14 @@
 * limitations under the License.
 */
 #include <teetime/Image.h>
+#include <teetime/PixelPool.h>
+#include <teetime/ImageKernels.h>
+#include <teetime/QoiCodec.h>
 #include <mutex>
+#include <algorithm>
 #include <climits>
+#include <cstdio>
+#include <vector>
 
 TEETIME_WARNING_PUSH
 TEETIME_WARNING_DISABLE_CONSTANT_CONDITION
@@ -23,6 +29,16 @@ TEETIME_WARNING_DISABLE_LOSSY_CONVERSION
 TEETIME_WARNING_DISABLE_UNREFERENCED_PARAMETER
 TEETIME_WARNING_DISABLE_UNREACHABLE
 
+//all codec allocations (results and temporary buffers) are served by the pixel pool
+#define STBI_MALLOC(sz)       teetime::PixelPool::instance().allocate(sz)
+#define STBI_REALLOC(p,newsz) teetime::PixelPool::instance().reallocate(p,newsz)
+#define STBI_FREE(p)          teetime::PixelPool::instance().release(p)
+#define STBIR_MALLOC(size,c)  teetime::PixelPool::instance().allocate(size)
+#define STBIR_FREE(ptr,c)     teetime::PixelPool::instance().release(ptr)
+#define STBIW_MALLOC(sz)       teetime::PixelPool::instance().allocate(sz)
+#define STBIW_REALLOC(p,newsz) teetime::PixelPool::instance().reallocate(p,newsz)
+#define STBIW_FREE(p)          teetime::PixelPool::instance().release(p)
+
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
@@ -54,24 +70,559 @@ static void init_stb()
   }
 }
 
+namespace
+{
+  size_t scaledSize(size_t size, unsigned scale)
+  {
+    return (size + scale - 1) / scale;
+  }
+
+  stbi_uc clampSample(float v)
+  {
+    //truncation only differs from rounding for negative values, which are clamped anyway
+    const int i = static_cast<int>(v + 128.5f);
+    return static_cast<stbi_uc>(i < 0 ? 0 : (i > 255 ? 255 : i));
+  }
+
+  /**
+   * Reduced inverse DCTs: the NxN low frequency coefficients of a block are transformed with an N-point IDCT
+   * (normalized like the 8-point one), which yields the block downscaled by 8/N (see libjpeg's jidctred.c).
+   * The NxN result is written to 'out' (with row stride 'outStride').
+   */
+  const float InvSqrt2 = 0.707106781f;
+  const float Cos1 = 0.923879533f; //cos(pi/8)
+  const float Cos3 = 0.382683432f; //cos(3pi/8)
+
+#ifdef STBI_SSE2
+  //4 point IDCT of four vectors at once
+  void idct4(__m128& v0, __m128& v1, __m128& v2, __m128& v3)
+  {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 e0 = _mm_mul_ps(_mm_add_ps(v0, v2), _mm_set1_ps(InvSqrt2));
+    const __m128 e1 = _mm_mul_ps(_mm_sub_ps(v0, v2), _mm_set1_ps(InvSqrt2));
+    const __m128 o0 = _mm_add_ps(_mm_mul_ps(v1, _mm_set1_ps(Cos1)), _mm_mul_ps(v3, _mm_set1_ps(Cos3)));
+    const __m128 o1 = _mm_sub_ps(_mm_mul_ps(v1, _mm_set1_ps(Cos3)), _mm_mul_ps(v3, _mm_set1_ps(Cos1)));
+
+    v0 = _mm_mul_ps(_mm_add_ps(e0, o0), half);
+    v1 = _mm_mul_ps(_mm_add_ps(e1, o1), half);
+    v2 = _mm_mul_ps(_mm_sub_ps(e1, o1), half);
+    v3 = _mm_mul_ps(_mm_sub_ps(e0, o0), half);
+  }
+
+  __m128 loadCoefficients(const short* data)
+  {
+    const __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+  }
+
+  void reducedIdct4(stbi_uc* out, int outStride, short data[64])
+  {
+    __m128 r0 = loadCoefficients(data);
+    __m128 r1 = loadCoefficients(data + 8);
+    __m128 r2 = loadCoefficients(data + 16);
+    __m128 r3 = loadCoefficients(data + 24);
+
+    //columns, then rows
+    idct4(r0, r1, r2, r3);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    idct4(r0, r1, r2, r3);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    const __m128 bias = _mm_set1_ps(128.0f);
+    const __m128i lo = _mm_packs_epi32(_mm_cvtps_epi32(_mm_add_ps(r0, bias)), _mm_cvtps_epi32(_mm_add_ps(r1, bias)));
+    const __m128i hi = _mm_packs_epi32(_mm_cvtps_epi32(_mm_add_ps(r2, bias)), _mm_cvtps_epi32(_mm_add_ps(r3, bias)));
+    const __m128i pixels = _mm_packus_epi16(lo, hi);
+
+    int rows[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(rows), pixels);
+    for (int y = 0; y < 4; ++y)
+    {
+      memcpy(out + y * outStride, &rows[y], 4);
+    }
+  }
+#else
+  void idct4(const float* in, int inStride, float* out, int outStride)
+  {
+    const float e0 = (in[0] + in[2 * inStride]) * InvSqrt2;
+    const float e1 = (in[0] - in[2 * inStride]) * InvSqrt2;
+    const float o0 = in[inStride] * Cos1 + in[3 * inStride] * Cos3;
+    const float o1 = in[inStride] * Cos3 - in[3 * inStride] * Cos1;
+
+    out[0] = 0.5f * (e0 + o0);
+    out[outStride] = 0.5f * (e1 + o1);
+    out[2 * outStride] = 0.5f * (e1 - o1);
+    out[3 * outStride] = 0.5f * (e0 - o0);
+  }
+
+  void reducedIdct4(stbi_uc* out, int outStride, short data[64])
+  {
+    float in[16];
+    for (int v = 0; v < 4; ++v)
+    {
+      for (int u = 0; u < 4; ++u)
+      {
+        in[v * 4 + u] = data[v * 8 + u];
+      }
+    }
+
+    //columns, then rows
+    float temp[16];
+    for (int u = 0; u < 4; ++u)
+    {
+      idct4(in + u, 4, temp + u, 4);
+    }
+
+    float result[4];
+    for (int y = 0; y < 4; ++y)
+    {
+      idct4(temp + y * 4, 1, result, 1);
+      for (int x = 0; x < 4; ++x)
+      {
+        out[y * outStride + x] = clampSample(result[x]);
+      }
+    }
+  }
+#endif
+
+  void reducedIdct2(stbi_uc* out, int outStride, short data[64])
+  {
+    const float a = data[0] + data[8];
+    const float b = data[0] - data[8];
+    const float c = data[1] + data[9];
+    const float d = data[1] - data[9];
+
+    //all basis values are +-1/sqrt(2), times 0.5 per dimension
+    out[0] = clampSample(0.125f * (a + c));
+    out[1] = clampSample(0.125f * (a - c));
+    out[outStride] = clampSample(0.125f * (b + d));
+    out[outStride + 1] = clampSample(0.125f * (b - d));
+  }
+
+  //1/8 scale: the DC coefficient is the block average
+  void dcOnlyIdct(stbi_uc* out, int, short data[64])
+  {
+    out[0] = clampSample(data[0] * 0.125f);
+  }
+
+  //width of a component plane decoded with NxN pixels per block
+  int scaledPlaneWidth(const stbi__jpeg* z, int k, int n)
+  {
+    return z->img_comp[k].w2 / 8 * n;
+  }
+
+  //NxN corner of block (bx, by) of a component plane
+  stbi_uc* scaledBlock(stbi__jpeg* z, int k, int n, int bx, int by)
+  {
+    return z->img_comp[k].data + by * n * scaledPlaneWidth(z, k, n) + bx * n;
+  }
+
+  /**
+   * Allocate the component planes at 1/scale, with NxN pixels per 8x8 block (see stbi__process_frame_header,
+   * which allocates them at full size). Coefficients of progressive JPEGs are still kept for all 64 frequencies.
+   */
+  bool allocateScaledPlanes(stbi__jpeg* z, int n)
+  {
+    stbi__context* s = z->s;
+
+    if ((1 << 30) / s->img_x / s->img_n < s->img_y)
+      return stbi__err("too large", "Image too large to decode") != 0;
+
+    int h_max = 1;
+    int v_max = 1;
+    for (int i = 0; i < s->img_n; ++i)
+    {
+      h_max = (std::max)(h_max, z->img_comp[i].h);
+      v_max = (std::max)(v_max, z->img_comp[i].v);
+    }
+
+    z->img_h_max = h_max;
+    z->img_v_max = v_max;
+    z->img_mcu_w = h_max * 8;
+    z->img_mcu_h = v_max * 8;
+    z->img_mcu_x = (s->img_x + z->img_mcu_w - 1) / z->img_mcu_w;
+    z->img_mcu_y = (s->img_y + z->img_mcu_h - 1) / z->img_mcu_h;
+
+    for (int i = 0; i < s->img_n; ++i)
+    {
+      auto& comp = z->img_comp[i];
+      comp.x = (s->img_x * comp.h + h_max - 1) / h_max;
+      comp.y = (s->img_y * comp.v + v_max - 1) / v_max;
+      comp.w2 = z->img_mcu_x * comp.h * 8;
+      comp.h2 = z->img_mcu_y * comp.v * 8;
+
+      //freed by stbi__cleanup_jpeg
+      comp.raw_data = stbi__malloc(static_cast<size_t>(comp.w2 / 8 * n) * (comp.h2 / 8 * n) + 15);
+      if (!comp.raw_data)
+        return stbi__err("outofmem", "Out of memory") != 0;
+
+      comp.data = reinterpret_cast<stbi_uc*>((reinterpret_cast<size_t>(comp.raw_data) + 15) & ~size_t(15));
+
+      if (z->progressive)
+      {
+        comp.coeff_w = (comp.w2 + 7) >> 3;
+        comp.coeff_h = (comp.h2 + 7) >> 3;
+        comp.raw_coeff = stbi__malloc(comp.coeff_w * comp.coeff_h * 64 * sizeof(short) + 15);
+        if (!comp.raw_coeff)
+          return stbi__err("outofmem", "Out of memory") != 0;
+
+        comp.coeff = reinterpret_cast<short*>((reinterpret_cast<size_t>(comp.raw_coeff) + 15) & ~size_t(15));
+      }
+    }
+
+    return true;
+  }
+
+  //count down the restart interval after an MCU, false at the end of the scan (see stbi__parse_entropy_coded_data)
+  bool nextMcu(stbi__jpeg* z)
+  {
+    if (--z->todo <= 0)
+    {
+      if (z->code_bits < 24)
+        stbi__grow_buffer_unsafe(z);
+
+      if (!STBI__RESTART(z->marker))
+        return false;
+
+      stbi__jpeg_reset(z);
+    }
+
+    return true;
+  }
+
+  /**
+   * stbi__parse_entropy_coded_data for planes allocated by allocateScaledPlanes: the reduced IDCT writes
+   * each block straight into its NxN corner of the plane. Progressive scans only collect coefficients,
+   * so they are left to stb_image.
+   */
+  bool parseScaledEntropyCodedData(stbi__jpeg* z, int n)
+  {
+    if (z->progressive)
+      return stbi__parse_entropy_coded_data(z) != 0;
+
+    stbi__jpeg_reset(z);
+
+    STBI_SIMD_ALIGN(short, data[64]);
+
+    if (z->scan_n == 1)
+    {
+      //non-interleaved: one block per MCU, covering the component's own pixels only
+      const int k = z->order[0];
+      const auto& comp = z->img_comp[k];
+      const int w = (comp.x + 7) >> 3;
+      const int h = (comp.y + 7) >> 3;
+
+      for (int by = 0; by < h; ++by)
+      {
+        for (int bx = 0; bx < w; ++bx)
+        {
+          if (!stbi__jpeg_decode_block(z, data, z->huff_dc + comp.hd, z->huff_ac + comp.ha, z->fast_ac[comp.ha], k, z->dequant[comp.tq]))
+            return false;
+
+          z->idct_block_kernel(scaledBlock(z, k, n, bx, by), scaledPlaneWidth(z, k, n), data);
+
+          if (!nextMcu(z))
+            return true;
+        }
+      }
+
+      return true;
+    }
+
+    for (int my = 0; my < z->img_mcu_y; ++my)
+    {
+      for (int mx = 0; mx < z->img_mcu_x; ++mx)
+      {
+        for (int c = 0; c < z->scan_n; ++c)
+        {
+          const int k = z->order[c];
+          const auto& comp = z->img_comp[k];
+
+          for (int y = 0; y < comp.v; ++y)
+          {
+            for (int x = 0; x < comp.h; ++x)
+            {
+              if (!stbi__jpeg_decode_block(z, data, z->huff_dc + comp.hd, z->huff_ac + comp.ha, z->fast_ac[comp.ha], k, z->dequant[comp.tq]))
+                return false;
+
+              z->idct_block_kernel(scaledBlock(z, k, n, mx * comp.h + x, my * comp.v + y), scaledPlaneWidth(z, k, n), data);
+            }
+          }
+        }
+
+        if (!nextMcu(z))
+          return true;
+      }
+    }
+
+    return true;
+  }
+
+  //transform the coefficients of a progressive JPEG (see stbi__jpeg_finish)
+  void finishScaledJpeg(stbi__jpeg* z, int n)
+  {
+    if (!z->progressive)
+      return;
+
+    for (int k = 0; k < z->s->img_n; ++k)
+    {
+      const auto& comp = z->img_comp[k];
+      const int w = (comp.x + 7) >> 3;
+      const int h = (comp.y + 7) >> 3;
+
+      for (int by = 0; by < h; ++by)
+      {
+        for (int bx = 0; bx < w; ++bx)
+        {
+          short* data = comp.coeff + 64 * (bx + by * comp.coeff_w);
+          stbi__jpeg_dequantize(data, z->dequant[comp.tq]);
+          z->idct_block_kernel(scaledBlock(z, k, n, bx, by), scaledPlaneWidth(z, k, n), data);
+        }
+      }
+    }
+  }
+
+  /**
+   * stbi__decode_jpeg_image with component planes at 1/scale (n = 8 / scale pixels per block and dimension).
+   */
+  bool decodeScaledJpegImage(stbi__jpeg* z, int n)
+  {
+    for (int k = 0; k < 4; ++k)
+    {
+      z->img_comp[k].raw_data = nullptr;
+      z->img_comp[k].raw_coeff = nullptr;
+    }
+    z->restart_interval = 0;
+
+    //the header scan skips stb_image's full size allocation
+    if (!stbi__decode_jpeg_header(z, STBI__SCAN_header) || !allocateScaledPlanes(z, n))
+      return false;
+
+    int m = stbi__get_marker(z);
+    while (!stbi__EOI(m))
+    {
+      if (stbi__SOS(m))
+      {
+        if (!stbi__process_scan_header(z) || !parseScaledEntropyCodedData(z, n))
+          return false;
+
+        if (z->marker == STBI__MARKER_none)
+        {
+          //zeros after the image data (see stbi__decode_jpeg_image)
+          while (!stbi__at_eof(z->s))
+          {
+            const int x = stbi__get8(z->s);
+            if (x == 255)
+            {
+              z->marker = stbi__get8(z->s);
+              break;
+            }
+            else if (x != 0)
+            {
+              return stbi__err("junk before marker", "Corrupt JPEG") != 0;
+            }
+          }
+        }
+      }
+      else if (!stbi__process_marker(z, m))
+      {
+        return false;
+      }
+
+      m = stbi__get_marker(z);
+    }
+
+    finishScaledJpeg(z, n);
+    return true;
+  }
+
+  /**
+   * Decode a JPEG at 1/scale of its resolution (scale 2, 4 or 8). Only the low frequency part of each block
+   * is transformed, straight into component planes of the reduced size (see decodeScaledJpegImage), so no
+   * full size buffer is allocated. Chroma is upsampled (nearest neighbor) at the reduced resolution.
+   * @param channels number of output channels (1 for grayscale JPEGs, 3 or 4)
+   * @return pixels allocated by STBI_MALLOC, or nullptr if decoding failed.
+   */
+  stbi_uc* loadScaledJpeg(stbi__context& context, unsigned scale, bool nativeFormat, int& width, int& height, int& channels)
+  {
+    stbi__jpeg* j = static_cast<stbi__jpeg*>(stbi__malloc(sizeof(stbi__jpeg)));
+    if (!j)
+      return nullptr;
+
+    j->s = &context;
+    stbi__setup_jpeg(j);
+
+    const int n = static_cast<int>(8 / scale);
+    switch (n)
+    {
+    case 4: j->idct_block_kernel = reducedIdct4; break;
+    case 2: j->idct_block_kernel = reducedIdct2; break;
+    default: j->idct_block_kernel = dcOnlyIdct; break;
+    }
+
+    j->s->img_n = 0; //make stbi__cleanup_jpeg safe
+    for (int k = 0; k < 4; ++k)
+    {
+      j->img_comp[k].linebuf = nullptr;
+    }
+
+    stbi_uc* output = nullptr;
+
+    if (decodeScaledJpegImage(j, n))
+    {
+      const int numComponents = j->s->img_n;
+      const int numChannels = nativeFormat ? (numComponents == 1 ? 1 : 3) : 4;
+      const size_t outWidth = scaledSize(j->s->img_x, scale);
+      const size_t outHeight = scaledSize(j->s->img_y, scale);
+
+      //the color conversion kernel always writes 4 bytes per pixel
+      output = static_cast<stbi_uc*>(stbi__malloc(outWidth * outHeight * numChannels + 1));
+      if (output)
+      {
+        std::vector<stbi_uc> lines[4];
+        const stbi_uc* rows[4] = {};
+
+        for (size_t y = 0; y < outHeight; ++y)
+        {
+          for (int k = 0; k < numComponents; ++k)
+          {
+            const int hs = j->img_h_max / j->img_comp[k].h;
+            const int vs = j->img_v_max / j->img_comp[k].v;
+            const stbi_uc* row = j->img_comp[k].data + (y / vs) * scaledPlaneWidth(j, k, n);
+
+            if (hs == 1)
+            {
+              rows[k] = row;
+            }
+            else
+            {
+              lines[k].resize(outWidth + hs);
+              stbi_uc* line = lines[k].data();
+              for (size_t x = 0; x < outWidth; x += hs, ++row)
+              {
+                for (int i = 0; i < hs; ++i)
+                {
+                  *line++ = *row;
+                }
+              }
+              rows[k] = lines[k].data();
+            }
+          }
+
+          stbi_uc* out = output + y * outWidth * numChannels;
+
+          if (numChannels == 1)
+          {
+            memcpy(out, rows[0], outWidth);
+          }
+          else if (numComponents == 3 && j->rgb != 3)
+          {
+            j->YCbCr_to_RGB_kernel(out, rows[0], rows[1], rows[2], static_cast<int>(outWidth), numChannels);
+          }
+          else
+          {
+            for (size_t x = 0; x < outWidth; ++x)
+            {
+              out[0] = rows[0][x];
+              out[1] = rows[numComponents == 3 ? 1 : 0][x];
+              out[2] = rows[numComponents == 3 ? 2 : 0][x];
+              if (numChannels == 4)
+              {
+                out[3] = 255;
+              }
+              out += numChannels;
+            }
+          }
+        }
+
+        width = static_cast<int>(outWidth);
+        height = static_cast<int>(outHeight);
+        channels = numChannels;
+      }
+    }
+
+    stbi__cleanup_jpeg(j);
+    STBI_FREE(j);
+
+    return output;
+  }
+
+  /**
+   * Decode an image, JPEGs at 1/scale of their size, other formats at full size.
+   * @param reduced set to true, if the image was decoded at reduced size
+   */
+  stbi_uc* decode(stbi__context& context, unsigned scale, bool nativeFormat, int& width, int& height, int& channels, bool& reduced)
+  {
+    reduced = false;
+
+    if (scale > 1 && stbi__jpeg_test(&context))
+    {
+      reduced = true;
+      return loadScaledJpeg(context, scale, nativeFormat, width, height, channels);
+    }
+
+    int comp = 0;
+    stbi_uc* p = stbi__load_flip(&context, &width, &height, &comp, nativeFormat ? 0 : 4);
+    channels = nativeFormat ? comp : 4;
+
+    return p;
+  }
+
+  /**
+   * Read the whole file into 'content', if it is a QOI image (stb_image does not know QOI).
+   * Otherwise the file position is left unchanged.
+   */
+  bool readQoiFile(FILE* file, std::vector<uint8>& content)
+  {
+    uint8 header[14];
+    const size_t n = fread(header, 1, sizeof(header), file);
+    if (!isQoi(header, n))
+    {
+      fseek(file, 0, SEEK_SET);
+      return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    content.resize(size > 0 ? static_cast<size_t>(size) : 0);
+    return fread(content.data(), 1, content.size(), file) == content.size();
+  }
+
+  void writeToVector(void* context, void* data, int size)
+  {
+    auto v = static_cast<std::vector<uint8>*>(context);
+    auto p = static_cast<const uint8*>(data);
+    v->insert(v->end(), p, p + size);
+  }
+}
+
 Image::Image()
   : m_width(0)
   , m_height(0)
+  , m_format(PixelFormat::Rgba8)
   , m_data(nullptr)
 {}
 
 Image::Image(const Image& rhs)
   : m_width(rhs.m_width)
   , m_height(rhs.m_height)
-  , m_data((Rgba*)::malloc(rhs.m_width * rhs.m_height * sizeof(Image::Rgba)))
+  , m_format(rhs.m_format)
+  , m_data(nullptr)
   , m_filename(rhs.m_filename)
 {
-  memcpy(m_data, rhs.m_data, rhs.m_width * rhs.m_height * sizeof(Image::Rgba));
+  if (rhs.m_data)
+  {
+    const size_t size = rhs.m_width * rhs.m_height * rhs.getChannels();
+    m_data = static_cast<uint8*>(PixelPool::instance().allocate(size));
+    memcpy(m_data, rhs.m_data, size);
+  }
 }
 
 Image::Image(Image&& rhs)
   : m_width(rhs.m_width)
   , m_height(rhs.m_height)
+  , m_format(rhs.m_format)
   , m_data(rhs.m_data)
   , m_filename(std::move(rhs.m_filename))
 {
@@ -87,14 +638,20 @@ Image::~Image()
 
 const Image& Image::operator =(const Image& rhs)
 {
-  reset();
+  if (this == &rhs)
+    return *this;
 
-  m_width = rhs.m_width;
-  m_height = rhs.m_height;
-  m_data = (Rgba*)::malloc(rhs.m_width * rhs.m_height * sizeof(Image::Rgba));
-  m_filename = rhs.m_filename;
+  if (!rhs.m_data)
+  {
+    reset();
+  }
+  else
+  {
+    setSize(rhs.m_width, rhs.m_height, rhs.m_format);
+    memcpy(m_data, rhs.m_data, rhs.m_width * rhs.m_height * rhs.getChannels());
+  }
 
-  memcpy(m_data, rhs.m_data, rhs.m_width * rhs.m_height * sizeof(Image::Rgba));
+  m_filename = rhs.m_filename;
 
   return *this;
 }
@@ -105,6 +662,7 @@ const Image& Image::operator =(Image&& rhs)
 
   m_width = rhs.m_width;
   m_height = rhs.m_height;
+  m_format = rhs.m_format;
   m_data = rhs.m_data;
   m_filename = std::move(rhs.m_filename);
 
@@ -117,10 +675,7 @@ const Image& Image::operator =(Image&& rhs)
 
 void Image::reset()
 {
-  if (m_data)
-  {
-    stbi_image_free(m_data);
-  }
+  PixelPool::instance().release(m_data);
 
   m_data = nullptr;
   m_height = 0;
@@ -128,74 +683,270 @@ void Image::reset()
   m_filename = "";
 }
 
+void Image::setSize(size_t width, size_t height, PixelFormat format)
+{
+  const size_t size = width * height * numChannels(format);
+
+  if (size == 0)
+  {
+    PixelPool::instance().release(m_data);
+    m_data = nullptr;
+  }
+  else if (!m_data || PixelPool::blockSize(m_data) < size)
+  {
+    PixelPool::instance().release(m_data);
+    m_data = static_cast<uint8*>(PixelPool::instance().allocate(size));
+  }
+
+  m_width = width;
+  m_height = height;
+  m_format = format;
+}
+
 bool Image::loadFromFile(const std::string& filename)
+{
+  return loadFromFile(filename, 1);
+}
+
+bool Image::loadFromMemory(const uint8* data, size_t dataSize, const char* filename)
+{
+  return loadFromMemory(data, dataSize, filename, 1);
+}
+
+bool Image::loadFromFile(const std::string& filename, unsigned scale, bool nativeFormat)
 {
   reset();
 
+  if (scale != 1 && scale != 2 && scale != 4 && scale != 8)
+    return false;
+
   init_stb();
+  FILE* file = stbi__fopen(filename.c_str(), "rb");
+  if (!file)
+    return false;
+
+  std::vector<uint8> qoi;
+  if (readQoiFile(file, qoi))
+  {
+    fclose(file);
+    return loadFromMemory(qoi.data(), qoi.size(), filename.c_str(), scale, nativeFormat);
+  }
+
+  stbi__context context;
+  stbi__start_file(&context, file);
+
   int width = 0;
   int height = 0;
-  int comp = 0;
+  int channels = 0;
+  bool reduced = false;
+  stbi_uc* p = decode(context, scale, nativeFormat, width, height, channels, reduced);
+  fclose(file);
+
+  return takePixels(p, width, height, channels, reduced ? 1 : scale, filename);
+}
 
-  if (auto p = stbi_load(filename.c_str(), &width, &height, &comp, 4))
+bool Image::loadFromMemory(const uint8* data, size_t dataSize, const char* filename, unsigned scale, bool nativeFormat)
+{
+  reset();
+
+  if (scale != 1 && scale != 2 && scale != 4 && scale != 8)
+    return false;
+
+  if (isQoi(data, dataSize))
   {
-    assert(width > 0);
-    assert(height > 0);
-    assert(comp > 0);
+    if (!decodeQoi(data, dataSize, *this, nativeFormat))
+      return false;
 
-    m_data = (Image::Rgba*)p;
-    m_width = width;
-    m_height = height;
-    m_filename = filename;
+    return finishLoading(scale, filename);
+  }
 
-    return true;
+  init_stb();
+  assert(dataSize < INT_MAX);
+
+  stbi__context context;
+  stbi__start_mem(&context, data, static_cast<int>(dataSize));
+
+  int width = 0;
+  int height = 0;
+  int channels = 0;
+  bool reduced = false;
+  stbi_uc* p = decode(context, scale, nativeFormat, width, height, channels, reduced);
+
+  return takePixels(p, width, height, channels, reduced ? 1 : scale, filename);
+}
+
+bool Image::takePixels(uint8* pixels, int width, int height, int channels, unsigned scale, const std::string& filename)
+{
+  if (!pixels)
+    return false;
+
+  assert(width > 0);
+  assert(height > 0);
+  assert(channels > 0);
+
+  m_data = pixels;
+  m_width = width;
+  m_height = height;
+  m_format = pixelFormatFromChannels(channels);
+
+  return finishLoading(scale, filename);
+}
+
+bool Image::finishLoading(unsigned scale, const std::string& filename)
+{
+  //formats without reduced decoding: shrink the full resolution image
+  if (scale > 1)
+  {
+    Image full(std::move(*this));
+    if (!full.resizeInto(*this, scaledSize(full.m_width, scale), scaledSize(full.m_height, scale)))
+      return false;
   }
 
-  return false;
+  m_filename = filename;
+  return true;
 }
 
-bool Image::loadFromMemory(const uint8* data, size_t dataSize, const char* filename)
+bool Image::probe(const uint8* data, size_t dataSize, ImageInfo& info)
 {
-  reset();
+  assert(dataSize < INT_MAX);
+
+  if (isQoi(data, dataSize))
+    return probeQoi(data, dataSize, info);
 
-  init_stb();
   int width = 0;
   int height = 0;
   int comp = 0;
 
-  assert(dataSize < INT_MAX);
+  if (!stbi_info_from_memory(data, static_cast<int>(dataSize), &width, &height, &comp))
+    return false;
+
+  info.width = width;
+  info.height = height;
+  info.channels = comp;
+
+  return true;
+}
+
+bool Image::probe(const std::string& filename, ImageInfo& info)
+{
+  FILE* file = stbi__fopen(filename.c_str(), "rb");
+  if (!file)
+    return false;
+
+  uint8 header[14];
+  const size_t n = fread(header, 1, sizeof(header), file);
+  fclose(file);
+
+  if (isQoi(header, n))
+    return probeQoi(header, n, info);
+
+  int width = 0;
+  int height = 0;
+  int comp = 0;
+
+  if (!stbi_info(filename.c_str(), &width, &height, &comp))
+    return false;
 
-  if (auto p = stbi_load_from_memory(data, static_cast<int>(dataSize), &width, &height, &comp, 4))
+  info.width = width;
+  info.height = height;
+  info.channels = comp;
+
+  return true;
+}
+
+Image Image::resize(size_t width, size_t height) const
+{
+  Image image;
+  resizeInto(image, width, height);
+
+  return image;
+}
+
+bool Image::resizeInto(Image& target, size_t width, size_t height) const
+{
+  assert(&target != this);
+
+  //exact halvings (e.g. mip levels) use the box filter, which is much faster than the generic resampler
+  if (m_data)
   {
-    assert(width > 0);
-    assert(height > 0);
-    assert(comp > 0);
+    if (unsigned steps = countHalvingSteps(m_width, m_height, width, height))
+    {
+      const Image* source = this;
+      Image temp[2];
 
-    m_data = (Image::Rgba*)p;
-    m_width = width;
-    m_height = height;
-    m_filename = filename;
+      for (unsigned i = 0; i < steps; ++i)
+      {
+        Image& level = (i + 1 == steps) ? target : temp[i % 2];
+        level.setSize(halfSize(source->m_width), halfSize(source->m_height), m_format);
+        downsample2x2(source->m_data, source->m_width, source->m_height, source->m_width, level.m_data, level.m_width, m_format);
+        source = &level;
+      }
 
+      return true;
+    }
+  }
+
+  target.setSize(width, height, m_format);
+
+  if (stbir_resize_uint8(m_data, (int)m_width, (int)m_height, 0, target.m_data, (int)width, (int)height, 0, (int)getChannels()) != 0)
+  {
     return true;
   }
 
+  target.reset();
   return false;
 }
 
-Image Image::resize(size_t width, size_t height) const
+Image Image::convert(PixelFormat format) const
 {
-  unique_ptr<Rgba[]> p(new Rgba[width * height]);
-
   Image image;
+  convertInto(image, format);
+
+  return image;
+}
 
-  if (stbir_resize_uint8((const uint8*)m_data, (int)m_width, (int)m_height, 0, (uint8*)p.get(), (int)width, (int)height, 0, 4) != 0)
+void Image::convertInto(Image& target, PixelFormat format) const
+{
+  assert(&target != this);
+
+  const unsigned from = getChannels();
+  const unsigned to = numChannels(format);
+  const size_t count = m_width * m_height;
+
+  target.setSize(m_width, m_height, format);
+
+  if (from == to)
   {
-    image.m_data = p.release();
-    image.m_width = width;
-    image.m_height = height;
+    memcpy(target.m_data, m_data, count * to);
+    return;
   }
 
-  return image;
+  const uint8* src = m_data;
+  uint8* dst = target.m_data;
+
+  for (size_t i = 0; i < count; ++i, src += from, dst += to)
+  {
+    const uint8 r = src[0];
+    const uint8 g = (from >= 3) ? src[1] : src[0];
+    const uint8 b = (from >= 3) ? src[2] : src[0];
+    const uint8 a = hasAlpha(m_format) ? src[from - 1] : 255;
+
+    if (to <= 2)
+    {
+      dst[0] = (from >= 3) ? stbi__compute_y(r, g, b) : r;
+    }
+    else
+    {
+      dst[0] = r;
+      dst[1] = g;
+      dst[2] = b;
+    }
+
+    if (hasAlpha(format))
+    {
+      dst[to - 1] = a;
+    }
+  }
 }
 
 bool Image::saveToFile(const std::string& filename) const
@@ -220,6 +971,9 @@ bool Image::saveToFile(const std::string& filename) const
   if (strcmp(ext, ".bmp") == 0)
     return saveToBmpFile(filename);
 
+  if (strcmp(ext, ".qoi") == 0)
+    return saveToQoiFile(filename);
+
   return false;
 }
 
@@ -233,6 +987,8 @@ bool Image::saveToFile(const std::string& filename, ImageFileFormat format) cons
     return saveToBmpFile(filename);
   case ImageFileFormat::Png:
     return saveToPngFile(filename);
+  case ImageFileFormat::Qoi:
+    return saveToQoiFile(filename);
   default:
     return false;
   }
@@ -240,15 +996,39 @@ bool Image::saveToFile(const std::string& filename, ImageFileFormat format) cons
 
 bool Image::saveToPngFile(const std::string& filename) const
 {
-  return stbi_write_png(filename.c_str(), (int)m_width, (int)m_height, 4, m_data, 0) != 0;
+  return stbi_write_png(filename.c_str(), (int)m_width, (int)m_height, (int)getChannels(), m_data, 0) != 0;
 }
 
 bool Image::saveToTgaFile(const std::string& filename) const
 {
-  return stbi_write_tga(filename.c_str(), (int)m_width, (int)m_height, 4, m_data) != 0;
+  return stbi_write_tga(filename.c_str(), (int)m_width, (int)m_height, (int)getChannels(), m_data) != 0;
 }
 
 bool Image::saveToBmpFile(const std::string& filename) const
 {
-  return stbi_write_bmp(filename.c_str(), (int)m_width, (int)m_height, 4, m_data) != 0;
+  return stbi_write_bmp(filename.c_str(), (int)m_width, (int)m_height, (int)getChannels(), m_data) != 0;
+}
+
+bool Image::saveToQoiFile(const std::string& filename) const
+{
+  return writeQoiFile(*this, filename);
+}
+
+bool Image::saveToMemory(ImageFileFormat format, std::vector<uint8>& data) const
+{
+  data.clear();
+
+  switch (format)
+  {
+  case ImageFileFormat::Tga:
+    return stbi_write_tga_to_func(writeToVector, &data, (int)m_width, (int)m_height, (int)getChannels(), m_data) != 0;
+  case ImageFileFormat::Bmp:
+    return stbi_write_bmp_to_func(writeToVector, &data, (int)m_width, (int)m_height, (int)getChannels(), m_data) != 0;
+  case ImageFileFormat::Png:
+    return stbi_write_png_to_func(writeToVector, &data, (int)m_width, (int)m_height, (int)getChannels(), m_data, 0) != 0;
+  case ImageFileFormat::Qoi:
+    return encodeQoi(*this, data);
+  default:
+    return false;
+  }
 }
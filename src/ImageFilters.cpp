@@ -0,0 +1,250 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/ImageFilters.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace teetime;
+
+namespace
+{
+  unsigned numColorPlanes(const PlanarImage& image)
+  {
+    return image.hasAlpha() ? image.getNumPlanes() - 1 : image.getNumPlanes();
+  }
+
+  std::vector<float> gaussianKernel(float sigma)
+  {
+    const int radius = static_cast<int>(gaussianRadius(sigma));
+    std::vector<float> kernel(2 * radius + 1);
+
+    float sum = 0;
+    for (int i = -radius; i <= radius; ++i)
+    {
+      const float w = std::exp(-(i * i) / (2.0f * sigma * sigma));
+      kernel[i + radius] = w;
+      sum += w;
+    }
+
+    for (auto& w : kernel)
+    {
+      w /= sum;
+    }
+
+    return kernel;
+  }
+
+  //dst += w * src, the inner loop of both blur passes
+  void multiplyAdd(float* dst, const float* src, float w, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      dst[i] += w * src[i];
+    }
+  }
+
+  /**
+   * Convolve one plane with a symmetric kernel, first horizontally then vertically.
+   * Both passes are sums of whole (shifted) rows, so there is no per-pixel branching.
+   */
+  void blurPlane(const float* src, float* dst, size_t width, size_t height, const std::vector<float>& kernel, std::vector<float>& temp, std::vector<float>& padded)
+  {
+    const size_t radius = kernel.size() / 2;
+
+    temp.assign(width * height, 0.0f);
+    padded.resize(width + 2 * radius);
+
+    //horizontal: pad the row with its edge pixels, then add shifted copies
+    for (size_t y = 0; y < height; ++y)
+    {
+      const float* row = src + y * width;
+      std::fill(padded.begin(), padded.begin() + radius, row[0]);
+      std::copy(row, row + width, padded.begin() + radius);
+      std::fill(padded.begin() + radius + width, padded.end(), row[width - 1]);
+
+      float* out = temp.data() + y * width;
+      for (size_t k = 0; k < kernel.size(); ++k)
+      {
+        multiplyAdd(out, padded.data() + k, kernel[k], width);
+      }
+    }
+
+    //vertical: add weighted rows, rows beyond the edges are clamped
+    for (size_t y = 0; y < height; ++y)
+    {
+      float* out = dst + y * width;
+      std::fill(out, out + width, 0.0f);
+
+      for (size_t k = 0; k < kernel.size(); ++k)
+      {
+        const ptrdiff_t sy = static_cast<ptrdiff_t>(y + k) - static_cast<ptrdiff_t>(radius);
+        const size_t row = static_cast<size_t>((std::min)((std::max)(sy, ptrdiff_t(0)), static_cast<ptrdiff_t>(height) - 1));
+        multiplyAdd(out, temp.data() + row * width, kernel[k], width);
+      }
+    }
+  }
+
+  /**
+   * Blur all planes of 'src' into 'dst' (same size and format).
+   * With alpha, the color planes are premultiplied before and divided by the blurred alpha afterwards,
+   * so colors of transparent pixels don't bleed into their neighbours (no dark or colored halos).
+   */
+  void blurPlanes(const PlanarImage& src, PlanarImage& dst, const std::vector<float>& kernel)
+  {
+    const size_t width = src.getWidth();
+    const size_t height = src.getHeight();
+    const size_t count = width * height;
+
+    std::vector<float> temp;
+    std::vector<float> padded;
+
+    if (!src.hasAlpha())
+    {
+      for (unsigned c = 0; c < src.getNumPlanes(); ++c)
+      {
+        blurPlane(src.getPlane(c), dst.getPlane(c), width, height, kernel, temp, padded);
+      }
+
+      return;
+    }
+
+    const unsigned alphaPlane = src.getNumPlanes() - 1;
+    const float* alpha = src.getPlane(alphaPlane);
+    const float* blurredAlpha = dst.getPlane(alphaPlane);
+    blurPlane(alpha, dst.getPlane(alphaPlane), width, height, kernel, temp, padded);
+
+    std::vector<float> premultiplied(count);
+
+    for (unsigned c = 0; c < alphaPlane; ++c)
+    {
+      const float* in = src.getPlane(c);
+      for (size_t i = 0; i < count; ++i)
+      {
+        premultiplied[i] = in[i] * alpha[i];
+      }
+
+      float* out = dst.getPlane(c);
+      blurPlane(premultiplied.data(), out, width, height, kernel, temp, padded);
+
+      for (size_t i = 0; i < count; ++i)
+      {
+        out[i] = blurredAlpha[i] > 0 ? out[i] / blurredAlpha[i] : 0.0f;
+      }
+    }
+  }
+}
+
+size_t teetime::gaussianRadius(float sigma)
+{
+  return (std::max)(size_t(1), static_cast<size_t>(std::ceil(3.0f * sigma)));
+}
+
+void teetime::grayscale(const PlanarImage& src, PlanarImage& dst)
+{
+  assert(&src != &dst);
+
+  const size_t count = src.getWidth() * src.getHeight();
+  dst.setSize(src.getWidth(), src.getHeight(), src.hasAlpha() ? PixelFormat::GrayAlpha8 : PixelFormat::Gray8);
+
+  if (numColorPlanes(src) >= 3)
+  {
+    const float* r = src.getPlane(0);
+    const float* g = src.getPlane(1);
+    const float* b = src.getPlane(2);
+    float* gray = dst.getPlane(0);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      gray[i] = (77.0f / 256.0f) * r[i] + (150.0f / 256.0f) * g[i] + (29.0f / 256.0f) * b[i];
+    }
+  }
+  else
+  {
+    memcpy(dst.getPlane(0), src.getPlane(0), count * sizeof(float));
+  }
+
+  if (src.hasAlpha())
+  {
+    memcpy(dst.getPlane(1), src.getPlane(src.getNumPlanes() - 1), count * sizeof(float));
+  }
+}
+
+void teetime::gammaCorrect(PlanarImage& image, float gamma)
+{
+  assert(gamma > 0);
+
+  const float exponent = 1.0f / gamma;
+  const size_t count = image.getWidth() * image.getHeight();
+
+  for (unsigned c = 0; c < numColorPlanes(image); ++c)
+  {
+    float* plane = image.getPlane(c);
+    for (size_t i = 0; i < count; ++i)
+    {
+      plane[i] = std::pow(plane[i], exponent);
+    }
+  }
+}
+
+void teetime::gaussianBlur(const PlanarImage& src, PlanarImage& dst, float sigma)
+{
+  assert(&src != &dst);
+  assert(sigma > 0);
+
+  const size_t width = src.getWidth();
+  const size_t height = src.getHeight();
+  dst.setSize(width, height, src.getFormat());
+
+  if (width == 0 || height == 0)
+    return;
+
+  blurPlanes(src, dst, gaussianKernel(sigma));
+}
+
+void teetime::sharpen(const PlanarImage& src, PlanarImage& dst, float sigma, float amount)
+{
+  assert(&src != &dst);
+  assert(sigma > 0);
+
+  const size_t width = src.getWidth();
+  const size_t height = src.getHeight();
+  const size_t count = width * height;
+  dst.setSize(width, height, src.getFormat());
+
+  if (count == 0)
+    return;
+
+  //blur into dst, then turn the color planes into the sharpened planes
+  blurPlanes(src, dst, gaussianKernel(sigma));
+
+  for (unsigned c = 0; c < numColorPlanes(src); ++c)
+  {
+    const float* in = src.getPlane(c);
+    float* out = dst.getPlane(c);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      out[i] = in[i] + amount * (in[i] - out[i]);
+    }
+  }
+
+  if (src.hasAlpha())
+  {
+    const unsigned alpha = src.getNumPlanes() - 1;
+    memcpy(dst.getPlane(alpha), src.getPlane(alpha), count * sizeof(float));
+  }
+}
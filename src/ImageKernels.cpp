@@ -0,0 +1,435 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/ImageKernels.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEETIME_HAS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define TEETIME_HAS_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace teetime;
+
+namespace
+{
+  /**
+   * Average of source columns [x0, x1) and rows [y0, y1) (up to 3x3 pixels).
+   */
+  Image::Rgba averageBlock(const Image::Rgba* src, size_t srcStride, size_t x0, size_t x1, size_t y0, size_t y1)
+  {
+    uint32 r = 0;
+    uint32 g = 0;
+    uint32 b = 0;
+    uint32 a = 0;
+
+    for (size_t y = y0; y < y1; ++y)
+    {
+      const Image::Rgba* row = src + y * srcStride;
+
+      for (size_t x = x0; x < x1; ++x)
+      {
+        r += row[x].r;
+        g += row[x].g;
+        b += row[x].b;
+        a += row[x].a;
+      }
+    }
+
+    const uint32 n = static_cast<uint32>((x1 - x0) * (y1 - y0));
+
+    Image::Rgba result;
+    result.r = static_cast<uint8>((r + n / 2) / n);
+    result.g = static_cast<uint8>((g + n / 2) / n);
+    result.b = static_cast<uint8>((b + n / 2) / n);
+    result.a = static_cast<uint8>((a + n / 2) / n);
+    return result;
+  }
+
+  /**
+   * Average 2x2 blocks of two source rows into 'count' destination pixels.
+   */
+  void downsampleRow(const Image::Rgba* row0, const Image::Rgba* row1, Image::Rgba* dst, size_t count)
+  {
+    size_t x = 0;
+
+#if defined(TEETIME_HAS_SSE2)
+    const __m128i two = _mm_set1_epi16(2);
+    const __m128i zero = _mm_setzero_si128();
+
+    //8 source pixels per row -> 4 destination pixels
+    for (; x + 4 <= count; x += 4)
+    {
+      const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x));
+      const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x + 4));
+      const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x));
+      const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x + 4));
+
+      //vertical sums, 16 bit per channel: [p0 p1], [p2 p3], [p4 p5], [p6 p7]
+      const __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+      const __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+      const __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+      const __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+      //horizontal sums of neighboring pixels: [p0+p1 p2+p3], [p4+p5 p6+p7]
+      const __m128i h0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+      const __m128i h1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+
+      const __m128i r0 = _mm_srli_epi16(_mm_add_epi16(h0, two), 2);
+      const __m128i r1 = _mm_srli_epi16(_mm_add_epi16(h1, two), 2);
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(r0, r1));
+    }
+#elif defined(TEETIME_HAS_NEON)
+    //8 source pixels per row -> 4 destination pixels
+    for (; x + 4 <= count; x += 4)
+    {
+      //deinterleave even and odd pixels
+      const uint32x4x2_t a = vld2q_u32(reinterpret_cast<const uint32_t*>(row0 + 2 * x));
+      const uint32x4x2_t b = vld2q_u32(reinterpret_cast<const uint32_t*>(row1 + 2 * x));
+
+      const uint8x16_t a0 = vreinterpretq_u8_u32(a.val[0]);
+      const uint8x16_t a1 = vreinterpretq_u8_u32(a.val[1]);
+      const uint8x16_t b0 = vreinterpretq_u8_u32(b.val[0]);
+      const uint8x16_t b1 = vreinterpretq_u8_u32(b.val[1]);
+
+      const uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(a0), vget_low_u8(a1)), vaddl_u8(vget_low_u8(b0), vget_low_u8(b1)));
+      const uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(a0), vget_high_u8(a1)), vaddl_u8(vget_high_u8(b0), vget_high_u8(b1)));
+
+      //rounding shift: (sum + 2) >> 2
+      vst1q_u8(reinterpret_cast<uint8_t*>(dst + x), vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+    }
+#endif
+
+    for (; x < count; ++x)
+    {
+      const Image::Rgba* p0 = row0 + 2 * x;
+      const Image::Rgba* p1 = row1 + 2 * x;
+
+      dst[x].r = static_cast<uint8>((p0[0].r + p0[1].r + p1[0].r + p1[1].r + 2) >> 2);
+      dst[x].g = static_cast<uint8>((p0[0].g + p0[1].g + p1[0].g + p1[1].g + 2) >> 2);
+      dst[x].b = static_cast<uint8>((p0[0].b + p0[1].b + p1[0].b + p1[1].b + 2) >> 2);
+      dst[x].a = static_cast<uint8>((p0[0].a + p0[1].a + p1[0].a + p1[1].a + 2) >> 2);
+    }
+  }
+
+  /**
+   * Average of source columns [x0, x1) and rows [y0, y1) for images with C channels.
+   */
+  template<unsigned C>
+  void averageBlock(const uint8* src, size_t srcStride, size_t x0, size_t x1, size_t y0, size_t y1, uint8* dst)
+  {
+    uint32 sums[C] = {};
+
+    for (size_t y = y0; y < y1; ++y)
+    {
+      const uint8* row = src + y * srcStride * C;
+
+      for (size_t x = x0; x < x1; ++x)
+      {
+        for (unsigned c = 0; c < C; ++c)
+        {
+          sums[c] += row[x * C + c];
+        }
+      }
+    }
+
+    const uint32 n = static_cast<uint32>((x1 - x0) * (y1 - y0));
+
+    for (unsigned c = 0; c < C; ++c)
+    {
+      dst[c] = static_cast<uint8>((sums[c] + n / 2) / n);
+    }
+  }
+
+  /**
+   * Average 2x2 blocks of two source rows into 'count' destination pixels, C channels per pixel.
+   */
+  template<unsigned C>
+  void downsampleRow(const uint8* row0, const uint8* row1, uint8* dst, size_t count)
+  {
+    size_t x = 0;
+
+#if defined(TEETIME_HAS_SSE2)
+    if (C == 1 || C == 2)
+    {
+      const __m128i two = _mm_set1_epi32(2);
+      const __m128i twos = _mm_set1_epi16(2);
+      const __m128i ones = _mm_set1_epi16(1);
+      const __m128i zero = _mm_setzero_si128();
+
+      //32 source bytes per row -> 16 destination bytes
+      for (; (x + 16 / C) <= count; x += 16 / C)
+      {
+        const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x * C));
+        const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x * C + 16));
+        const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x * C));
+        const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x * C + 16));
+
+        //vertical sums, 16 bit per channel
+        __m128i s[4] = {
+          _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero)),
+          _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero)),
+          _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero)),
+          _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero))
+        };
+
+        __m128i lo;
+        __m128i hi;
+
+        if (C == 1)
+        {
+          //neighboring pixels are neighboring 16 bit lanes, madd sums them into 32 bit lanes
+          __m128i r[4];
+          for (int i = 0; i < 4; ++i)
+          {
+            r[i] = _mm_srli_epi32(_mm_add_epi32(_mm_madd_epi16(s[i], ones), two), 2);
+          }
+
+          lo = _mm_packs_epi32(r[0], r[1]);
+          hi = _mm_packs_epi32(r[2], r[3]);
+        }
+        else
+        {
+          //neighboring pixels are neighboring 32 bit lanes: add the odd pixel to the even one, then gather the even ones
+          __m128i r[4];
+          for (int i = 0; i < 4; ++i)
+          {
+            const __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(s[i], _mm_srli_epi64(s[i], 32)), twos), 2);
+            r[i] = _mm_shuffle_epi32(sum, _MM_SHUFFLE(3, 1, 2, 0));
+          }
+
+          lo = _mm_unpacklo_epi64(r[0], r[1]);
+          hi = _mm_unpacklo_epi64(r[2], r[3]);
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * C), _mm_packus_epi16(lo, hi));
+      }
+    }
+#elif defined(TEETIME_HAS_NEON)
+    if (C == 1)
+    {
+      //32 source pixels per row -> 16 destination pixels, deinterleave even and odd pixels
+      for (; x + 16 <= count; x += 16)
+      {
+        const uint8x16x2_t a = vld2q_u8(row0 + 2 * x);
+        const uint8x16x2_t b = vld2q_u8(row1 + 2 * x);
+
+        const uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(a.val[0]), vget_low_u8(a.val[1])), vaddl_u8(vget_low_u8(b.val[0]), vget_low_u8(b.val[1])));
+        const uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(a.val[0]), vget_high_u8(a.val[1])), vaddl_u8(vget_high_u8(b.val[0]), vget_high_u8(b.val[1])));
+
+        vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+      }
+    }
+    else if (C == 2)
+    {
+      //16 source pixels per row -> 8 destination pixels
+      for (; x + 8 <= count; x += 8)
+      {
+        const uint16x8x2_t a = vld2q_u16(reinterpret_cast<const uint16_t*>(row0 + 4 * x));
+        const uint16x8x2_t b = vld2q_u16(reinterpret_cast<const uint16_t*>(row1 + 4 * x));
+
+        const uint8x16_t a0 = vreinterpretq_u8_u16(a.val[0]);
+        const uint8x16_t a1 = vreinterpretq_u8_u16(a.val[1]);
+        const uint8x16_t b0 = vreinterpretq_u8_u16(b.val[0]);
+        const uint8x16_t b1 = vreinterpretq_u8_u16(b.val[1]);
+
+        const uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(a0), vget_low_u8(a1)), vaddl_u8(vget_low_u8(b0), vget_low_u8(b1)));
+        const uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(a0), vget_high_u8(a1)), vaddl_u8(vget_high_u8(b0), vget_high_u8(b1)));
+
+        vst1q_u8(dst + 2 * x, vcombine_u8(vrshrn_n_u16(lo, 2), vrshrn_n_u16(hi, 2)));
+      }
+    }
+#endif
+
+    for (; x < count; ++x)
+    {
+      const uint8* p0 = row0 + 2 * x * C;
+      const uint8* p1 = row1 + 2 * x * C;
+
+      for (unsigned c = 0; c < C; ++c)
+      {
+        dst[x * C + c] = static_cast<uint8>((p0[c] + p0[C + c] + p1[c] + p1[C + c] + 2) >> 2);
+      }
+    }
+  }
+
+  template<unsigned C>
+  void downsample2x2(const uint8* src, size_t srcWidth, size_t srcHeight, size_t srcStride, uint8* dst, size_t dstStride)
+  {
+    const size_t width = halfSize(srcWidth);
+    const size_t height = halfSize(srcHeight);
+
+    const size_t regularWidth = (srcWidth >= 2) ? srcWidth / 2 - (srcWidth & 1) : 0;
+    const size_t regularHeight = (srcHeight >= 2) ? srcHeight / 2 - (srcHeight & 1) : 0;
+
+    for (size_t y = 0; y < height; ++y)
+    {
+      const size_t y0 = 2 * y;
+      const size_t y1 = (y + 1 == height) ? srcHeight : y0 + 2;
+      uint8* row = dst + y * dstStride * C;
+
+      size_t x = 0;
+      if (y < regularHeight)
+      {
+        downsampleRow<C>(src + y0 * srcStride * C, src + (y0 + 1) * srcStride * C, row, regularWidth);
+        x = regularWidth;
+      }
+
+      for (; x < width; ++x)
+      {
+        const size_t x0 = 2 * x;
+        const size_t x1 = (x + 1 == width) ? srcWidth : x0 + 2;
+        averageBlock<C>(src, srcStride, x0, x1, y0, y1, row + x * C);
+      }
+    }
+  }
+}
+
+void teetime::downsample2x2(const Image::Rgba* src, size_t srcWidth, size_t srcHeight, size_t srcStride, Image::Rgba* dst, size_t dstStride)
+{
+  assert(src);
+  assert(dst);
+
+  const size_t width = halfSize(srcWidth);
+  const size_t height = halfSize(srcHeight);
+
+  //destination pixels, that are plain 2x2 blocks (everything but an odd last column/row, or 1 pixel wide/high sources)
+  const size_t regularWidth = (srcWidth >= 2) ? srcWidth / 2 - (srcWidth & 1) : 0;
+  const size_t regularHeight = (srcHeight >= 2) ? srcHeight / 2 - (srcHeight & 1) : 0;
+
+  for (size_t y = 0; y < height; ++y)
+  {
+    const size_t y0 = 2 * y;
+    const size_t y1 = (y + 1 == height) ? srcHeight : y0 + 2;
+    Image::Rgba* row = dst + y * dstStride;
+
+    size_t x = 0;
+    if (y < regularHeight)
+    {
+      downsampleRow(src + y0 * srcStride, src + (y0 + 1) * srcStride, row, regularWidth);
+      x = regularWidth;
+    }
+
+    for (; x < width; ++x)
+    {
+      const size_t x0 = 2 * x;
+      const size_t x1 = (x + 1 == width) ? srcWidth : x0 + 2;
+      row[x] = averageBlock(src, srcStride, x0, x1, y0, y1);
+    }
+  }
+}
+
+void teetime::downsample2x2(const uint8* src, size_t srcWidth, size_t srcHeight, size_t srcStride, uint8* dst, size_t dstStride, PixelFormat format)
+{
+  assert(src);
+  assert(dst);
+
+  switch (format)
+  {
+  case PixelFormat::Gray8:
+    ::downsample2x2<1>(src, srcWidth, srcHeight, srcStride, dst, dstStride);
+    break;
+  case PixelFormat::GrayAlpha8:
+    ::downsample2x2<2>(src, srcWidth, srcHeight, srcStride, dst, dstStride);
+    break;
+  case PixelFormat::Rgb8:
+    ::downsample2x2<3>(src, srcWidth, srcHeight, srcStride, dst, dstStride);
+    break;
+  default:
+    downsample2x2(reinterpret_cast<const Image::Rgba*>(src), srcWidth, srcHeight, srcStride, reinterpret_cast<Image::Rgba*>(dst), dstStride);
+    break;
+  }
+}
+
+unsigned teetime::countHalvingSteps(size_t srcWidth, size_t srcHeight, size_t width, size_t height)
+{
+  unsigned steps = 0;
+
+  while ((srcWidth != width || srcHeight != height) && (srcWidth > 1 || srcHeight > 1))
+  {
+    srcWidth = halfSize(srcWidth);
+    srcHeight = halfSize(srcHeight);
+    ++steps;
+  }
+
+  return (srcWidth == width && srcHeight == height) ? steps : 0;
+}
+
+void teetime::createMipChain(const Image& source, std::vector<Image>& levels, unsigned maxLevels)
+{
+  size_t width = source.getWidth();
+  size_t height = source.getHeight();
+  size_t numLevels = 0;
+
+  if (source.getPixels())
+  {
+    while ((width > 1 || height > 1) && (maxLevels == 0 || numLevels < maxLevels))
+    {
+      width = halfSize(width);
+      height = halfSize(height);
+      ++numLevels;
+    }
+  }
+
+  levels.resize(numLevels);
+  if (numLevels == 0)
+    return;
+
+  for (size_t k = 0; k < numLevels; ++k)
+  {
+    const Image& parent = (k == 0) ? source : levels[k - 1];
+    levels[k].setSize(halfSize(parent.getWidth()), halfSize(parent.getHeight()), source.getFormat());
+  }
+
+  //number of rows already computed per level
+  std::vector<size_t> rowsDone(numLevels, 0);
+
+  //last parent row (exclusive) needed for row 'y' of level 'k'
+  auto rowsNeeded = [&](size_t k, size_t y) {
+    const Image& parent = (k == 0) ? source : levels[k - 1];
+    return (y + 1 == levels[k].getHeight()) ? parent.getHeight() : 2 * y + 2;
+  };
+
+  auto computeRow = [&](size_t k) {
+    const Image& parent = (k == 0) ? source : levels[k - 1];
+    Image& level = levels[k];
+
+    const size_t y = rowsDone[k];
+    const size_t y0 = 2 * y;
+    const size_t y1 = rowsNeeded(k, y);
+
+    const unsigned channels = source.getChannels();
+    downsample2x2(parent.getPixels() + y0 * parent.getWidth() * channels, parent.getWidth(), y1 - y0, parent.getWidth(),
+                  level.getPixels() + y * level.getWidth() * channels, level.getWidth(), source.getFormat());
+
+    rowsDone[k] += 1;
+  };
+
+  while (rowsDone[0] < levels[0].getHeight())
+  {
+    computeRow(0);
+
+    for (size_t k = 1; k < numLevels; ++k)
+    {
+      while (rowsDone[k] < levels[k].getHeight() && rowsNeeded(k, rowsDone[k]) <= rowsDone[k - 1])
+      {
+        computeRow(k);
+      }
+    }
+  }
+}
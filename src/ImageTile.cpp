@@ -0,0 +1,119 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/ImageTile.h>
+#include <teetime/ImageKernels.h>
+#include <algorithm>
+
+using namespace teetime;
+
+namespace
+{
+  //source range [begin, end) of target range [x, x + size) of a halved dimension
+  void halfSizeSourceRange(size_t x, size_t size, size_t targetSize, size_t sourceSize, size_t& begin, size_t& end)
+  {
+    begin = (std::min)(2 * x, sourceSize);
+    end = (x + size == targetSize) ? sourceSize : 2 * (x + size);
+  }
+}
+
+std::vector<ImageTile> teetime::createImageTiles(shared_ptr<const Image> source, size_t tileSize, size_t halo, ImageTileTarget mode)
+{
+  assert(source);
+  assert(tileSize > 0);
+
+  std::vector<ImageTile> tiles;
+
+  const size_t sourceWidth = source->getWidth();
+  const size_t sourceHeight = source->getHeight();
+
+  if (sourceWidth == 0 || sourceHeight == 0)
+    return tiles;
+
+  const size_t width = (mode == ImageTileTarget::HalfSize) ? halfSize(sourceWidth) : sourceWidth;
+  const size_t height = (mode == ImageTileTarget::HalfSize) ? halfSize(sourceHeight) : sourceHeight;
+
+  auto target = std::make_shared<Image>();
+  target->setSize(width, height, source->getFormat());
+
+  const size_t tilesX = (width + tileSize - 1) / tileSize;
+  const size_t tilesY = (height + tileSize - 1) / tileSize;
+
+  tiles.reserve(tilesX * tilesY);
+
+  for (size_t ty = 0; ty < tilesY; ++ty)
+  {
+    for (size_t tx = 0; tx < tilesX; ++tx)
+    {
+      ImageTile tile;
+      tile.source = source;
+      tile.target = target;
+      tile.x = tx * tileSize;
+      tile.y = ty * tileSize;
+      tile.width = (std::min)(tileSize, width - tile.x);
+      tile.height = (std::min)(tileSize, height - tile.y);
+      tile.index = tiles.size();
+      tile.count = tilesX * tilesY;
+
+      size_t x0 = tile.x;
+      size_t x1 = tile.x + tile.width;
+      size_t y0 = tile.y;
+      size_t y1 = tile.y + tile.height;
+
+      if (mode == ImageTileTarget::HalfSize)
+      {
+        halfSizeSourceRange(tile.x, tile.width, width, sourceWidth, x0, x1);
+        halfSizeSourceRange(tile.y, tile.height, height, sourceHeight, y0, y1);
+      }
+
+      x0 = (x0 > halo) ? x0 - halo : 0;
+      y0 = (y0 > halo) ? y0 - halo : 0;
+      x1 = (std::min)(x1 + halo, sourceWidth);
+      y1 = (std::min)(y1 + halo, sourceHeight);
+
+      tile.sourceX = x0;
+      tile.sourceY = y0;
+      tile.sourceWidth = x1 - x0;
+      tile.sourceHeight = y1 - y0;
+
+      tiles.push_back(std::move(tile));
+    }
+  }
+
+  return tiles;
+}
+
+ImageTile teetime::downsampleTile(ImageTile tile)
+{
+  assert(tile.source);
+  assert(tile.target);
+
+  const Image& source = *tile.source;
+  Image& target = *tile.target;
+
+  //the exact source region of the target region (without halo)
+  size_t x0, x1, y0, y1;
+  halfSizeSourceRange(tile.x, tile.width, target.getWidth(), source.getWidth(), x0, x1);
+  halfSizeSourceRange(tile.y, tile.height, target.getHeight(), source.getHeight(), y0, y1);
+
+  assert(halfSize(x1 - x0) == tile.width);
+  assert(halfSize(y1 - y0) == tile.height);
+
+  const unsigned channels = source.getChannels();
+  downsample2x2(source.getPixels() + (y0 * source.getWidth() + x0) * channels, x1 - x0, y1 - y0, source.getWidth(),
+                target.getPixels() + (tile.y * target.getWidth() + tile.x) * channels, target.getWidth(), source.getFormat());
+
+  return tile;
+}
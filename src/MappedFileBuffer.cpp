@@ -0,0 +1,70 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/MappedFileBuffer.h>
+#include <teetime/platform.h>
+
+using namespace teetime;
+
+MappedFileBuffer::MappedFileBuffer()
+  : m_size(0)
+{
+}
+
+bool MappedFileBuffer::map(const char* path)
+{
+  assert(path);
+
+  reset();
+
+  const void* data = nullptr;
+  size_t size = 0;
+
+  if (!platform::mapFile(path, data, size))
+  {
+    return false;
+  }
+
+  m_data = shared_ptr<const uint8>(static_cast<const uint8*>(data), [size](const uint8* p) {
+    platform::unmapFile(p, size);
+  });
+  m_size = size;
+  this->path = path;
+
+  return true;
+}
+
+MappedFileBuffer MappedFileBuffer::slice(size_t offset, size_t size, const std::string& path) const
+{
+  assert(offset <= m_size && size <= m_size - offset);
+
+  MappedFileBuffer view;
+  view.path = path;
+
+  if (size > 0)
+  {
+    //aliasing constructor: view points into the mapping, but shares ownership of the whole mapping
+    view.m_data = shared_ptr<const uint8>(m_data, m_data.get() + offset);
+    view.m_size = size;
+  }
+
+  return view;
+}
+
+void MappedFileBuffer::reset()
+{
+  m_data.reset();
+  m_size = 0;
+}
@@ -0,0 +1,292 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/PixelPool.h>
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+
+using namespace teetime;
+
+namespace
+{
+  //blocks smaller than this are passed straight to malloc (no lock, no rounding)
+  const size_t SmallBlockSize = 4096;
+
+  //smallest size class is 2^MinOctave bytes, each octave is split into 4 size classes
+  const unsigned MinOctave = 12;
+  const unsigned ClassesPerOctave = 4;
+
+  //marks blocks not kept in any size class, those are never pooled
+  const uint32 Unpooled = 0xFFFFFFFF;
+
+  /**
+   * Header in front of each block (keeps malloc's 16 byte alignment).
+   */
+  struct BlockHeader
+  {
+    uint64 size;
+    uint32 sizeClass;
+    uint32 _padding;
+  };
+
+  static_assert(sizeof(BlockHeader) == 16, "block header must preserve alignment");
+
+  BlockHeader* header(const void* block)
+  {
+    return reinterpret_cast<BlockHeader*>(const_cast<uint8*>(static_cast<const uint8*>(block)) - sizeof(BlockHeader));
+  }
+
+  void* payload(BlockHeader* h)
+  {
+    return reinterpret_cast<uint8*>(h) + sizeof(BlockHeader);
+  }
+
+  //block size of a size class: 2^octave * (4 + n) / 4 with n in [0,3]
+  uint64 classSize(unsigned sizeClass)
+  {
+    return uint64(ClassesPerOctave + sizeClass % ClassesPerOctave) << (MinOctave + sizeClass / ClassesPerOctave - 2);
+  }
+
+  //smallest size class holding 'size' bytes, Unpooled if too small or too big for the pool
+  uint32 sizeClassOf(size_t size, unsigned numSizeClasses)
+  {
+    if (size < SmallBlockSize)
+      return Unpooled;
+
+    //2^octave <= size < 2^(octave+1)
+    unsigned octave = MinOctave;
+    while (octave < 63 && (uint64(1) << (octave + 1)) <= size)
+    {
+      ++octave;
+    }
+
+    const uint64 step = uint64(1) << (octave - 2);
+    const uint64 n = (uint64(size) - (uint64(1) << octave) + step - 1) / step;
+    const uint64 sizeClass = (octave - MinOctave) * ClassesPerOctave + n;
+
+    return sizeClass < numSizeClasses ? static_cast<uint32>(sizeClass) : Unpooled;
+  }
+
+  void* allocateUnpooled(size_t size)
+  {
+    auto h = static_cast<BlockHeader*>(::malloc(sizeof(BlockHeader) + size));
+    if (!h)
+      return nullptr;
+
+    h->size = size;
+    h->sizeClass = Unpooled;
+    return payload(h);
+  }
+}
+
+PixelPool::PixelPool(size_t capacity)
+  : m_capacity(capacity)
+  , m_pooledBytes(0)
+  , m_usedBytes(0)
+  , m_peakUsedBytes(0)
+{
+}
+
+PixelPool::~PixelPool()
+{
+  clear();
+}
+
+PixelPool& PixelPool::instance()
+{
+  //never destroyed, so images in static storage can still release their pixels at exit
+  static PixelPool* pool = new PixelPool();
+  return *pool;
+}
+
+void* PixelPool::allocate(size_t size)
+{
+  const uint32 sizeClass = sizeClassOf(size, NumSizeClasses);
+  if (sizeClass == Unpooled)
+  {
+    void* block = allocateUnpooled(size);
+    if (block)
+    {
+      addUsedBytes(size);
+    }
+    return block;
+  }
+
+  const size_t classBytes = static_cast<size_t>(classSize(sizeClass));
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto& blocks = m_blocks[sizeClass];
+    if (!blocks.empty())
+    {
+      void* block = blocks.back();
+      blocks.pop_back();
+      m_pooledBytes -= classBytes;
+      addUsedBytes(classBytes);
+      return block;
+    }
+  }
+
+  auto h = static_cast<BlockHeader*>(::malloc(sizeof(BlockHeader) + classBytes));
+  if (!h)
+    return nullptr;
+
+  h->size = classBytes;
+  h->sizeClass = sizeClass;
+  addUsedBytes(classBytes);
+  return payload(h);
+}
+
+void* PixelPool::reallocate(void* block, size_t size)
+{
+  if (!block)
+    return allocate(size);
+
+  BlockHeader* h = header(block);
+
+  //unpooled blocks stay unpooled: let malloc grow them in place if possible
+  if (h->sizeClass == Unpooled && sizeClassOf(size, NumSizeClasses) == Unpooled)
+  {
+    const size_t oldSize = static_cast<size_t>(h->size);
+    auto h2 = static_cast<BlockHeader*>(::realloc(h, sizeof(BlockHeader) + size));
+    if (!h2)
+      return nullptr;
+
+    m_usedBytes -= oldSize;
+    addUsedBytes(size);
+    h2->size = size;
+    return payload(h2);
+  }
+
+  const size_t oldSize = static_cast<size_t>(h->size);
+  if (size <= oldSize && size > oldSize / 2)
+    return block;
+
+  void* newBlock = allocate(size);
+  if (!newBlock)
+    return nullptr;
+
+  memcpy(newBlock, block, (std::min)(size, oldSize));
+  release(block);
+
+  return newBlock;
+}
+
+void PixelPool::release(void* block)
+{
+  if (!block)
+    return;
+
+  BlockHeader* h = header(block);
+  m_usedBytes -= static_cast<size_t>(h->size);
+
+  if (h->sizeClass != Unpooled)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_pooledBytes + h->size <= m_capacity)
+    {
+      m_blocks[h->sizeClass].push_back(block);
+      m_pooledBytes += static_cast<size_t>(h->size);
+      return;
+    }
+  }
+
+  ::free(h);
+}
+
+size_t PixelPool::blockSize(const void* block)
+{
+  return block ? static_cast<size_t>(header(block)->size) : 0;
+}
+
+void PixelPool::setCapacity(size_t capacity)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_capacity = capacity;
+  trim();
+}
+
+size_t PixelPool::capacity() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_capacity;
+}
+
+size_t PixelPool::pooledBytes() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_pooledBytes;
+}
+
+size_t PixelPool::usedBytes() const
+{
+  return m_usedBytes.load();
+}
+
+size_t PixelPool::peakUsedBytes() const
+{
+  return m_peakUsedBytes.load();
+}
+
+void PixelPool::resetPeakUsedBytes()
+{
+  m_peakUsedBytes = m_usedBytes.load();
+}
+
+void PixelPool::addUsedBytes(size_t bytes)
+{
+  const size_t used = m_usedBytes.fetch_add(bytes) + bytes;
+
+  size_t peak = m_peakUsedBytes.load();
+  while (used > peak && !m_peakUsedBytes.compare_exchange_weak(peak, used))
+  {
+  }
+}
+
+void PixelPool::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  for (auto& blocks : m_blocks)
+  {
+    for (void* block : blocks)
+    {
+      ::free(header(block));
+    }
+
+    blocks.clear();
+  }
+
+  m_pooledBytes = 0;
+}
+
+void PixelPool::trim()
+{
+  //free biggest blocks first
+  for (unsigned i = NumSizeClasses; i-- > 0 && m_pooledBytes > m_capacity; )
+  {
+    auto& blocks = m_blocks[i];
+
+    while (!blocks.empty() && m_pooledBytes > m_capacity)
+    {
+      ::free(header(blocks.back()));
+      blocks.pop_back();
+      m_pooledBytes -= static_cast<size_t>(classSize(i));
+    }
+  }
+}
@@ -0,0 +1,163 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/PlanarImage.h>
+
+using namespace teetime;
+
+namespace
+{
+  //channel count is a template parameter, so the strided loops get vectorized
+  template<unsigned C>
+  void deinterleavePixels(const uint8* src, size_t count, float* const* planes)
+  {
+    const float scale = 1.0f / 255.0f;
+
+    for (unsigned c = 0; c < C; ++c)
+    {
+      float* plane = planes[c];
+      for (size_t i = 0; i < count; ++i)
+      {
+        plane[i] = src[i * C + c] * scale;
+      }
+    }
+  }
+
+  template<unsigned C>
+  void interleavePixels(const float* const* planes, size_t count, uint8* dst)
+  {
+    for (unsigned c = 0; c < C; ++c)
+    {
+      const float* plane = planes[c];
+      for (size_t i = 0; i < count; ++i)
+      {
+        const float v = plane[i] * 255.0f + 0.5f;
+        dst[i * C + c] = static_cast<uint8>(v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v));
+      }
+    }
+  }
+
+  void deinterleaveRow(PixelFormat format, const uint8* src, size_t count, float* const* planes)
+  {
+    switch (format)
+    {
+    case PixelFormat::Gray8: deinterleavePixels<1>(src, count, planes); break;
+    case PixelFormat::GrayAlpha8: deinterleavePixels<2>(src, count, planes); break;
+    case PixelFormat::Rgb8: deinterleavePixels<3>(src, count, planes); break;
+    default: deinterleavePixels<4>(src, count, planes); break;
+    }
+  }
+
+  void interleaveRow(PixelFormat format, const float* const* planes, size_t count, uint8* dst)
+  {
+    switch (format)
+    {
+    case PixelFormat::Gray8: interleavePixels<1>(planes, count, dst); break;
+    case PixelFormat::GrayAlpha8: interleavePixels<2>(planes, count, dst); break;
+    case PixelFormat::Rgb8: interleavePixels<3>(planes, count, dst); break;
+    default: interleavePixels<4>(planes, count, dst); break;
+    }
+  }
+}
+
+PlanarImage::PlanarImage()
+  : m_width(0)
+  , m_height(0)
+  , m_format(PixelFormat::Rgba8)
+{
+}
+
+void PlanarImage::setSize(size_t width, size_t height, PixelFormat format)
+{
+  m_width = width;
+  m_height = height;
+  m_format = format;
+  m_data.resize(width * height * numChannels(format));
+}
+
+void PlanarImage::deinterleave(const Image& image)
+{
+  setSize(image.getWidth(), image.getHeight(), image.getFormat());
+
+  float* planes[4] = {};
+  for (unsigned c = 0; c < getNumPlanes(); ++c)
+  {
+    planes[c] = getPlane(c);
+  }
+
+  const size_t count = m_width * m_height;
+  if (count == 0)
+    return;
+
+  deinterleaveRow(m_format, image.getPixels(), count, planes);
+}
+
+void PlanarImage::deinterleave(const Image& image, size_t x, size_t y, size_t width, size_t height)
+{
+  assert(x + width <= image.getWidth());
+  assert(y + height <= image.getHeight());
+
+  setSize(width, height, image.getFormat());
+
+  const unsigned channels = image.getChannels();
+
+  for (size_t row = 0; row < height; ++row)
+  {
+    float* planes[4] = {};
+    for (unsigned c = 0; c < getNumPlanes(); ++c)
+    {
+      planes[c] = getPlane(c) + row * width;
+    }
+
+    deinterleaveRow(m_format, image.getPixels() + ((y + row) * image.getWidth() + x) * channels, width, planes);
+  }
+}
+
+void PlanarImage::interleave(Image& image) const
+{
+  image.setSize(m_width, m_height, m_format);
+
+  const float* planes[4] = {};
+  for (unsigned c = 0; c < getNumPlanes(); ++c)
+  {
+    planes[c] = getPlane(c);
+  }
+
+  const size_t count = m_width * m_height;
+  if (count == 0)
+    return;
+
+  interleaveRow(m_format, planes, count, image.getPixels());
+}
+
+void PlanarImage::interleave(Image& image, size_t x, size_t y, size_t width, size_t height, size_t targetX, size_t targetY) const
+{
+  assert(image.getFormat() == m_format);
+  assert(x + width <= m_width && y + height <= m_height);
+  assert(targetX + width <= image.getWidth() && targetY + height <= image.getHeight());
+
+  const unsigned channels = image.getChannels();
+
+  for (size_t row = 0; row < height; ++row)
+  {
+    const float* planes[4] = {};
+    for (unsigned c = 0; c < getNumPlanes(); ++c)
+    {
+      planes[c] = getPlane(c) + (y + row) * m_width + x;
+    }
+
+    interleaveRow(m_format, planes, width, image.getPixels() + ((targetY + row) * image.getWidth() + targetX) * channels);
+  }
+}
@@ -0,0 +1,611 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/PngEncoder.h>
+#include <teetime/Image.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+using namespace teetime;
+
+namespace
+{
+  const size_t WindowSize = 32768;
+  const size_t DefaultBandBytes = 1024 * 1024;
+
+  /**
+   * Run 'task' for indices 0 to count-1 on up to 'numThreads' threads.
+   */
+  void parallelFor(size_t count, unsigned numThreads, const std::function<void(size_t)>& task)
+  {
+    std::atomic<size_t> next(0);
+
+    auto worker = [&]() {
+      for (size_t i = next++; i < count; i = next++)
+      {
+        task(i);
+      }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < numThreads && i < count; ++i)
+    {
+      threads.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& t : threads)
+    {
+      t.join();
+    }
+  }
+
+  uint32 crc32(uint32 crc, const uint8* data, size_t size)
+  {
+    static uint32 table[256];
+    static bool initialized = [&]() {
+      for (uint32 n = 0; n < 256; ++n)
+      {
+        uint32 c = n;
+        for (int k = 0; k < 8; ++k)
+        {
+          c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+      }
+      return true;
+    }();
+    (void)initialized;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+    {
+      crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+  }
+
+  const uint32 AdlerBase = 65521;
+
+  uint32 adler32(const uint8* data, size_t size)
+  {
+    uint32 s1 = 1;
+    uint32 s2 = 0;
+
+    while (size > 0)
+    {
+      //largest block that can't overflow s2
+      const size_t block = (std::min)(size, size_t(5552));
+      for (size_t i = 0; i < block; ++i)
+      {
+        s1 += data[i];
+        s2 += s1;
+      }
+
+      s1 %= AdlerBase;
+      s2 %= AdlerBase;
+      data += block;
+      size -= block;
+    }
+
+    return (s2 << 16) | s1;
+  }
+
+  //checksum of the concatenation of two blocks, 'size2' is the size of the second block (as in zlib)
+  uint32 adler32Combine(uint32 adler1, uint32 adler2, uint64 size2)
+  {
+    const uint32 rem = static_cast<uint32>(size2 % AdlerBase);
+    uint32 sum1 = adler1 & 0xFFFF;
+    uint32 sum2 = static_cast<uint32>((uint64(rem) * sum1) % AdlerBase);
+
+    sum1 += (adler2 & 0xFFFF) + AdlerBase - 1;
+    sum2 += ((adler1 >> 16) & 0xFFFF) + ((adler2 >> 16) & 0xFFFF) + AdlerBase - rem;
+
+    if (sum1 >= AdlerBase) sum1 -= AdlerBase;
+    if (sum1 >= AdlerBase) sum1 -= AdlerBase;
+    if (sum2 >= (AdlerBase << 1)) sum2 -= (AdlerBase << 1);
+    if (sum2 >= AdlerBase) sum2 -= AdlerBase;
+
+    return sum1 | (sum2 << 16);
+  }
+
+  uint8 paeth(int a, int b, int c)
+  {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+
+    if (pa <= pb && pa <= pc)
+      return static_cast<uint8>(a);
+
+    if (pb <= pc)
+      return static_cast<uint8>(b);
+
+    return static_cast<uint8>(c);
+  }
+
+  /**
+   * Apply filter 'type' (0-4) to a row with 'bpp' bytes per pixel.
+   * 'prior' is the previous row (all zero for the first row).
+   */
+  void filterRow(int type, const uint8* row, const uint8* prior, uint8* out, size_t rowBytes, size_t bpp)
+  {
+    for (size_t i = 0; i < rowBytes; ++i)
+    {
+      const int a = (i >= bpp) ? row[i - bpp] : 0;
+      const int b = prior[i];
+      const int c = (i >= bpp) ? prior[i - bpp] : 0;
+
+      switch (type)
+      {
+      case 0: out[i] = row[i]; break;
+      case 1: out[i] = static_cast<uint8>(row[i] - a); break;
+      case 2: out[i] = static_cast<uint8>(row[i] - b); break;
+      case 3: out[i] = static_cast<uint8>(row[i] - ((a + b) >> 1)); break;
+      default: out[i] = static_cast<uint8>(row[i] - paeth(a, b, c)); break;
+      }
+    }
+  }
+
+  //sum of absolute (signed) values, estimates how well a filtered row compresses
+  uint32 filterCost(int type, const uint8* row, const uint8* prior, uint8* scratch, size_t rowBytes, size_t bpp)
+  {
+    filterRow(type, row, prior, scratch, rowBytes, bpp);
+
+    uint32 cost = 0;
+    for (size_t i = 0; i < rowBytes; ++i)
+    {
+      cost += static_cast<uint32>(std::abs(static_cast<int>(static_cast<signed char>(scratch[i]))));
+    }
+    return cost;
+  }
+
+  /**
+   * Filter a row into 'out' (first byte is the filter type).
+   */
+  void filterRow(PngFilter filter, const uint8* row, const uint8* prior, uint8* out, std::vector<uint8>& scratch, size_t bpp)
+  {
+    const size_t rowBytes = scratch.size();
+    int type = 0;
+
+    if (filter == PngFilter::Adaptive || filter == PngFilter::AdaptiveFast)
+    {
+      uint32 best = 0xFFFFFFFF;
+
+      for (int t = 0; t < 5; ++t)
+      {
+        uint32 cost = 0;
+
+        if (filter == PngFilter::AdaptiveFast)
+        {
+          //every 8th pixel, all channels
+          for (size_t i = 0; i < rowBytes; i += 8 * bpp)
+          {
+            const size_t n = (std::min)(bpp, rowBytes - i);
+            for (size_t k = 0; k < n; ++k)
+            {
+              const size_t j = i + k;
+              const int a = (j >= bpp) ? row[j - bpp] : 0;
+              const int b = prior[j];
+              const int c = (j >= bpp) ? prior[j - bpp] : 0;
+              int v = row[j];
+
+              switch (t)
+              {
+              case 1: v -= a; break;
+              case 2: v -= b; break;
+              case 3: v -= (a + b) >> 1; break;
+              case 4: v -= paeth(a, b, c); break;
+              default: break;
+              }
+
+              cost += static_cast<uint32>(std::abs(static_cast<int>(static_cast<signed char>(static_cast<uint8>(v)))));
+            }
+          }
+        }
+        else
+        {
+          cost = filterCost(t, row, prior, scratch.data(), rowBytes, bpp);
+        }
+
+        if (cost < best)
+        {
+          best = cost;
+          type = t;
+        }
+      }
+    }
+    else
+    {
+      type = static_cast<int>(filter);
+    }
+
+    out[0] = static_cast<uint8>(type);
+    filterRow(type, row, prior, out + 1, rowBytes, bpp);
+  }
+
+  /**
+   * Writes deflate bits (LSB first).
+   */
+  class BitWriter
+  {
+  public:
+    explicit BitWriter(std::vector<uint8>& out)
+      : m_out(out)
+      , m_bits(0)
+      , m_count(0)
+    {}
+
+    void add(uint32 code, int numBits)
+    {
+      m_bits |= code << m_count;
+      m_count += numBits;
+
+      while (m_count >= 8)
+      {
+        m_out.push_back(static_cast<uint8>(m_bits));
+        m_bits >>= 8;
+        m_count -= 8;
+      }
+    }
+
+    //huffman codes are stored most significant bit first
+    void addReversed(uint32 code, int numBits)
+    {
+      uint32 reversed = 0;
+      for (int i = 0; i < numBits; ++i)
+      {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+      }
+      add(reversed, numBits);
+    }
+
+    //fixed huffman code of a literal/length symbol
+    void addSymbol(uint32 n)
+    {
+      if (n <= 143)
+        addReversed(0x30 + n, 8);
+      else if (n <= 255)
+        addReversed(0x190 + n - 144, 9);
+      else if (n <= 279)
+        addReversed(n - 256, 7);
+      else
+        addReversed(0xC0 + n - 280, 8);
+    }
+
+    void alignToByte()
+    {
+      if (m_count > 0)
+      {
+        add(0, 8 - m_count);
+      }
+    }
+
+  private:
+    std::vector<uint8>& m_out;
+    uint32              m_bits;
+    int                 m_count;
+  };
+
+  /**
+   * Deflate data[dictionarySize, size) as non-final block(s), ending with a sync flush (byte aligned).
+   * Matches may reference the dictionary (data[0, dictionarySize)).
+   */
+  void deflateBand(const uint8* data, size_t dictionarySize, size_t size, int level, std::vector<uint8>& out)
+  {
+    if (level <= 0)
+    {
+      //stored blocks
+      for (size_t i = dictionarySize; i < size; )
+      {
+        const size_t n = (std::min)(size - i, size_t(65535));
+        out.push_back(0x00); //BFINAL = 0, BTYPE = 00
+        out.push_back(static_cast<uint8>(n));
+        out.push_back(static_cast<uint8>(n >> 8));
+        out.push_back(static_cast<uint8>(~n));
+        out.push_back(static_cast<uint8>(~n >> 8));
+        out.insert(out.end(), data + i, data + i + n);
+        i += n;
+      }
+      return;
+    }
+
+    static const uint32 lengthBase[] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258,259 };
+    static const uint8  lengthExtra[] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+    static const uint32 distBase[] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577,32769 };
+    static const uint8  distExtra[] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+    const size_t HashBits = 15;
+    const size_t MaxMatch = 258;
+    const int maxChain = 1 << (std::min)(level, 9);
+
+    std::vector<int32> head(size_t(1) << HashBits, -1);
+    std::vector<int32> prev(size, -1);
+
+    auto hash = [&](size_t i) {
+      const uint32 v = data[i] | (data[i + 1] << 8) | (data[i + 2] << 16);
+      return (v * 2654435761u) >> (32 - HashBits);
+    };
+
+    auto insert = [&](size_t i) {
+      if (i + 2 < size)
+      {
+        const uint32 h = hash(i);
+        prev[i] = head[h];
+        head[h] = static_cast<int32>(i);
+      }
+    };
+
+    for (size_t i = 0; i < dictionarySize; ++i)
+    {
+      insert(i);
+    }
+
+    BitWriter bits(out);
+    bits.add(0, 1); //BFINAL = 0
+    bits.add(1, 2); //BTYPE = 01, fixed huffman
+
+    size_t i = dictionarySize;
+    while (i < size)
+    {
+      size_t bestLength = 0;
+      size_t bestDistance = 0;
+
+      if (i + 2 < size)
+      {
+        const size_t limit = (std::min)(MaxMatch, size - i);
+        int chain = maxChain;
+
+        for (int32 candidate = head[hash(i)]; candidate >= 0 && chain-- > 0; candidate = prev[candidate])
+        {
+          const size_t distance = i - static_cast<size_t>(candidate);
+          if (distance > WindowSize)
+            break;
+
+          const uint8* a = data + candidate;
+          const uint8* b = data + i;
+          if (a[bestLength] != b[bestLength])
+            continue;
+
+          size_t length = 0;
+          while (length < limit && a[length] == b[length])
+          {
+            ++length;
+          }
+
+          if (length > bestLength)
+          {
+            bestLength = length;
+            bestDistance = distance;
+
+            if (length == limit)
+              break;
+          }
+        }
+      }
+
+      if (bestLength >= 3)
+      {
+        size_t j = 0;
+        while (bestLength > size_t(lengthBase[j + 1] - 1))
+        {
+          ++j;
+        }
+        bits.addSymbol(static_cast<uint32>(257 + j));
+        if (lengthExtra[j])
+        {
+          bits.add(static_cast<uint32>(bestLength - lengthBase[j]), lengthExtra[j]);
+        }
+
+        j = 0;
+        while (bestDistance > size_t(distBase[j + 1] - 1))
+        {
+          ++j;
+        }
+        bits.addReversed(static_cast<uint32>(j), 5);
+        if (distExtra[j])
+        {
+          bits.add(static_cast<uint32>(bestDistance - distBase[j]), distExtra[j]);
+        }
+
+        for (size_t k = 0; k < bestLength; ++k)
+        {
+          insert(i + k);
+        }
+        i += bestLength;
+      }
+      else
+      {
+        bits.addSymbol(data[i]);
+        insert(i);
+        ++i;
+      }
+    }
+
+    bits.addSymbol(256); //end of block
+
+    //sync flush: empty stored block, so the next band starts at a byte boundary
+    bits.add(0, 3);
+    bits.alignToByte();
+    out.push_back(0x00);
+    out.push_back(0x00);
+    out.push_back(0xFF);
+    out.push_back(0xFF);
+  }
+
+  uint8 pngColorType(PixelFormat format)
+  {
+    switch (format)
+    {
+    case PixelFormat::Gray8: return 0;
+    case PixelFormat::GrayAlpha8: return 4;
+    case PixelFormat::Rgb8: return 2;
+    default: return 6;
+    }
+  }
+
+  void append32(std::vector<uint8>& out, uint32 v)
+  {
+    out.push_back(static_cast<uint8>(v >> 24));
+    out.push_back(static_cast<uint8>(v >> 16));
+    out.push_back(static_cast<uint8>(v >> 8));
+    out.push_back(static_cast<uint8>(v));
+  }
+
+  /**
+   * Append a chunk, 'data' is the chunk type (4 bytes) followed by the content.
+   */
+  void appendChunk(std::vector<uint8>& out, const uint8* data, size_t size)
+  {
+    assert(size >= 4);
+    append32(out, static_cast<uint32>(size - 4));
+    out.insert(out.end(), data, data + size);
+    append32(out, crc32(0, data, size));
+  }
+
+  void appendChunk(std::vector<uint8>& out, const std::vector<uint8>& data)
+  {
+    appendChunk(out, data.data(), data.size());
+  }
+}
+
+bool teetime::encodePng(const Image& image, const PngEncodeOptions& options, std::vector<uint8>& png)
+{
+  png.clear();
+
+  const size_t width = image.getWidth();
+  const size_t height = image.getHeight();
+
+  if (width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF)
+    return false;
+
+  const size_t bpp = image.getChannels();
+  const size_t rowBytes = width * bpp;
+  const size_t filteredRowBytes = rowBytes + 1;
+  const uint8* pixels = image.getPixels();
+
+  const size_t bandRows = options.bandRows > 0 ? options.bandRows : (std::max)(size_t(1), DefaultBandBytes / filteredRowBytes);
+  const size_t numBands = (height + bandRows - 1) / bandRows;
+
+  unsigned numThreads = options.numThreads > 0 ? options.numThreads : std::thread::hardware_concurrency();
+  numThreads = (std::max)(numThreads, 1u);
+
+  //1st pass: filter all bands
+  std::vector<uint8> filtered(filteredRowBytes * height);
+
+  parallelFor(numBands, numThreads, [&](size_t band) {
+    std::vector<uint8> scratch(rowBytes);
+    std::vector<uint8> zeros;
+
+    const size_t end = (std::min)(height, (band + 1) * bandRows);
+    for (size_t y = band * bandRows; y < end; ++y)
+    {
+      const uint8* prior = nullptr;
+      if (y > 0)
+      {
+        prior = pixels + (y - 1) * rowBytes;
+      }
+      else
+      {
+        zeros.assign(rowBytes, 0);
+        prior = zeros.data();
+      }
+
+      filterRow(options.filter, pixels + y * rowBytes, prior, filtered.data() + y * filteredRowBytes, scratch, bpp);
+    }
+  });
+
+  //2nd pass: compress all bands, each into its own IDAT chunk
+  std::vector<std::vector<uint8>> chunks(numBands);
+  std::vector<uint32> adlers(numBands);
+
+  parallelFor(numBands, numThreads, [&](size_t band) {
+    const size_t begin = band * bandRows * filteredRowBytes;
+    const size_t end = (std::min)(height, (band + 1) * bandRows) * filteredRowBytes;
+    const size_t dictionary = (std::min)(begin, WindowSize);
+
+    std::vector<uint8>& chunk = chunks[band];
+    chunk.reserve((end - begin) / 2 + 64);
+    chunk.push_back('I');
+    chunk.push_back('D');
+    chunk.push_back('A');
+    chunk.push_back('T');
+
+    if (band == 0)
+    {
+      //zlib header: deflate, 32K window, no dictionary
+      chunk.push_back(0x78);
+      chunk.push_back(0x5E);
+    }
+
+    deflateBand(filtered.data() + begin - dictionary, dictionary, end - begin + dictionary, options.compressionLevel, chunk);
+    adlers[band] = adler32(filtered.data() + begin, end - begin);
+  });
+
+  uint32 adler = adlers[0];
+  for (size_t band = 1; band < numBands; ++band)
+  {
+    const size_t begin = band * bandRows * filteredRowBytes;
+    const size_t end = (std::min)(height, (band + 1) * bandRows) * filteredRowBytes;
+    adler = adler32Combine(adler, adlers[band], end - begin);
+  }
+
+  static const uint8 signature[] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+  png.insert(png.end(), signature, signature + sizeof(signature));
+
+  std::vector<uint8> header = { 'I', 'H', 'D', 'R' };
+  append32(header, static_cast<uint32>(width));
+  append32(header, static_cast<uint32>(height));
+  header.push_back(8); //bit depth
+  header.push_back(pngColorType(image.getFormat()));
+  header.push_back(0); //compression
+  header.push_back(0); //filter method
+  header.push_back(0); //no interlace
+  appendChunk(png, header);
+
+  for (const auto& chunk : chunks)
+  {
+    appendChunk(png, chunk);
+  }
+
+  //empty final block (fixed huffman, only end-of-block) and the checksum of the whole stream
+  std::vector<uint8> trailer = { 'I', 'D', 'A', 'T', 0x03, 0x00 };
+  append32(trailer, adler);
+  appendChunk(png, trailer);
+
+  std::vector<uint8> end = { 'I', 'E', 'N', 'D' };
+  appendChunk(png, end);
+
+  return true;
+}
+
+bool teetime::writePngFile(const Image& image, const std::string& filename, const PngEncodeOptions& options)
+{
+  std::vector<uint8> png;
+  if (!encodePng(image, options, png))
+    return false;
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(png.data()), png.size());
+
+  return static_cast<bool>(file);
+}
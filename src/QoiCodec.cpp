@@ -0,0 +1,383 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/QoiCodec.h>
+#include <teetime/Image.h>
+#include <cstring>
+#include <fstream>
+
+using namespace teetime;
+
+namespace
+{
+  const size_t HeaderSize = 14;
+  const size_t PaddingSize = 8;
+  const size_t MaxPixels = 400000000; //same limit as the reference implementation
+
+  const uint8 Padding[PaddingSize] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+  const uint8 OpIndex = 0x00;
+  const uint8 OpDiff = 0x40;
+  const uint8 OpLuma = 0x80;
+  const uint8 OpRun = 0xc0;
+  const uint8 OpRgb = 0xfe;
+  const uint8 OpRgba = 0xff;
+  const uint8 OpMask = 0xc0;
+
+  const unsigned MaxRun = 62;
+
+  struct Pixel
+  {
+    uint8 r;
+    uint8 g;
+    uint8 b;
+    uint8 a;
+  };
+
+  uint32 toKey(const Pixel& px)
+  {
+    uint32 key;
+    memcpy(&key, &px, sizeof(key));
+    return key;
+  }
+
+  unsigned hash(const Pixel& px)
+  {
+    return (px.r * 3 + px.g * 5 + px.b * 7 + px.a * 11) & 63;
+  }
+
+  void write32(uint8* p, uint32 value)
+  {
+    p[0] = static_cast<uint8>(value >> 24);
+    p[1] = static_cast<uint8>(value >> 16);
+    p[2] = static_cast<uint8>(value >> 8);
+    p[3] = static_cast<uint8>(value);
+  }
+
+  uint32 read32(const uint8* p)
+  {
+    return (uint32(p[0]) << 24) | (uint32(p[1]) << 16) | (uint32(p[2]) << 8) | uint32(p[3]);
+  }
+
+  template<unsigned N>
+  Pixel loadPixel(const uint8* src);
+
+  template<>
+  Pixel loadPixel<1>(const uint8* src)
+  {
+    return Pixel{ src[0], src[0], src[0], 255 };
+  }
+
+  template<>
+  Pixel loadPixel<2>(const uint8* src)
+  {
+    return Pixel{ src[0], src[0], src[0], src[1] };
+  }
+
+  template<>
+  Pixel loadPixel<3>(const uint8* src)
+  {
+    return Pixel{ src[0], src[1], src[2], 255 };
+  }
+
+  template<>
+  Pixel loadPixel<4>(const uint8* src)
+  {
+    return Pixel{ src[0], src[1], src[2], src[3] };
+  }
+
+  /**
+   * Encode 'count' pixels with N channels each, returns the end of the written chunks.
+   */
+  template<unsigned N>
+  uint8* encodePixels(const uint8* src, size_t count, uint8* out)
+  {
+    uint32 index[64] = {};
+    Pixel prev = { 0, 0, 0, 255 };
+    uint32 prevKey = toKey(prev);
+    unsigned run = 0;
+
+    for (size_t i = 0; i < count; ++i, src += N)
+    {
+      const Pixel px = loadPixel<N>(src);
+      const uint32 key = toKey(px);
+
+      if (key == prevKey)
+      {
+        if (++run == MaxRun)
+        {
+          *out++ = static_cast<uint8>(OpRun | (run - 1));
+          run = 0;
+        }
+        continue;
+      }
+
+      if (run > 0)
+      {
+        *out++ = static_cast<uint8>(OpRun | (run - 1));
+        run = 0;
+      }
+
+      const unsigned h = hash(px);
+      if (index[h] == key)
+      {
+        *out++ = static_cast<uint8>(OpIndex | h);
+      }
+      else
+      {
+        index[h] = key;
+
+        if (px.a == prev.a)
+        {
+          const int vr = static_cast<int8>(px.r - prev.r);
+          const int vg = static_cast<int8>(px.g - prev.g);
+          const int vb = static_cast<int8>(px.b - prev.b);
+          const int vgr = vr - vg;
+          const int vgb = vb - vg;
+
+          if (vr >= -2 && vr <= 1 && vg >= -2 && vg <= 1 && vb >= -2 && vb <= 1)
+          {
+            *out++ = static_cast<uint8>(OpDiff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2));
+          }
+          else if (vgr >= -8 && vgr <= 7 && vg >= -32 && vg <= 31 && vgb >= -8 && vgb <= 7)
+          {
+            *out++ = static_cast<uint8>(OpLuma | (vg + 32));
+            *out++ = static_cast<uint8>((vgr + 8) << 4 | (vgb + 8));
+          }
+          else
+          {
+            out[0] = OpRgb;
+            out[1] = px.r;
+            out[2] = px.g;
+            out[3] = px.b;
+            out += 4;
+          }
+        }
+        else
+        {
+          out[0] = OpRgba;
+          out[1] = px.r;
+          out[2] = px.g;
+          out[3] = px.b;
+          out[4] = px.a;
+          out += 5;
+        }
+      }
+
+      prev = px;
+      prevKey = key;
+    }
+
+    if (run > 0)
+    {
+      *out++ = static_cast<uint8>(OpRun | (run - 1));
+    }
+
+    return out;
+  }
+
+  /**
+   * Decode 'count' pixels into N (3 or 4) channels each.
+   * Chunks are read up to 'end', which is followed by the padding, so a chunk never reads past the data.
+   * @return false if the chunks end before 'count' pixels (truncated data)
+   */
+  template<unsigned N>
+  bool decodePixels(const uint8* p, const uint8* end, size_t count, uint8* dst)
+  {
+    Pixel index[64] = {};
+    Pixel px = { 0, 0, 0, 255 };
+    unsigned run = 0;
+
+    for (size_t i = 0; i < count; ++i, dst += N)
+    {
+      if (run > 0)
+      {
+        --run;
+      }
+      else
+      {
+        if (p >= end)
+          return false;
+
+        const unsigned b1 = *p++;
+
+        if (b1 == OpRgb)
+        {
+          px.r = p[0];
+          px.g = p[1];
+          px.b = p[2];
+          p += 3;
+        }
+        else if (b1 == OpRgba)
+        {
+          px.r = p[0];
+          px.g = p[1];
+          px.b = p[2];
+          px.a = p[3];
+          p += 4;
+        }
+        else
+        {
+          switch (b1 & OpMask)
+          {
+          case OpIndex:
+            px = index[b1];
+            break;
+          case OpDiff:
+            px.r = static_cast<uint8>(px.r + ((b1 >> 4) & 3) - 2);
+            px.g = static_cast<uint8>(px.g + ((b1 >> 2) & 3) - 2);
+            px.b = static_cast<uint8>(px.b + (b1 & 3) - 2);
+            break;
+          case OpLuma:
+          {
+            const unsigned b2 = *p++;
+            const int vg = static_cast<int>(b1 & 0x3f) - 32;
+            px.r = static_cast<uint8>(px.r + vg - 8 + ((b2 >> 4) & 0x0f));
+            px.g = static_cast<uint8>(px.g + vg);
+            px.b = static_cast<uint8>(px.b + vg - 8 + (b2 & 0x0f));
+            break;
+          }
+          default:
+            run = b1 & 0x3f;
+            break;
+          }
+        }
+
+        index[hash(px)] = px;
+      }
+
+      dst[0] = px.r;
+      dst[1] = px.g;
+      dst[2] = px.b;
+      if (N == 4)
+        dst[3] = px.a;
+    }
+
+    //the last chunk must not reach into the padding
+    return p <= end;
+  }
+}
+
+bool teetime::encodeQoi(const Image& image, std::vector<uint8>& qoi)
+{
+  const size_t width = image.getWidth();
+  const size_t height = image.getHeight();
+  const size_t count = width * height;
+
+  if (count == 0 || count > MaxPixels || !image.getPixels())
+    return false;
+
+  const unsigned channels = hasAlpha(image.getFormat()) ? 4 : 3;
+
+  //worst case: every pixel is stored as a full RGB(A) chunk
+  qoi.resize(HeaderSize + count * (channels + 1) + PaddingSize);
+
+  uint8* out = qoi.data();
+  memcpy(out, "qoif", 4);
+  write32(out + 4, static_cast<uint32>(width));
+  write32(out + 8, static_cast<uint32>(height));
+  out[12] = static_cast<uint8>(channels);
+  out[13] = 0; //sRGB with linear alpha
+  out += HeaderSize;
+
+  const uint8* src = image.getPixels();
+
+  switch (image.getFormat())
+  {
+  case PixelFormat::Gray8:
+    out = encodePixels<1>(src, count, out);
+    break;
+  case PixelFormat::GrayAlpha8:
+    out = encodePixels<2>(src, count, out);
+    break;
+  case PixelFormat::Rgb8:
+    out = encodePixels<3>(src, count, out);
+    break;
+  case PixelFormat::Rgba8:
+    out = encodePixels<4>(src, count, out);
+    break;
+  }
+
+  memcpy(out, Padding, PaddingSize);
+  out += PaddingSize;
+
+  qoi.resize(out - qoi.data());
+  return true;
+}
+
+bool teetime::writeQoiFile(const Image& image, const std::string& filename)
+{
+  std::vector<uint8> qoi;
+  if (!encodeQoi(image, qoi))
+    return false;
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(qoi.data()), qoi.size());
+
+  return static_cast<bool>(file);
+}
+
+bool teetime::isQoi(const uint8* data, size_t dataSize)
+{
+  return dataSize >= HeaderSize && memcmp(data, "qoif", 4) == 0;
+}
+
+bool teetime::probeQoi(const uint8* data, size_t dataSize, ImageInfo& info)
+{
+  if (!isQoi(data, dataSize))
+    return false;
+
+  const size_t width = read32(data + 4);
+  const size_t height = read32(data + 8);
+  const unsigned channels = data[12];
+
+  if (width == 0 || height == 0 || width * height > MaxPixels)
+    return false;
+
+  if (channels != 3 && channels != 4)
+    return false;
+
+  info.width = width;
+  info.height = height;
+  info.channels = channels;
+
+  return true;
+}
+
+bool teetime::decodeQoi(const uint8* data, size_t dataSize, Image& image, bool nativeFormat)
+{
+  ImageInfo info;
+  if (dataSize < HeaderSize + PaddingSize || !probeQoi(data, dataSize, info))
+    return false;
+
+  const PixelFormat format = nativeFormat ? pixelFormatFromChannels(info.channels) : PixelFormat::Rgba8;
+  image.setSize(info.width, info.height, format);
+
+  const uint8* chunks = data + HeaderSize;
+  const uint8* end = data + dataSize - PaddingSize;
+  const size_t count = info.width * info.height;
+
+  const bool complete = (format == PixelFormat::Rgb8)
+    ? decodePixels<3>(chunks, end, count, image.getPixels())
+    : decodePixels<4>(chunks, end, count, image.getPixels());
+
+  if (!complete)
+  {
+    image.reset();
+    return false;
+  }
+
+  return true;
+}
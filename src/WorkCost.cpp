@@ -0,0 +1,68 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/WorkCost.h>
+#include <teetime/File.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/MappedFileBuffer.h>
+#include <teetime/Image.h>
+#include <teetime/platform.h>
+
+using namespace teetime;
+
+namespace
+{
+  uint64 pixelCount(const uint8* data, size_t size)
+  {
+    ImageInfo info;
+    if (!Image::probe(data, size, info))
+      return size;
+
+    return static_cast<uint64>(info.width) * info.height;
+  }
+}
+
+uint64 FileSizeCost::operator()(const File& file) const
+{
+  uint64 size = 0;
+  if (!platform::getFileSize(file.path, size))
+    return 0;
+
+  return size;
+}
+
+uint64 ImagePixelCost::operator()(const File& file) const
+{
+  ImageInfo info;
+  if (!Image::probe(file.path, info))
+    return FileSizeCost()(file);
+
+  return static_cast<uint64>(info.width) * info.height;
+}
+
+uint64 ImagePixelCost::operator()(const FileBuffer& buffer) const
+{
+  return pixelCount(buffer.bytes.data(), buffer.bytes.size());
+}
+
+uint64 ImagePixelCost::operator()(const MappedFileBuffer& buffer) const
+{
+  return pixelCount(buffer.data(), buffer.size());
+}
+
+uint64 ImagePixelCost::operator()(const Image& image) const
+{
+  return static_cast<uint64>(image.getWidth()) * image.getHeight();
+}
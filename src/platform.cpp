@@ -0,0 +1,49 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/platform.h>
+#include <teetime/logging.h>
+#include <limits>
+
+namespace teetime
+{
+namespace platform
+{
+  bool readWholeFile(const char* path, std::vector<uint8>& bytes)
+  {
+    assert(path);
+
+    uint64 size = 0;
+    FileHandle file = openFile(path, size);
+    if (file == InvalidFileHandle)
+      return false;
+
+    if (size > std::numeric_limits<size_t>::max())
+    {
+      TEETIME_ERROR() << "file too big: " << path;
+      closeFile(file);
+      return false;
+    }
+
+    bytes.resize(static_cast<size_t>(size));
+
+    //don't try to read if size is 0 anyway (because bytes.data() may return null in this case)
+    const bool success = size == 0 || readFile(file, 0, bytes.data(), bytes.size()) == bytes.size();
+    closeFile(file);
+
+    return success;
+  }
+}
+}
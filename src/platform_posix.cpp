@@ -19,63 +19,106 @@
 #include <teetime/platform.h>
 #include <sys/time.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <pthread.h>
 #include <dirent.h>
 #include <errno.h>
 #include <cstring>
+#include <cstdio>
 
 
 namespace teetime
 {
 namespace platform
 {
+  //type of a directory entry, falls back to 'lstat' if file system does not report the type (DT_UNKNOWN)
+  static unsigned char entryType(const std::string& path, const struct dirent* ep)
+  {
+    if (ep->d_type != DT_UNKNOWN)
+      return ep->d_type;
+
+    struct stat buf;
+    if (lstat(path.c_str(), &buf) == -1)
+      return DT_UNKNOWN;
+
+    if (S_ISREG(buf.st_mode))
+      return DT_REG;
+
+    if (S_ISDIR(buf.st_mode))
+      return DT_DIR;
+
+    return DT_UNKNOWN;
+  }
+
   static bool listDirectoryContent(const char* path, std::vector<std::string>& entries, bool recursive, bool files, bool dirs)
   {
     assert(path);
 
-    DIR* dp;
-    struct dirent* ep;
+    std::vector<std::string> fileEntries;
+    std::vector<std::string> dirEntries;
 
-    dp = opendir(path);
-    if (dp)
+    if (!listDirectory(path, fileEntries, dirEntries))
+      return false;
+
+    if (files)
     {
-      while ((ep = readdir(dp)))
+      entries.insert(entries.end(), fileEntries.begin(), fileEntries.end());
+    }
+
+    for (const auto& d : dirEntries)
+    {
+      if (dirs)
+        entries.push_back(d);
+
+      if (recursive)
       {
-        if (std::strcmp(".", ep->d_name) == 0 || std::strcmp("..", ep->d_name) == 0)
-          continue;
+        std::vector<std::string> subentries;
+        if (!listDirectoryContent((std::string(path) + "/" + d).c_str(), subentries, recursive, files, dirs))
+          return false;
 
-        if (ep->d_type == DT_REG)
-        {
-          if(files)
-            entries.push_back(ep->d_name);
-        }
-        else if (ep->d_type == DT_DIR)
+        for (const auto& e : subentries)
         {
-          if(dirs)
-            entries.push_back(ep->d_name);
-
-          if (recursive)
-          {
-            char buffer[256];
-            sprintf(buffer, "%s/%s", path, ep->d_name);
-            std::vector<std::string> subentries;
-            if (!listDirectoryContent(buffer, subentries, recursive, files, dirs))
-              return false;
-
-            for (const auto& e : subentries)
-            {
-              entries.push_back(std::string(ep->d_name) + "/" + e);
-            }
-          }
+          entries.push_back(d + "/" + e);
         }
       }
-
-      (void)closedir(dp);
-      return true;
     }
 
-    return false;
+    return true;
+  }
+
+  bool listDirectory(const char* directory, std::vector<std::string>& files, std::vector<std::string>& subDirectories)
+  {
+    assert(directory);
+
+    //readdir fetches entries in large batches (getdents64), so we don't need to do that manually
+    DIR* dp = opendir(directory);
+    if (!dp)
+      return false;
+
+    const std::string prefix = std::string(directory) + "/";
+
+    while (struct dirent* ep = readdir(dp))
+    {
+      if (std::strcmp(".", ep->d_name) == 0 || std::strcmp("..", ep->d_name) == 0)
+        continue;
+
+      const unsigned char type = entryType(prefix + ep->d_name, ep);
+
+      if (type == DT_REG)
+      {
+        files.push_back(ep->d_name);
+      }
+      else if (type == DT_DIR)
+      {
+        subDirectories.push_back(ep->d_name);
+      }
+    }
+
+    (void)closedir(dp);
+    return true;
   }
 
 
@@ -123,11 +166,51 @@ namespace platform
     return false;
   }
 
+  bool getFileSize(const char* path, uint64& size)
+  {
+    assert(path);
+    struct stat buf;
+
+    if (stat(path, &buf) == -1 || !S_ISREG(buf.st_mode))
+      return false;
+
+    size = static_cast<uint64>(buf.st_size);
+    return true;
+  }
+
   bool removeFile(const char* path)
   {
     return remove(path) == 0;
   }
 
+  bool removeDirectory(const char* path, bool recursive)
+  {
+    assert(path);
+
+    if (recursive)
+    {
+      std::vector<std::string> files;
+      std::vector<std::string> subDirectories;
+
+      if (!listDirectory(path, files, subDirectories))
+        return false;
+
+      for (const auto& f : files)
+      {
+        if (!removeFile(std::string(path) + "/" + f))
+          return false;
+      }
+
+      for (const auto& d : subDirectories)
+      {
+        if (!removeDirectory((std::string(path) + "/" + d).c_str(), true))
+          return false;
+      }
+    }
+
+    return rmdir(path) == 0;
+  }
+
   bool createDirectory(const char* path)
   {
     assert(path);
@@ -178,6 +261,280 @@ namespace platform
     }
   }
 
+  bool mapFile(const char* path, const void*& data, size_t& size)
+  {
+    assert(path);
+
+    data = nullptr;
+    size = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+      return false;
+
+    struct stat buf;
+    if (fstat(fd, &buf) == -1 || !S_ISREG(buf.st_mode))
+    {
+      close(fd);
+      return false;
+    }
+
+    if (buf.st_size == 0)
+    {
+      close(fd);
+      return true;
+    }
+
+    void* p = mmap(nullptr, static_cast<size_t>(buf.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+    //mapping stays valid after closing the file descriptor
+    close(fd);
+
+    if (p == MAP_FAILED)
+      return false;
+
+    (void)madvise(p, static_cast<size_t>(buf.st_size), MADV_SEQUENTIAL);
+
+    data = p;
+    size = static_cast<size_t>(buf.st_size);
+    return true;
+  }
+
+  void unmapFile(const void* data, size_t size)
+  {
+    if (data && size > 0)
+    {
+      munmap(const_cast<void*>(data), size);
+    }
+  }
+
+  FileHandle openFile(const char* path, uint64& size)
+  {
+    assert(path);
+
+    int fd = open(path, O_RDONLY);
+    if (fd == -1)
+      return InvalidFileHandle;
+
+    struct stat buf;
+    if (fstat(fd, &buf) == -1 || !S_ISREG(buf.st_mode))
+    {
+      close(fd);
+      return InvalidFileHandle;
+    }
+
+    (void)posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    size = static_cast<uint64>(buf.st_size);
+    return static_cast<FileHandle>(fd);
+  }
+
+  void closeFile(FileHandle file)
+  {
+    if (file != InvalidFileHandle)
+    {
+      close(static_cast<int>(file));
+    }
+  }
+
+  size_t readFile(FileHandle file, uint64 offset, void* buffer, size_t size)
+  {
+    assert(file != InvalidFileHandle);
+
+    size_t total = 0;
+    while (total < size)
+    {
+      ssize_t n = pread(static_cast<int>(file), static_cast<char*>(buffer) + total, size - total, static_cast<off_t>(offset + total));
+
+      if (n < 0 && errno == EINTR)
+        continue;
+
+      if (n <= 0)
+        break;
+
+      total += static_cast<size_t>(n);
+    }
+
+    return total;
+  }
+
+  void prefetchFile(FileHandle file, uint64 offset, size_t size)
+  {
+    assert(file != InvalidFileHandle);
+    (void)posix_fadvise(static_cast<int>(file), static_cast<off_t>(offset), static_cast<off_t>(size), POSIX_FADV_WILLNEED);
+  }
+
+  FileHandle createFile(const char* path, bool directIO)
+  {
+    assert(path);
+
+    static const mode_t mode = S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH;
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC;
+
+    int fd = -1;
+    if (directIO)
+    {
+      fd = open(path, flags | O_DIRECT, mode);
+
+      //some file systems (e.g. tmpfs) don't support direct I/O
+      if (fd == -1 && errno == EINVAL)
+      {
+        fd = open(path, flags, mode);
+      }
+    }
+    else
+    {
+      fd = open(path, flags, mode);
+    }
+
+    return (fd == -1) ? InvalidFileHandle : static_cast<FileHandle>(fd);
+  }
+
+  size_t writeFile(FileHandle file, uint64 offset, const void* data, size_t size)
+  {
+    assert(file != InvalidFileHandle);
+
+    size_t total = 0;
+    while (total < size)
+    {
+      ssize_t n = pwrite(static_cast<int>(file), static_cast<const char*>(data) + total, size - total, static_cast<off_t>(offset + total));
+
+      if (n < 0 && errno == EINTR)
+        continue;
+
+      if (n <= 0)
+        break;
+
+      total += static_cast<size_t>(n);
+    }
+
+    return total;
+  }
+
+  bool resizeFile(FileHandle file, uint64 size)
+  {
+    assert(file != InvalidFileHandle);
+    return ftruncate(static_cast<int>(file), static_cast<off_t>(size)) == 0;
+  }
+
+  bool syncFile(FileHandle file)
+  {
+    assert(file != InvalidFileHandle);
+    return fdatasync(static_cast<int>(file)) == 0;
+  }
+
+  //rename, but fail (EEXIST) instead of replacing an existing destination
+  static bool renameNoReplace(const char* from, const char* to)
+  {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 28))
+    if (renameat2(AT_FDCWD, from, AT_FDCWD, to, RENAME_NOREPLACE) == 0)
+      return true;
+
+    if (errno != EINVAL && errno != ENOSYS)
+      return false;
+#endif
+
+    //not supported by the file system: link fails as well, if the destination exists
+    if (link(from, to) != 0)
+      return false;
+
+    unlink(from);
+    return true;
+  }
+
+  bool copyFile(const char* from, const char* to, bool overwrite)
+  {
+    assert(from);
+    assert(to);
+
+    uint64 size = 0;
+    FileHandle in = openFile(from, size);
+    if (in == InvalidFileHandle)
+      return false;
+
+    const int fdIn = static_cast<int>(in);
+
+    struct stat source;
+    if (fstat(fdIn, &source) == -1)
+    {
+      closeFile(in);
+      return false;
+    }
+
+    //destination is the source itself (same path or hard link): truncating it would destroy the content
+    struct stat target;
+    if (stat(to, &target) == 0 && (!overwrite || (target.st_dev == source.st_dev && target.st_ino == source.st_ino)))
+    {
+      closeFile(in);
+      return false;
+    }
+
+    //copy into a temporary file next to the destination, which replaces the destination once complete.
+    //so the destination never is a partial copy.
+    std::string tmpPath = std::string(to) + ".tmpXXXXXX";
+    const int fdOut = mkstemp(&tmpPath[0]);
+    if (fdOut == -1)
+    {
+      closeFile(in);
+      return false;
+    }
+
+    (void)fchmod(fdOut, source.st_mode & 07777);
+
+    const FileHandle out = static_cast<FileHandle>(fdOut);
+    uint64 copied = 0;
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+    //kernel side copy, may even create a reflink (no data is copied at all)
+    while (copied < size)
+    {
+      ssize_t n = copy_file_range(fdIn, nullptr, fdOut, nullptr, static_cast<size_t>(size - copied), 0);
+      if (n <= 0)
+        break;
+
+      copied += static_cast<uint64>(n);
+    }
+#endif
+
+    //not supported (e.g. cross file system copy on older kernels), try sendfile
+    while (copied < size)
+    {
+      off_t offset = static_cast<off_t>(copied);
+      ssize_t n = sendfile(fdOut, fdIn, &offset, static_cast<size_t>(size - copied));
+      if (n <= 0)
+        break;
+
+      copied += static_cast<uint64>(n);
+    }
+
+    //last resort: copy through user space
+    if (copied < size)
+    {
+      std::vector<uint8> buffer(static_cast<size_t>((std::min)(size - copied, uint64(1024 * 1024))));
+
+      while (copied < size)
+      {
+        const size_t n = readFile(in, copied, buffer.data(), static_cast<size_t>((std::min)(size - copied, uint64(buffer.size()))));
+        if (n == 0 || writeFile(out, copied, buffer.data(), n) != n)
+          break;
+
+        copied += n;
+      }
+    }
+
+    closeFile(in);
+
+    //the destination might have been created in the meantime, so don't rely on the check above
+    const bool success = (close(fdOut) == 0) && copied == size
+      && (overwrite ? rename(tmpPath.c_str(), to) == 0 : renameNoReplace(tmpPath.c_str(), to));
+    if (!success)
+    {
+      unlink(tmpPath.c_str());
+    }
+
+    return success;
+  }
+
   void* aligned_malloc(size_t size, size_t align)
   {
     void *result;
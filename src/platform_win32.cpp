@@ -17,6 +17,7 @@
 #ifdef _WIN32
 #include <teetime/platform.h>
 #include <algorithm>
+#include <limits>
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -64,6 +65,19 @@ namespace platform
     return (d != INVALID_FILE_ATTRIBUTES) && (d & FILE_ATTRIBUTE_DIRECTORY);
   }
 
+  bool getFileSize(const char* path, uint64& size)
+  {
+    assert(path);
+    auto winpath = fixpath(path);
+
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(winpath.c_str(), GetFileExInfoStandard, &data) || (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+      return false;
+
+    size = (static_cast<uint64>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    return true;
+  }
+
   bool removeFile(const char* path)
   {
     assert(path);
@@ -73,6 +87,36 @@ namespace platform
     return (ret == TRUE);
   }
 
+  bool removeDirectory(const char* path, bool recursive)
+  {
+    assert(path);
+
+    if (recursive)
+    {
+      std::vector<std::string> files;
+      std::vector<std::string> subDirectories;
+
+      if (!listDirectory(path, files, subDirectories))
+        return false;
+
+      for (const auto& f : files)
+      {
+        if (!removeFile(std::string(path) + "/" + f))
+          return false;
+      }
+
+      for (const auto& d : subDirectories)
+      {
+        if (!removeDirectory((std::string(path) + "/" + d).c_str(), true))
+          return false;
+      }
+    }
+
+    auto winpath = fixpath(path);
+    BOOL ret = RemoveDirectoryA(winpath.c_str());
+    return (ret == TRUE);
+  }
+
   bool createDirectory(const char* path)
   {
     assert(path);
@@ -157,6 +201,40 @@ namespace platform
     return true;
   }
 
+  bool listDirectory(const char* directory, std::vector<std::string>& files, std::vector<std::string>& subDirectories)
+  {
+    assert(directory);
+    auto winpath = fixpath(directory) + "\\*";
+
+    WIN32_FIND_DATAA ffd;
+    HANDLE hFind = FindFirstFileExA(winpath.c_str(), FindExInfoBasic, &ffd, FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH);
+
+    if (INVALID_HANDLE_VALUE == hFind)
+    {
+      TEETIME_DEBUG() << "Directory not found: " << directory;
+      return false;
+    }
+
+    do
+    {
+      if (ffd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+      {
+        //ignore '.' and '..' entries
+        if (strcmp(ffd.cFileName, ".") != 0 && strcmp(ffd.cFileName, "..") != 0)
+        {
+          subDirectories.push_back(std::string(ffd.cFileName));
+        }
+      }
+      else
+      {
+        files.push_back(std::string(ffd.cFileName));
+      }
+    } while (FindNextFileA(hFind, &ffd) != 0);
+
+    FindClose(hFind);
+    return true;
+  }
+
   bool listFiles(const char* directory, std::vector<std::string>& entries, bool recursive)
   {
     return listDirectoryContent(directory, entries, recursive, true, false);
@@ -172,6 +250,220 @@ namespace platform
     SetThreadAffinityMask(GetCurrentThread(), mask);
   }
 
+  bool mapFile(const char* path, const void*& data, size_t& size)
+  {
+    assert(path);
+
+    data = nullptr;
+    size = 0;
+
+    HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+      return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize))
+    {
+      CloseHandle(hFile);
+      return false;
+    }
+
+    if (fileSize.QuadPart == 0)
+    {
+      CloseHandle(hFile);
+      return true;
+    }
+
+    if (static_cast<unsigned long long>(fileSize.QuadPart) > (std::numeric_limits<size_t>::max)())
+    {
+      CloseHandle(hFile);
+      return false;
+    }
+
+    HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(hFile);
+
+    if (!hMapping)
+      return false;
+
+    //view stays valid after closing the mapping handle
+    void* p = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(hMapping);
+
+    if (!p)
+      return false;
+
+    data = p;
+    size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+  }
+
+  void unmapFile(const void* data, size_t size)
+  {
+    if (data && size > 0)
+    {
+      UnmapViewOfFile(data);
+    }
+  }
+
+  FileHandle openFile(const char* path, uint64& size)
+  {
+    assert(path);
+
+    HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE)
+      return InvalidFileHandle;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize))
+    {
+      CloseHandle(hFile);
+      return InvalidFileHandle;
+    }
+
+    size = static_cast<uint64>(fileSize.QuadPart);
+    return reinterpret_cast<FileHandle>(hFile);
+  }
+
+  void closeFile(FileHandle file)
+  {
+    if (file != InvalidFileHandle)
+    {
+      CloseHandle(reinterpret_cast<HANDLE>(file));
+    }
+  }
+
+  size_t readFile(FileHandle file, uint64 offset, void* buffer, size_t size)
+  {
+    assert(file != InvalidFileHandle);
+
+    size_t total = 0;
+    while (total < size)
+    {
+      const uint64 position = offset + total;
+
+      OVERLAPPED overlapped = {};
+      overlapped.Offset = static_cast<DWORD>(position);
+      overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+      const DWORD toRead = static_cast<DWORD>((std::min)(size - total, static_cast<size_t>(1) << 30));
+      DWORD n = 0;
+
+      if (!ReadFile(reinterpret_cast<HANDLE>(file), static_cast<char*>(buffer) + total, toRead, &n, &overlapped) || n == 0)
+        break;
+
+      total += n;
+    }
+
+    return total;
+  }
+
+  void prefetchFile(FileHandle, uint64, size_t)
+  {
+    //FILE_FLAG_SEQUENTIAL_SCAN already makes Windows read ahead aggressively
+  }
+
+  FileHandle createFile(const char* path, bool directIO)
+  {
+    assert(path);
+
+    const DWORD flags = directIO ? (FILE_FLAG_NO_BUFFERING | FILE_FLAG_WRITE_THROUGH) : FILE_ATTRIBUTE_NORMAL;
+    HANDLE hFile = CreateFileA(path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, flags, NULL);
+
+    return (hFile == INVALID_HANDLE_VALUE) ? InvalidFileHandle : reinterpret_cast<FileHandle>(hFile);
+  }
+
+  size_t writeFile(FileHandle file, uint64 offset, const void* data, size_t size)
+  {
+    assert(file != InvalidFileHandle);
+
+    size_t total = 0;
+    while (total < size)
+    {
+      const uint64 position = offset + total;
+
+      OVERLAPPED overlapped = {};
+      overlapped.Offset = static_cast<DWORD>(position);
+      overlapped.OffsetHigh = static_cast<DWORD>(position >> 32);
+
+      const DWORD toWrite = static_cast<DWORD>((std::min)(size - total, static_cast<size_t>(1) << 30));
+      DWORD n = 0;
+
+      if (!WriteFile(reinterpret_cast<HANDLE>(file), static_cast<const char*>(data) + total, toWrite, &n, &overlapped) || n == 0)
+        break;
+
+      total += n;
+    }
+
+    return total;
+  }
+
+  bool resizeFile(FileHandle file, uint64 size)
+  {
+    assert(file != InvalidFileHandle);
+
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+
+    return SetFileInformationByHandle(reinterpret_cast<HANDLE>(file), FileEndOfFileInfo, &info, sizeof(info)) != 0;
+  }
+
+  bool syncFile(FileHandle file)
+  {
+    assert(file != InvalidFileHandle);
+    return FlushFileBuffers(reinterpret_cast<HANDLE>(file)) != 0;
+  }
+
+  static bool getFileId(const char* path, BY_HANDLE_FILE_INFORMATION& info)
+  {
+    HANDLE h = CreateFileA(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (h == INVALID_HANDLE_VALUE)
+      return false;
+
+    const bool success = GetFileInformationByHandle(h, &info) != 0;
+    CloseHandle(h);
+    return success;
+  }
+
+  static bool isSameFile(const char* a, const char* b)
+  {
+    BY_HANDLE_FILE_INFORMATION ia;
+    BY_HANDLE_FILE_INFORMATION ib;
+
+    if (!getFileId(a, ia) || !getFileId(b, ib))
+      return false;
+
+    return ia.dwVolumeSerialNumber == ib.dwVolumeSerialNumber
+        && ia.nFileIndexHigh == ib.nFileIndexHigh
+        && ia.nFileIndexLow == ib.nFileIndexLow;
+  }
+
+  bool copyFile(const char* from, const char* to, bool overwrite)
+  {
+    assert(from);
+    assert(to);
+
+    //destination is the source itself (same path or hard link): copying would destroy the content
+    if (isSameFile(from, to) || (!overwrite && isFile(to)))
+      return false;
+
+    //CopyFile copies inside the kernel (and uses server side copies on network shares) and keeps attributes.
+    //copy into a temporary file first, so the destination never is a partial copy.
+    const std::string tmpPath = std::string(to) + ".tmp" + std::to_string(GetCurrentThreadId());
+    if (!CopyFileA(from, tmpPath.c_str(), FALSE))
+      return false;
+
+    //without MOVEFILE_REPLACE_EXISTING, a destination created in the meantime is not replaced
+    if (!MoveFileExA(tmpPath.c_str(), to, overwrite ? MOVEFILE_REPLACE_EXISTING : 0))
+    {
+      DeleteFileA(tmpPath.c_str());
+      return false;
+    }
+
+    return true;
+  }
+
+
   void* aligned_malloc(size_t size, size_t align)
   {
     return _mm_malloc(size, align);
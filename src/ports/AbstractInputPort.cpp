@@ -0,0 +1,34 @@
+/**
+ * Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <teetime/ports/AbstractInputPort.h>
+#include <teetime/stages/AbstractStage.h>
+#include <teetime/pipes/AbstractPipe.h>
+#include <teetime/Signal.h>
+
+using namespace teetime;
+
+void AbstractInputPort::cancel()
+{
+  if(auto p = getPipe())
+  {
+    p->cancel();
+
+    if(auto sender = p->sender())
+    {
+      sender->onSignal(Signal{SignalType::Cancel, owner()});
+    }
+  }
+}
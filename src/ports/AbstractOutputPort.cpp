@@ -27,3 +27,13 @@ void AbstractOutputPort::sendSignal(const Signal& signal)
     p->addSignal(signal);
   }
 }
+
+bool AbstractOutputPort::isCanceled()
+{
+  if(auto p = getPipe())
+  {
+    return p->isCanceled();
+  }
+
+  return false;
+}
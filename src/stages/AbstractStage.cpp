@@ -25,6 +25,7 @@ using namespace teetime;
 
 AbstractStage::AbstractStage(const char* debugName)
   : m_state(StageState::Created)
+  , m_canceled(false)
 {
   if(debugName)
   {
@@ -70,6 +71,14 @@ void AbstractStage::onSignal(const Signal& s)
     TEETIME_DEBUG() << debugName() << ": Terminating signal received";
     terminate();
   }
+  else if(s.type == SignalType::Cancel)
+  {
+    TEETIME_DEBUG() << debugName() << ": Cancel signal received";
+    if(allOutputPortsCanceled())
+    {
+      cancel();
+    }
+  }
   else
   {
     for (const auto& p : m_outputPorts)
@@ -93,4 +102,28 @@ void AbstractStage::terminate()
   }
 
   m_state = StageState::Terminated;
-}
\ No newline at end of file
+}
+
+void AbstractStage::cancel()
+{
+  if(m_canceled.exchange(true))
+    return;
+
+  TEETIME_DEBUG() << debugName() << ": canceling stage...";
+
+  for(const auto& p : m_inputPorts)
+  {
+    p->cancel();
+  }
+}
+
+bool AbstractStage::allOutputPortsCanceled() const
+{
+  for(const auto& p : m_outputPorts)
+  {
+    if(!p->isCanceled())
+      return false;
+  }
+
+  return true;
+}
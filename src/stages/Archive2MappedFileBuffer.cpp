@@ -0,0 +1,82 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/Archive2MappedFileBuffer.h>
+#include <teetime/ports/OutputPort.h>
+#include <teetime/MappedFileBuffer.h>
+#include <teetime/Archive.h>
+
+using namespace teetime;
+
+Archive2MappedFileBuffer::Archive2MappedFileBuffer(const char* debugName)
+  : AbstractFilterStage<std::string, MappedFileBuffer>(debugName)
+  , m_numEntriesSkipped(0)
+{
+}
+
+size_t Archive2MappedFileBuffer::numEntriesSkipped() const
+{
+  return m_numEntriesSkipped;
+}
+
+void Archive2MappedFileBuffer::execute(std::string&& value)
+{
+  std::vector<ArchiveEntry> entries;
+  if (!readArchiveIndex(value, entries))
+  {
+    TEETIME_WARN() << "failed to read archive: " << value;
+    return;
+  }
+
+  //entries are stored in segment order, so only one segment has to be mapped at a time
+  //(and a segment that failed to map is tried only once).
+  //views that are still in flight keep their segment mapped.
+  MappedFileBuffer segment;
+  uint32 segmentIndex = 0;
+  bool first = true;
+  bool mapped = false;
+
+  for (const auto& entry : entries)
+  {
+    if (isCanceled())
+      return;
+
+    if (first || entry.segment != segmentIndex)
+    {
+      first = false;
+      segmentIndex = entry.segment;
+      mapped = segment.map(archiveSegmentPath(value, segmentIndex));
+      if (!mapped)
+      {
+        TEETIME_WARN() << "failed to map archive segment, skipping its entries: " << archiveSegmentPath(value, segmentIndex);
+      }
+    }
+
+    if (!mapped)
+    {
+      m_numEntriesSkipped += 1;
+      continue;
+    }
+
+    if (entry.offset > segment.size() || entry.length > segment.size() - entry.offset)
+    {
+      TEETIME_WARN() << "archive entry exceeds segment: " << entry.name;
+      m_numEntriesSkipped += 1;
+      continue;
+    }
+
+    getOutputPort().send(segment.slice(static_cast<size_t>(entry.offset), static_cast<size_t>(entry.length), entry.name));
+  }
+}
@@ -0,0 +1,120 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/ArchiveSink.h>
+#include <teetime/ports/InputPort.h>
+#include <teetime/Runnable.h>
+#include <teetime/Optional.h>
+#include <teetime/File.h>
+#include <teetime/logging.h>
+#include <thread>
+
+using namespace teetime;
+
+ArchiveSink::ArchiveSink(const std::string& basePath, uint64 segmentSize, const char* debugName)
+  : AbstractStage(debugName)
+  , m_inputPort(nullptr)
+  , m_basePath(basePath)
+  , m_writer(segmentSize)
+  , m_opened(false)
+  , m_numEntriesWritten(0)
+  , m_numEntriesFailed(0)
+{
+  m_inputPort = addNewInputPort<FileBuffer>();
+}
+
+InputPort<FileBuffer>& ArchiveSink::getInputPort()
+{
+  assert(m_inputPort);
+  return *m_inputPort;
+}
+
+void ArchiveSink::setBaseDirectory(const std::string& directory)
+{
+  m_baseDirectory = directory;
+}
+
+std::string ArchiveSink::entryName(const std::string& path) const
+{
+  return relativePath(path, m_baseDirectory);
+}
+
+void ArchiveSink::setRecyclingPool(shared_ptr<FileBufferPool> pool)
+{
+  m_pool = pool;
+}
+
+size_t ArchiveSink::numEntriesWritten() const
+{
+  return m_numEntriesWritten;
+}
+
+size_t ArchiveSink::numEntriesFailed() const
+{
+  return m_numEntriesFailed;
+}
+
+void ArchiveSink::execute()
+{
+  if (!m_opened)
+  {
+    m_opened = true;
+    if (!m_writer.open(m_basePath))
+    {
+      TEETIME_WARN() << "failed to create archive: " << m_basePath;
+    }
+  }
+
+  auto v = m_inputPort->receive();
+  if (v)
+  {
+    if (isCanceled())
+      return;
+
+    FileBuffer& buffer = *v;
+    if (m_writer.add(entryName(buffer.path), buffer.bytes.data(), buffer.bytes.size()))
+    {
+      m_numEntriesWritten += 1;
+    }
+    else
+    {
+      TEETIME_WARN() << "failed to add '" << buffer.path << "' to archive: " << m_basePath;
+      m_numEntriesFailed += 1;
+    }
+
+    if (m_pool)
+    {
+      m_pool->recycle(std::move(buffer.bytes));
+    }
+  }
+  else if (m_inputPort->isClosed())
+  {
+    if (m_writer.isOpen() && !m_writer.close())
+    {
+      TEETIME_WARN() << "failed to finish archive: " << m_basePath;
+    }
+
+    terminate();
+  }
+  else
+  {
+    std::this_thread::yield();
+  }
+}
+
+unique_ptr<Runnable> ArchiveSink::createRunnable()
+{
+  return unique_ptr<Runnable>(new ConsumerStageRunnable(this));
+}
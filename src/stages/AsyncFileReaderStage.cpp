@@ -0,0 +1,219 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/AsyncFileReaderStage.h>
+#include <teetime/ports/InputPort.h>
+#include <teetime/ports/OutputPort.h>
+#include <teetime/Runnable.h>
+#include <teetime/Optional.h>
+#include <teetime/platform.h>
+#include <algorithm>
+
+using namespace teetime;
+
+AsyncFileReaderStage::AsyncFileReaderStage(size_t queueDepth, size_t numThreads, const char* debugName)
+  : AbstractStage(debugName)
+  , m_inputPort(nullptr)
+  , m_outputPort(nullptr)
+  , m_queueDepth(std::max<size_t>(queueDepth, 1))
+  , m_numThreads(numThreads > 0 ? std::min(numThreads, m_queueDepth) : m_queueDepth)
+  , m_inFlight(0)
+  , m_stopping(false)
+{
+  m_inputPort = addNewInputPort<File>();
+  m_outputPort = addNewOutputPort<FileBuffer>();
+}
+
+AsyncFileReaderStage::~AsyncFileReaderStage()
+{
+  stopThreads();
+}
+
+InputPort<File>& AsyncFileReaderStage::getInputPort()
+{
+  return *m_inputPort;
+}
+
+OutputPort<FileBuffer>& AsyncFileReaderStage::getOutputPort()
+{
+  return *m_outputPort;
+}
+
+void AsyncFileReaderStage::setRecyclingPool(shared_ptr<FileBufferPool> pool)
+{
+  m_pool = std::move(pool);
+}
+
+unique_ptr<Runnable> AsyncFileReaderStage::createRunnable()
+{
+  return unique_ptr<Runnable>(new ConsumerStageRunnable(this));
+}
+
+void AsyncFileReaderStage::startThreads()
+{
+  assert(m_threads.empty());
+
+  for (size_t i = 0; i < m_numThreads; ++i)
+  {
+    m_threads.push_back(std::thread([this]() { readerThread(); }));
+  }
+}
+
+void AsyncFileReaderStage::stopThreads()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+
+  m_requestCond.notify_all();
+
+  for (auto& t : m_threads)
+  {
+    t.join();
+  }
+
+  m_threads.clear();
+}
+
+void AsyncFileReaderStage::readerThread()
+{
+  while (true)
+  {
+    File file;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (m_requests.empty() && !m_stopping)
+      {
+        m_requestCond.wait(lock);
+      }
+
+      if (m_requests.empty())
+        return;
+
+      file = std::move(m_requests.front());
+      m_requests.pop_front();
+    }
+
+    Completion completion;
+
+    if (m_pool)
+    {
+      m_pool->take(completion.buffer.bytes);
+    }
+
+    completion.buffer.path = file.path;
+    completion.success = !isCanceled() && platform::readWholeFile(file.path, completion.buffer.bytes);
+
+    if (!completion.success)
+    {
+      TEETIME_DEBUG() << "failed to read file: " << file.path;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_completions.push_back(std::move(completion));
+    }
+
+    m_completionCond.notify_one();
+  }
+}
+
+void AsyncFileReaderStage::submit(File&& file)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_requests.push_back(std::move(file));
+  }
+
+  m_inFlight += 1;
+  m_requestCond.notify_one();
+}
+
+bool AsyncFileReaderStage::sendCompleted(bool wait)
+{
+  std::deque<Completion> completions;
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (wait && m_completions.empty())
+    {
+      m_completionCond.wait(lock);
+    }
+
+    completions.swap(m_completions);
+  }
+
+  assert(completions.size() <= m_inFlight);
+  m_inFlight -= completions.size();
+
+  for (auto& c : completions)
+  {
+    if (c.success && !isCanceled())
+    {
+      m_outputPort->send(std::move(c.buffer));
+    }
+    else if (m_pool)
+    {
+      //buffer was taken from the pool, don't drain it
+      m_pool->recycle(std::move(c.buffer.bytes));
+    }
+  }
+
+  return !completions.empty();
+}
+
+void AsyncFileReaderStage::execute()
+{
+  if (m_threads.empty())
+  {
+    startThreads();
+  }
+
+  bool progress = sendCompleted(false);
+
+  if (m_inFlight >= m_queueDepth)
+  {
+    //queue is full, wait for at least one read to complete
+    sendCompleted(true);
+    return;
+  }
+
+  auto v = m_inputPort->receive();
+  if (v)
+  {
+    if (!isCanceled())
+    {
+      submit(std::move(*v));
+    }
+  }
+  else if (m_inputPort->isClosed())
+  {
+    if (m_inFlight > 0)
+    {
+      sendCompleted(true);
+    }
+    else
+    {
+      stopThreads();
+      terminate();
+    }
+  }
+  else if (!progress)
+  {
+    std::this_thread::yield();
+  }
+}
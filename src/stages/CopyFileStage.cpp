@@ -0,0 +1,137 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/CopyFileStage.h>
+#include <teetime/ports/OutputPort.h>
+#include <teetime/platform.h>
+#include <algorithm>
+
+using namespace teetime;
+
+namespace
+{
+  //a relative path that stays inside the directory it is appended to
+  bool isNestedPath(const std::string& name)
+  {
+    if (name.empty())
+      return false;
+
+    size_t start = 0;
+    while (start <= name.size())
+    {
+      const size_t separator = (std::min)(name.find_first_of("/\\", start), name.size());
+      if (name.compare(start, separator - start, "..") == 0)
+        return false;
+
+      start = separator + 1;
+    }
+
+    return true;
+  }
+
+  //create the directories of the relative path 'name' below 'directory'
+  void createSubdirectories(const std::string& directory, const std::string& name)
+  {
+    size_t separator = name.find_first_of("/\\");
+
+    while (separator != std::string::npos)
+    {
+      const std::string subdirectory = directory + "/" + name.substr(0, separator);
+      if (!platform::isDirectory(subdirectory))
+      {
+        platform::createDirectory(subdirectory);
+      }
+
+      separator = name.find_first_of("/\\", separator + 1);
+    }
+  }
+}
+
+CopyFileStage::CopyFileStage(const std::string& targetDirectory, const char* debugName)
+  : AbstractFilterStage<File, File>(debugName)
+  , m_targetDirectory(targetDirectory)
+  , m_overwrite(false)
+  , m_numFilesCopied(0)
+  , m_numFilesFailed(0)
+{
+}
+
+void CopyFileStage::setBaseDirectory(const std::string& directory)
+{
+  m_baseDirectory = directory;
+}
+
+void CopyFileStage::setOverwrite(bool overwrite)
+{
+  m_overwrite = overwrite;
+}
+
+size_t CopyFileStage::numFilesCopied() const
+{
+  return m_numFilesCopied;
+}
+
+size_t CopyFileStage::numFilesFailed() const
+{
+  return m_numFilesFailed;
+}
+
+void CopyFileStage::execute(File&& value)
+{
+  std::string name = relativePath(value.path, m_baseDirectory);
+
+  const bool keepPath = (name != value.path);
+
+  if (!keepPath)
+  {
+    //not inside the base directory: keep file name only
+    const size_t separator = value.path.find_last_of("/\\");
+    if (separator != std::string::npos)
+    {
+      name = value.path.substr(separator + 1);
+    }
+  }
+
+  //'path == base directory' or '..' would write to or outside of the target directory itself
+  if (!isNestedPath(name))
+  {
+    TEETIME_WARN() << "failed to copy '" << value.path << "': no valid target in '" << m_targetDirectory << "'";
+    m_numFilesFailed += 1;
+    return;
+  }
+
+  if (keepPath)
+  {
+    createSubdirectories(m_targetDirectory, name);
+  }
+
+  File target(m_targetDirectory + "/" + name);
+
+  if (platform::copyFile(value.path, target.path, m_overwrite))
+  {
+    m_numFilesCopied += 1;
+    getOutputPort().send(std::move(target));
+  }
+  else if (!m_overwrite && platform::isFile(target.path))
+  {
+    TEETIME_WARN() << "failed to copy '" << value.path << "': '" << target.path << "' already exists";
+    m_numFilesFailed += 1;
+  }
+  else
+  {
+    TEETIME_WARN() << "failed to copy '" << value.path << "' to '" << target.path << "'";
+    m_numFilesFailed += 1;
+  }
+}
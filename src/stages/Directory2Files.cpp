@@ -20,26 +20,210 @@
 #include <teetime/platform.h>
 
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 using namespace teetime;
 
+namespace
+{
+  //maximum number of discovered (but not yet sent) files, before scanning threads are paused.
+  const size_t MaxPendingFiles = 4096;
+
+  /**
+   * State shared by all threads of a parallel directory walk.
+   */
+  struct ParallelWalk
+  {
+    ParallelWalk()
+      : busy(0)
+      , stop(false)
+    {}
+
+    bool done() const
+    {
+      return directories.empty() && busy == 0;
+    }
+
+    std::mutex              mutex;
+    std::condition_variable directoriesCond;
+    std::condition_variable filesCond;
+    std::deque<std::string> directories; //directories not yet scanned
+    std::deque<std::string> files;       //files not yet sent
+    size_t                  busy;        //number of directories currently being scanned
+    bool                    stop;
+  };
+
+  void scanDirectories(ParallelWalk& walk)
+  {
+    std::unique_lock<std::mutex> lock(walk.mutex);
+
+    while (true)
+    {
+      walk.directoriesCond.wait(lock, [&]() {
+        return walk.stop || walk.done() || (!walk.directories.empty() && walk.files.size() < MaxPendingFiles);
+      });
+
+      if (walk.stop || walk.done())
+        break;
+
+      std::string directory = std::move(walk.directories.front());
+      walk.directories.pop_front();
+      walk.busy += 1;
+
+      lock.unlock();
+
+      std::vector<std::string> files;
+      std::vector<std::string> subDirectories;
+      if (!platform::listDirectory(directory, files, subDirectories))
+      {
+        TEETIME_DEBUG() << "failed to list directory: " << directory;
+      }
+
+      lock.lock();
+
+      for (auto& f : files)
+      {
+        walk.files.push_back(directory + "/" + f);
+      }
+
+      for (auto& d : subDirectories)
+      {
+        walk.directories.push_back(directory + "/" + d);
+      }
+
+      walk.busy -= 1;
+
+      walk.filesCond.notify_one();
+      walk.directoriesCond.notify_all();
+    }
+
+    walk.filesCond.notify_one();
+    walk.directoriesCond.notify_all();
+  }
+}
+
 Directory2Files::Directory2Files(const char* debugName)
   : AbstractFilterStage<std::string, File>(debugName)
+  , m_sorted(true)
+  , m_numThreads(1)
+{
+}
+
+Directory2Files::Directory2Files(bool sorted, size_t numThreads, const char* debugName)
+  : AbstractFilterStage<std::string, File>(debugName)
+  , m_sorted(sorted)
+  , m_numThreads(numThreads)
 {
 }
 
 void Directory2Files::execute(std::string&& value)
 {
-  std::vector<std::string> files;
-  platform::listFiles(value.c_str(), files, true);
+  if (!m_sorted && m_numThreads > 1)
+  {
+    walkParallel(value);
+  }
+  else
+  {
+    walkSequential(value);
+  }
+}
 
-  std::sort(files.begin(), files.end());
+void Directory2Files::walkSequential(const std::string& directory)
+{
+  std::vector<std::string> entries;
+  std::vector<std::string> subDirectories;
 
-  for (const auto& f : files)
+  if (!platform::listDirectory(directory, entries, subDirectories))
   {
-    File file;
-    file.path = value + "/" + f;
+    TEETIME_DEBUG() << "failed to list directory: " << directory;
+    return;
+  }
 
-    getOutputPort().send(std::move(file));
+  //directories are marked by a trailing '/'. This way sorting the entries of each directory
+  //results in the lexicographical order of all paths, without knowing the whole tree in advance.
+  for (auto& d : subDirectories)
+  {
+    entries.push_back(std::move(d) + "/");
+  }
+
+  if (m_sorted)
+  {
+    std::sort(entries.begin(), entries.end());
+  }
+
+  for (auto& e : entries)
+  {
+    if (isCanceled())
+      break;
+
+    if (e.back() == '/')
+    {
+      e.pop_back();
+      walkSequential(directory + "/" + e);
+    }
+    else
+    {
+      File file;
+      file.path = directory + "/" + e;
+
+      getOutputPort().send(std::move(file));
+    }
+  }
+}
+
+void Directory2Files::walkParallel(const std::string& directory)
+{
+  ParallelWalk walk;
+  walk.directories.push_back(directory);
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < m_numThreads; ++i)
+  {
+    threads.push_back(std::thread([&walk]() { scanDirectories(walk); }));
   }
-}
\ No newline at end of file
+
+  while (true)
+  {
+    std::deque<std::string> files;
+
+    {
+      std::unique_lock<std::mutex> lock(walk.mutex);
+      walk.filesCond.wait(lock, [&]() { return !walk.files.empty() || walk.done(); });
+
+      if (walk.files.empty())
+        break;
+
+      files.swap(walk.files);
+    }
+
+    walk.directoriesCond.notify_all();
+
+    for (auto& f : files)
+    {
+      if (isCanceled())
+        break;
+
+      File file;
+      file.path = std::move(f);
+
+      getOutputPort().send(std::move(file));
+    }
+
+    if (isCanceled())
+    {
+      std::lock_guard<std::mutex> lock(walk.mutex);
+      walk.stop = true;
+      break;
+    }
+  }
+
+  walk.directoriesCond.notify_all();
+
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+}
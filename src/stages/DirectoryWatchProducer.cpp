@@ -0,0 +1,320 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/DirectoryWatchProducer.h>
+#include <teetime/ports/OutputPort.h>
+#include <teetime/platform.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+using namespace teetime;
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  //upper bound of the time between two checks for cancellation
+  const int MaxPollMilliseconds = 50;
+
+  /**
+   * Recursively list a directory tree. 'onDirectory' is called before a directory is listed,
+   * 'onFile' for each file. Stops early, if 'canceled' returns true.
+   */
+  void scanDirectory(const std::string& directory,
+                     const std::function<void(const std::string&)>& onDirectory,
+                     const std::function<void(std::string&&)>& onFile,
+                     const std::function<bool()>& canceled)
+  {
+    onDirectory(directory);
+
+    std::vector<std::string> files;
+    std::vector<std::string> subDirectories;
+
+    if (!platform::listDirectory(directory, files, subDirectories))
+    {
+      TEETIME_DEBUG() << "failed to list directory: " << directory;
+      return;
+    }
+
+    for (auto& f : files)
+    {
+      if (canceled())
+        return;
+
+      onFile(directory + "/" + f);
+    }
+
+    for (const auto& d : subDirectories)
+    {
+      if (canceled())
+        return;
+
+      scanDirectory(directory + "/" + d, onDirectory, onFile, canceled);
+    }
+  }
+
+#ifdef __linux__
+  /**
+   * inotify watches of a directory tree, and files waiting for their debounce period to pass.
+   */
+  class InotifyWatch
+  {
+  public:
+    explicit InotifyWatch(unsigned debounceMilliseconds)
+      : m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+      , m_debounce(std::chrono::milliseconds(debounceMilliseconds))
+    {
+      if (m_fd == -1)
+      {
+        TEETIME_WARN() << "failed to initialize inotify: " << strerror(errno);
+      }
+    }
+
+    ~InotifyWatch()
+    {
+      if (m_fd != -1)
+      {
+        close(m_fd);
+      }
+    }
+
+    bool isValid() const
+    {
+      return m_fd != -1;
+    }
+
+    void addDirectory(const std::string& directory)
+    {
+      const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+      int wd = inotify_add_watch(m_fd, directory.c_str(), mask);
+      if (wd == -1)
+      {
+        TEETIME_WARN() << "failed to watch directory '" << directory << "': " << strerror(errno);
+        return;
+      }
+
+      m_directories[wd] = directory;
+    }
+
+    void addPending(std::string&& path)
+    {
+      m_pending[std::move(path)] = Clock::now() + m_debounce;
+    }
+
+    /**
+     * Restart the debounce period of a file, if it is pending (still being written).
+     */
+    void touchPending(const std::string& path)
+    {
+      auto it = m_pending.find(path);
+      if (it != m_pending.end())
+      {
+        it->second = Clock::now() + m_debounce;
+      }
+    }
+
+    /**
+     * Wait for events (at most 'MaxPollMilliseconds') and process them.
+     * @return false if events have been lost.
+     */
+    bool poll(const std::function<bool()>& canceled)
+    {
+      int timeout = MaxPollMilliseconds;
+      if (!m_pending.empty())
+      {
+        auto next = Clock::now() + std::chrono::milliseconds(MaxPollMilliseconds);
+        for (const auto& p : m_pending)
+        {
+          next = (std::min)(next, p.second);
+        }
+
+        auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next - Clock::now()).count();
+        timeout = static_cast<int>((std::max)(wait, decltype(wait)(0)));
+      }
+
+      struct pollfd pfd;
+      pfd.fd = m_fd;
+      pfd.events = POLLIN;
+      pfd.revents = 0;
+
+      if (::poll(&pfd, 1, timeout) <= 0)
+        return true;
+
+      alignas(struct inotify_event) char buffer[64 * 1024];
+      bool complete = true;
+
+      for (;;)
+      {
+        ssize_t n = read(m_fd, buffer, sizeof(buffer));
+        if (n <= 0)
+          break;
+
+        for (char* p = buffer; p < buffer + n; )
+        {
+          const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+          p += sizeof(struct inotify_event) + event->len;
+
+          if (event->mask & IN_Q_OVERFLOW)
+          {
+            complete = false;
+            continue;
+          }
+
+          auto it = m_directories.find(event->wd);
+          if (it == m_directories.end())
+            continue;
+
+          if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+          {
+            if (event->mask & IN_IGNORED)
+            {
+              m_directories.erase(it);
+            }
+            continue;
+          }
+
+          if (event->len == 0)
+            continue;
+
+          std::string path = it->second + "/" + event->name;
+
+          if (event->mask & IN_ISDIR)
+          {
+            if (event->mask & (IN_CREATE | IN_MOVED_TO))
+            {
+              //files might have been added before the watch was in place, so scan the new directory
+              scanDirectory(path,
+                [this](const std::string& d) { addDirectory(d); },
+                [this](std::string&& f) { addPending(std::move(f)); },
+                canceled);
+            }
+          }
+          else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+          {
+            addPending(std::move(path));
+          }
+          else if (event->mask & IN_MODIFY)
+          {
+            touchPending(path);
+          }
+        }
+      }
+
+      return complete;
+    }
+
+    /**
+     * Remove all files from the pending list, that had no events during the debounce period.
+     */
+    void takeReadyFiles(std::vector<std::string>& files)
+    {
+      const auto now = Clock::now();
+
+      for (auto it = m_pending.begin(); it != m_pending.end(); )
+      {
+        if (it->second <= now)
+        {
+          files.push_back(it->first);
+          it = m_pending.erase(it);
+        }
+        else
+        {
+          ++it;
+        }
+      }
+    }
+
+  private:
+    int                                                m_fd;
+    Clock::duration                                    m_debounce;
+    std::unordered_map<int, std::string>               m_directories; //watch descriptor -> path
+    std::unordered_map<std::string, Clock::time_point> m_pending;     //file -> time it gets ready
+  };
+#endif
+}
+
+DirectoryWatchProducer::DirectoryWatchProducer(const std::string& directory, unsigned debounceMilliseconds, const char* debugName)
+  : AbstractProducerStage<File>(debugName)
+  , m_directory(directory)
+  , m_debounceMilliseconds(debounceMilliseconds)
+{
+}
+
+void DirectoryWatchProducer::execute()
+{
+  auto canceled = [this]() { return isCanceled(); };
+  auto send = [this](std::string&& path) { getOutputPort().send(File(path)); };
+
+#ifdef __linux__
+  InotifyWatch watch(m_debounceMilliseconds);
+
+  if (watch.isValid())
+  {
+    auto scan = [&]() {
+      scanDirectory(m_directory,
+        [&](const std::string& d) { watch.addDirectory(d); },
+        [&](std::string&& f) { watch.addPending(std::move(f)); },
+        canceled);
+    };
+
+    //watches are added before a directory is listed, so no file gets lost in between.
+    //Listed files are debounced like events: files still being written are sent once they have been closed,
+    //and files seen by both the listing and an event are sent only once.
+    scan();
+
+    std::vector<std::string> ready;
+
+    while (!isCanceled())
+    {
+      if (!watch.poll(canceled))
+      {
+        TEETIME_WARN() << "inotify queue overflow, rescanning directory: " << m_directory;
+        scan();
+      }
+
+      ready.clear();
+      watch.takeReadyFiles(ready);
+
+      for (auto& path : ready)
+      {
+        if (isCanceled())
+          break;
+
+        send(std::move(path));
+      }
+    }
+
+    terminate();
+    return;
+  }
+#else
+  TEETIME_WARN() << "watching directories is not supported on this platform, only the initial scan is done";
+#endif
+
+  scanDirectory(m_directory, [](const std::string&) {}, send, canceled);
+  terminate();
+}
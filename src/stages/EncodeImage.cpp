@@ -0,0 +1,76 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/EncodeImage.h>
+#include <teetime/ports/OutputPort.h>
+
+using namespace teetime;
+
+namespace
+{
+  const char* extension(ImageFileFormat format)
+  {
+    switch (format)
+    {
+    case ImageFileFormat::Png:
+      return ".png";
+    case ImageFileFormat::Tga:
+      return ".tga";
+    case ImageFileFormat::Bmp:
+      return ".bmp";
+    case ImageFileFormat::Qoi:
+      return ".qoi";
+    default:
+      return "";
+    }
+  }
+
+  std::string replaceExtension(const std::string& filename, const char* ext)
+  {
+    const size_t dot = filename.find_last_of('.');
+    const size_t slash = filename.find_last_of("/\\");
+
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+      return filename + ext;
+
+    return filename.substr(0, dot) + ext;
+  }
+}
+
+EncodeImage::EncodeImage(ImageFileFormat format, const char* debugName)
+  : AbstractFilterStage<Image, FileBuffer>(debugName)
+  , m_format(format)
+{
+}
+
+void EncodeImage::setRecyclingPool(shared_ptr<FileBufferPool> pool)
+{
+  m_pool = std::move(pool);
+}
+
+void EncodeImage::execute(Image&& image)
+{
+  FileBuffer buffer;
+  if (m_pool)
+  {
+    m_pool->take(buffer.bytes);
+  }
+
+  if (!image.saveToMemory(m_format, buffer.bytes))
+    return;
+
+  buffer.path = replaceExtension(image.getFilename(), extension(m_format));
+  getOutputPort().send(std::move(buffer));
+}
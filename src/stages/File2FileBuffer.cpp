@@ -18,9 +18,7 @@
 #include <teetime/ports/OutputPort.h>
 #include <teetime/FileBuffer.h>
 #include <teetime/File.h>
-
-#include <fstream>
-#include <limits>
+#include <teetime/platform.h>
 
 using namespace teetime;
 
@@ -29,32 +27,32 @@ File2FileBuffer::File2FileBuffer(const char* debugName)
 {
 }
 
+void File2FileBuffer::setRecyclingPool(shared_ptr<FileBufferPool> pool)
+{
+  m_pool = std::move(pool);
+}
+
 void File2FileBuffer::execute(File&& value)
 {
-  std::ifstream file(value.path, std::ios::binary | std::ios::ate);
-  std::streamsize size = file.tellg();
+  FileBuffer buffer;
+  buffer.path = value.path;
 
-  assert(size >= 0);
-  if (static_cast<size_t>(size) > std::numeric_limits<size_t>::max())
+  if (m_pool)
   {
-    TEETIME_ERROR() << "file too big: " << value.path;
-    return;
+    m_pool->take(buffer.bytes);
   }
 
-  file.seekg(0, std::ios::beg);
+  if (platform::readWholeFile(value.path, buffer.bytes))
+  {
+    getOutputPort().send(std::move(buffer));
+  }
+  else
+  {
+    TEETIME_DEBUG() << "failed to read file: " << value.path;
 
-  FileBuffer buffer;
-  buffer.path = value.path;
-  buffer.bytes.resize(static_cast<size_t>(size));
-
-  //don't try to read if size is 0 anyway (because buffer.bytes.data() may return null in this case)
-	if (size == 0 || file.read((char*)buffer.bytes.data(), size))
-	{
-		getOutputPort().send(std::move(buffer));
-	}
-	else
-	{
-		TEETIME_DEBUG() << "failed to read file: " << value.path;
-	}
-
-}
\ No newline at end of file
+    if (m_pool)
+    {
+      m_pool->recycle(std::move(buffer.bytes));
+    }
+  }
+}
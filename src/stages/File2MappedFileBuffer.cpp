@@ -0,0 +1,40 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/File2MappedFileBuffer.h>
+#include <teetime/ports/OutputPort.h>
+#include <teetime/MappedFileBuffer.h>
+#include <teetime/File.h>
+
+using namespace teetime;
+
+File2MappedFileBuffer::File2MappedFileBuffer(const char* debugName)
+  : AbstractFilterStage<File, MappedFileBuffer>(debugName)
+{
+}
+
+void File2MappedFileBuffer::execute(File&& value)
+{
+  MappedFileBuffer buffer;
+
+  if (buffer.map(value.path))
+  {
+    getOutputPort().send(std::move(buffer));
+  }
+  else
+  {
+    TEETIME_DEBUG() << "failed to map file: " << value.path;
+  }
+}
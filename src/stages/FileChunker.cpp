@@ -0,0 +1,104 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/FileChunker.h>
+#include <teetime/ports/OutputPort.h>
+#include <teetime/platform.h>
+#include <algorithm>
+
+using namespace teetime;
+
+FileChunker::FileChunker(size_t chunkSize, const char* debugName)
+  : AbstractFilterStage<File, FileChunk>(debugName)
+  , m_chunkSize(std::max<size_t>(chunkSize, 1))
+  , m_useDelimiter(false)
+  , m_delimiter(0)
+{
+}
+
+void FileChunker::setDelimiter(uint8 delimiter)
+{
+  m_useDelimiter = true;
+  m_delimiter = delimiter;
+}
+
+void FileChunker::setRecyclingPool(shared_ptr<FileBufferPool> pool)
+{
+  m_pool = std::move(pool);
+}
+
+void FileChunker::execute(File&& value)
+{
+  uint64 fileSize = 0;
+  platform::FileHandle file = platform::openFile(value.path.c_str(), fileSize);
+
+  if (file == platform::InvalidFileHandle)
+  {
+    TEETIME_DEBUG() << "failed to open file: " << value.path;
+    return;
+  }
+
+  uint64 offset = 0;
+
+  while (!isCanceled())
+  {
+    const size_t size = static_cast<size_t>(std::min<uint64>(m_chunkSize, fileSize - offset));
+
+    //let the OS read the next chunk, while this one is processed downstream
+    if (offset + size < fileSize)
+    {
+      platform::prefetchFile(file, offset + size, m_chunkSize);
+    }
+
+    FileChunk chunk;
+    chunk.path = value.path;
+    chunk.offset = offset;
+
+    if (m_pool)
+    {
+      m_pool->take(chunk.bytes);
+    }
+
+    chunk.bytes.resize(size);
+
+    //don't try to read if size is 0 (because chunk.bytes.data() may return null in this case)
+    if (size > 0 && platform::readFile(file, offset, chunk.bytes.data(), size) != size)
+    {
+      TEETIME_DEBUG() << "failed to read file: " << value.path;
+      break;
+    }
+
+    if (m_useDelimiter && offset + size < fileSize)
+    {
+      auto it = std::find(chunk.bytes.rbegin(), chunk.bytes.rend(), m_delimiter);
+      if (it != chunk.bytes.rend())
+      {
+        //cut chunk right after delimiter, the remaining bytes are read again as part of the next chunk
+        chunk.bytes.resize(static_cast<size_t>(chunk.bytes.rend() - it));
+      }
+    }
+
+    offset += chunk.bytes.size();
+    chunk.last = (offset == fileSize);
+
+    const bool last = chunk.last;
+    getOutputPort().send(std::move(chunk));
+
+    if (last)
+      break;
+  }
+
+  platform::closeFile(file);
+}
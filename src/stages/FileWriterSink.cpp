@@ -0,0 +1,318 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/FileWriterSink.h>
+#include <teetime/ports/InputPort.h>
+#include <teetime/Runnable.h>
+#include <teetime/Optional.h>
+#include <teetime/platform.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace teetime;
+
+namespace
+{
+  //maximum number of batches waiting for the writer thread
+  const size_t MaxPendingBatches = 2;
+
+  //partial batches are handed to the writer thread after this time (microseconds)
+  const uint64 MaxBatchDelay = 10000;
+
+  size_t alignUp(size_t size)
+  {
+    return (size + platform::DirectIOAlignment - 1) / platform::DirectIOAlignment * platform::DirectIOAlignment;
+  }
+}
+
+FileWriterSink::FileWriterSink(size_t batchSize, const char* debugName)
+  : AbstractStage(debugName)
+  , m_inputPort(nullptr)
+  , m_batchSize(alignUp(std::max<size_t>(batchSize, 1)))
+  , m_directIO(false)
+  , m_sync(false)
+  , m_batchBytes(0)
+  , m_batchStart(0)
+  , m_stopping(false)
+  , m_numFilesWritten(0)
+  , m_numFilesFailed(0)
+  , m_numBatches(0)
+{
+  m_inputPort = addNewInputPort<FileBuffer>();
+}
+
+FileWriterSink::~FileWriterSink()
+{
+  stopThread();
+}
+
+InputPort<FileBuffer>& FileWriterSink::getInputPort()
+{
+  return *m_inputPort;
+}
+
+void FileWriterSink::setDirectIO(bool enabled)
+{
+  m_directIO = enabled;
+}
+
+void FileWriterSink::setSync(bool enabled)
+{
+  m_sync = enabled;
+}
+
+void FileWriterSink::setRecyclingPool(shared_ptr<FileBufferPool> pool)
+{
+  m_pool = std::move(pool);
+}
+
+size_t FileWriterSink::numFilesWritten() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_numFilesWritten;
+}
+
+size_t FileWriterSink::numFilesFailed() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_numFilesFailed;
+}
+
+size_t FileWriterSink::numBatches() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_numBatches;
+}
+
+unique_ptr<Runnable> FileWriterSink::createRunnable()
+{
+  return unique_ptr<Runnable>(new ConsumerStageRunnable(this));
+}
+
+void FileWriterSink::startThread()
+{
+  assert(!m_thread.joinable());
+  m_thread = std::thread([this]() { writerThread(); });
+}
+
+void FileWriterSink::stopThread()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+
+  m_cond.notify_all();
+
+  if (m_thread.joinable())
+  {
+    m_thread.join();
+  }
+}
+
+bool FileWriterSink::submitBatch(bool wait)
+{
+  if (m_batch.empty())
+    return true;
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (m_batches.size() >= MaxPendingBatches)
+    {
+      if (!wait)
+        return false;
+
+      m_cond.wait(lock);
+    }
+
+    m_batches.push_back(std::move(m_batch));
+    m_numBatches += 1;
+  }
+
+  m_cond.notify_all();
+
+  m_batch.clear();
+  m_batchBytes = 0;
+  return true;
+}
+
+bool FileWriterSink::writeFile(const FileBuffer& buffer, uint8* staging, std::vector<std::pair<platform::FileHandle, const FileBuffer*>>& openFiles)
+{
+  const platform::FileHandle file = platform::createFile(buffer.path.c_str(), staging != nullptr);
+  if (file == platform::InvalidFileHandle)
+  {
+    TEETIME_DEBUG() << "failed to create file: " << buffer.path;
+    return false;
+  }
+
+  const size_t size = buffer.bytes.size();
+  bool success = true;
+
+  if (staging)
+  {
+    //direct I/O: copy content into aligned staging buffer and write whole blocks,
+    //the padding of the last block is truncated afterwards.
+    for (size_t offset = 0; offset < size && success; offset += m_batchSize)
+    {
+      const size_t n = std::min(m_batchSize, size - offset);
+      const size_t aligned = alignUp(n);
+
+      std::memcpy(staging, buffer.bytes.data() + offset, n);
+      std::memset(staging + n, 0, aligned - n);
+
+      success = (platform::writeFile(file, offset, staging, aligned) == aligned);
+    }
+
+    success = success && platform::resizeFile(file, size);
+  }
+  else if (size > 0)
+  {
+    success = (platform::writeFile(file, 0, buffer.bytes.data(), size) == size);
+  }
+
+  if (!success)
+  {
+    TEETIME_DEBUG() << "failed to write file: " << buffer.path;
+  }
+
+  if (m_sync && success)
+  {
+    //sync later, together with all other files of this batch
+    openFiles.push_back(std::make_pair(file, &buffer));
+  }
+  else
+  {
+    platform::closeFile(file);
+  }
+
+  return success;
+}
+
+void FileWriterSink::writerThread()
+{
+  uint8* staging = nullptr;
+  if (m_directIO)
+  {
+    staging = static_cast<uint8*>(platform::aligned_malloc(m_batchSize, platform::DirectIOAlignment));
+  }
+
+  std::vector<std::pair<platform::FileHandle, const FileBuffer*>> openFiles;
+
+  while (true)
+  {
+    std::vector<FileBuffer> batch;
+
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (m_batches.empty() && !m_stopping)
+      {
+        m_cond.wait(lock);
+      }
+
+      if (m_batches.empty())
+        break;
+
+      batch = std::move(m_batches.front());
+      m_batches.pop_front();
+    }
+
+    m_cond.notify_all();
+
+    size_t written = 0;
+    size_t failed = 0;
+
+    for (auto& buffer : batch)
+    {
+      if (writeFile(buffer, staging, openFiles))
+        written += 1;
+      else
+        failed += 1;
+    }
+
+    //with sync enabled, a file only counts as written once it is on the storage device
+    for (const auto& f : openFiles)
+    {
+      if (!platform::syncFile(f.first))
+      {
+        TEETIME_WARN() << "failed to sync file: " << f.second->path;
+        written -= 1;
+        failed += 1;
+      }
+
+      platform::closeFile(f.first);
+    }
+
+    openFiles.clear();
+
+    if (m_pool)
+    {
+      for (auto& buffer : batch)
+      {
+        m_pool->recycle(std::move(buffer.bytes));
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_numFilesWritten += written;
+    m_numFilesFailed += failed;
+  }
+
+  platform::aligned_free(staging);
+}
+
+void FileWriterSink::execute()
+{
+  if (!m_thread.joinable())
+  {
+    startThread();
+  }
+
+  auto v = m_inputPort->receive();
+  if (v)
+  {
+    if (!isCanceled())
+    {
+      if (m_batch.empty())
+      {
+        m_batchStart = platform::microSeconds();
+      }
+
+      m_batchBytes += (*v).bytes.size();
+      m_batch.push_back(std::move(*v));
+
+      if (m_batchBytes >= m_batchSize)
+      {
+        submitBatch(true);
+      }
+    }
+  }
+  else if (m_inputPort->isClosed())
+  {
+    submitBatch(true);
+    stopThread();
+    terminate();
+  }
+  else
+  {
+    //don't let the writer thread wait for a full batch forever, but keep collecting while
+    //the batch is young or the writer thread is busy anyway
+    if (!m_batch.empty() && platform::microSeconds() - m_batchStart >= MaxBatchDelay)
+    {
+      submitBatch(false);
+    }
+
+    std::this_thread::yield();
+  }
+}
@@ -0,0 +1,51 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/GatherImage.h>
+#include <teetime/ports/OutputPort.h>
+
+using namespace teetime;
+
+GatherImage::GatherImage(const char* debugName)
+  : AbstractFilterStage<ImageTile, Image>(debugName)
+{
+}
+
+void GatherImage::execute(ImageTile&& value)
+{
+  assert(value.target);
+  assert(value.count > 0);
+
+  if (value.count > 1)
+  {
+    auto it = m_missingTiles.find(value.target.get());
+    if (it == m_missingTiles.end())
+    {
+      m_missingTiles[value.target.get()] = value.count - 1;
+      return;
+    }
+
+    if (--it->second > 0)
+      return;
+
+    m_missingTiles.erase(it);
+  }
+
+  //last tile: nobody else writes to the target image anymore, so its pixels can be moved out
+  shared_ptr<Image> target = std::move(value.target);
+  value.source.reset();
+
+  getOutputPort().send(std::move(*target));
+}
@@ -0,0 +1,141 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/ImageFilterStages.h>
+#include <teetime/ports/OutputPort.h>
+#include <teetime/ImageFilters.h>
+#include <cmath>
+
+using namespace teetime;
+
+AbstractPlanarFilterStage::AbstractPlanarFilterStage(const char* debugName)
+  : AbstractFilterStage<Image, Image>(debugName)
+{
+}
+
+void AbstractPlanarFilterStage::execute(Image&& image)
+{
+  m_source.deinterleave(image);
+  apply(m_source, m_target);
+  m_target.interleave(image);
+
+  getOutputPort().send(std::move(image));
+}
+
+GrayscaleStage::GrayscaleStage(const char* debugName)
+  : AbstractPlanarFilterStage(debugName)
+{
+}
+
+void GrayscaleStage::apply(const PlanarImage& src, PlanarImage& dst)
+{
+  grayscale(src, dst);
+}
+
+GaussianBlurStage::GaussianBlurStage(float sigma, const char* debugName)
+  : AbstractPlanarFilterStage(debugName)
+  , m_sigma(sigma)
+{
+  assert(sigma > 0);
+}
+
+void GaussianBlurStage::apply(const PlanarImage& src, PlanarImage& dst)
+{
+  gaussianBlur(src, dst, m_sigma);
+}
+
+SharpenStage::SharpenStage(float sigma, float amount, const char* debugName)
+  : AbstractPlanarFilterStage(debugName)
+  , m_sigma(sigma)
+  , m_amount(amount)
+{
+  assert(sigma > 0);
+}
+
+void SharpenStage::apply(const PlanarImage& src, PlanarImage& dst)
+{
+  sharpen(src, dst, m_sigma, m_amount);
+}
+
+AbstractPlanarTileFilterStage::AbstractPlanarTileFilterStage(const char* debugName)
+  : AbstractFilterStage<ImageTile, ImageTile>(debugName)
+{
+}
+
+void AbstractPlanarTileFilterStage::execute(ImageTile&& tile)
+{
+  assert(tile.source->getFormat() == tile.target->getFormat());
+  assert(tile.source->getWidth() == tile.target->getWidth() && tile.source->getHeight() == tile.target->getHeight());
+
+  m_source.deinterleave(*tile.source, tile.sourceX, tile.sourceY, tile.sourceWidth, tile.sourceHeight);
+  apply(m_source, m_target);
+  m_target.interleave(*tile.target, tile.x - tile.sourceX, tile.y - tile.sourceY, tile.width, tile.height, tile.x, tile.y);
+
+  getOutputPort().send(std::move(tile));
+}
+
+GaussianBlurTileStage::GaussianBlurTileStage(float sigma, const char* debugName)
+  : AbstractPlanarTileFilterStage(debugName)
+  , m_sigma(sigma)
+{
+  assert(sigma > 0);
+}
+
+void GaussianBlurTileStage::apply(const PlanarImage& src, PlanarImage& dst)
+{
+  gaussianBlur(src, dst, m_sigma);
+}
+
+SharpenTileStage::SharpenTileStage(float sigma, float amount, const char* debugName)
+  : AbstractPlanarTileFilterStage(debugName)
+  , m_sigma(sigma)
+  , m_amount(amount)
+{
+  assert(sigma > 0);
+}
+
+void SharpenTileStage::apply(const PlanarImage& src, PlanarImage& dst)
+{
+  sharpen(src, dst, m_sigma, m_amount);
+}
+
+GammaStage::GammaStage(float gamma, const char* debugName)
+  : AbstractFilterStage<Image, Image>(debugName)
+{
+  assert(gamma > 0);
+
+  for (int i = 0; i < 256; ++i)
+  {
+    m_table[i] = static_cast<uint8>(std::pow(i / 255.0f, 1.0f / gamma) * 255.0f + 0.5f);
+  }
+}
+
+void GammaStage::execute(Image&& image)
+{
+  const unsigned channels = image.getChannels();
+  const unsigned colorChannels = hasAlpha(image.getFormat()) ? channels - 1 : channels;
+  const size_t count = image.getWidth() * image.getHeight();
+
+  uint8* p = image.getPixels();
+  for (size_t i = 0; i < count; ++i, p += channels)
+  {
+    for (unsigned c = 0; c < colorChannels; ++c)
+    {
+      p[c] = m_table[p[c]];
+    }
+  }
+
+  getOutputPort().send(std::move(image));
+}
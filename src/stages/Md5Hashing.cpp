@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 #include <teetime/Md5Hash.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/MappedFileBuffer.h>
 #include <vector>
 
 namespace teetime
@@ -42,4 +44,14 @@ namespace teetime
   {
     return Md5Hash::generate(bytes.data(), bytes.size());
   }
+
+  Md5Hash md5hash(const FileBuffer& buffer)
+  {
+    return Md5Hash::generate(buffer.bytes.data(), buffer.bytes.size());
+  }
+
+  Md5Hash md5hash(const MappedFileBuffer& buffer)
+  {
+    return Md5Hash::generate(buffer.data(), buffer.size());
+  }
 }
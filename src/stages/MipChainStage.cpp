@@ -0,0 +1,82 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/MipChainStage.h>
+#include <teetime/ports/OutputPort.h>
+#include <teetime/ImageKernels.h>
+
+using namespace teetime;
+
+MipChainStage::MipChainStage(unsigned maxLevels, const char* debugName)
+  : AbstractConsumerStage<Image>(debugName)
+  , m_maxLevels(maxLevels)
+  , m_outputPort(nullptr)
+{
+}
+
+OutputPort<MipLevel>& MipChainStage::getOutputPort()
+{
+  if (!m_outputPort)
+  {
+    m_outputPort = addNewOutputPort<MipLevel>();
+  }
+
+  assert(m_outputPort);
+  return *m_outputPort;
+}
+
+OutputPort<MipLevel>& MipChainStage::getLevelOutputPort(unsigned level)
+{
+  assert(level > 0);
+
+  if (m_levelOutputPorts.size() <= level)
+  {
+    m_levelOutputPorts.resize(level + 1, nullptr);
+  }
+
+  if (!m_levelOutputPorts[level])
+  {
+    m_levelOutputPorts[level] = addNewOutputPort<MipLevel>();
+  }
+
+  assert(m_levelOutputPorts[level]);
+  return *m_levelOutputPorts[level];
+}
+
+void MipChainStage::execute(Image&& value)
+{
+  createMipChain(value, m_levels, m_maxLevels);
+
+  for (size_t i = 0; i < m_levels.size(); ++i)
+  {
+    const unsigned level = static_cast<unsigned>(i + 1);
+
+    OutputPort<MipLevel>* port = m_outputPort;
+    if (level < m_levelOutputPorts.size() && m_levelOutputPorts[level])
+    {
+      port = m_levelOutputPorts[level];
+    }
+
+    if (!port)
+      continue;
+
+    MipLevel mipLevel;
+    mipLevel.image = std::move(m_levels[i]);
+    mipLevel.level = level;
+    mipLevel.filename = value.getFilename();
+
+    port->send(std::move(mipLevel));
+  }
+}
@@ -34,7 +34,7 @@ namespace teetime
     std::mt19937                        generator(0); //TODO(johl): currently using 0 as seed (instead of rand_dev) for reproducable results. This should be adjustable.
     std::uniform_int_distribution<int>  distr(m_min, m_max);
 
-    for (unsigned i = 0; i < m_num; ++i)
+    for (unsigned i = 0; i < m_num && !isCanceled(); ++i)
     {
       int value = distr(generator);
       TEETIME_TRACE() << "random value produced: " << value;
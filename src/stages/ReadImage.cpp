@@ -19,24 +19,77 @@
 
 namespace teetime
 {
-  ReadImage::ReadImage(const char* debugName)
-    : AbstractConsumerStage(debugName)
+  static bool loadImage(Image& image, const FileBuffer& buffer, unsigned scale, bool nativeFormat)
+  {
+    return image.loadFromMemory(buffer.bytes.data(), buffer.bytes.size(), buffer.path.c_str(), scale, nativeFormat);
+  }
+
+  static bool loadImage(Image& image, const MappedFileBuffer& buffer, unsigned scale, bool nativeFormat)
+  {
+    return image.loadFromMemory(buffer.data(), buffer.size(), buffer.path.c_str(), scale, nativeFormat);
+  }
+
+  static void recycle(FileBufferPool& pool, FileBuffer& buffer)
+  {
+    pool.recycle(std::move(buffer.bytes));
+  }
+
+  static void recycle(FileBufferPool&, MappedFileBuffer&)
+  {
+  }
+
+  template<typename TBuffer>
+  BasicReadImage<TBuffer>::BasicReadImage(const char* debugName)
+    : AbstractConsumerStage<TBuffer>(debugName)
     , m_outputPort(nullptr)
+    , m_scale(1)
+    , m_nativeFormat(false)
   {
-    m_outputPort = AbstractConsumerStage::addNewOutputPort<Image>();
+    m_outputPort = AbstractConsumerStage<TBuffer>::template addNewOutputPort<Image>();
   }
 
-  OutputPort<Image>& ReadImage::getOutputPort()
+  template<typename TBuffer>
+  OutputPort<Image>& BasicReadImage<TBuffer>::getOutputPort()
   {
     return *m_outputPort;
   }
 
-  void ReadImage::execute(FileBuffer&& buffer)
+  template<typename TBuffer>
+  void BasicReadImage<TBuffer>::setRecyclingPool(shared_ptr<FileBufferPool> pool)
+  {
+    m_pool = std::move(pool);
+  }
+
+  template<typename TBuffer>
+  void BasicReadImage<TBuffer>::setScale(unsigned scale)
+  {
+    assert(scale == 1 || scale == 2 || scale == 4 || scale == 8);
+    m_scale = scale;
+  }
+
+  template<typename TBuffer>
+  void BasicReadImage<TBuffer>::setNativeFormat(bool nativeFormat)
+  {
+    m_nativeFormat = nativeFormat;
+  }
+
+  template<typename TBuffer>
+  void BasicReadImage<TBuffer>::execute(TBuffer&& buffer)
   {
     Image image;
-    if (image.loadFromMemory(buffer.bytes.data(), buffer.bytes.size(), buffer.path.c_str()))
+    const bool loaded = loadImage(image, buffer, m_scale, m_nativeFormat);
+
+    if (m_pool)
+    {
+      recycle(*m_pool, buffer);
+    }
+
+    if (loaded)
     {
       m_outputPort->send(std::move(image));
     }
   }
+
+  template class BasicReadImage<FileBuffer>;
+  template class BasicReadImage<MappedFileBuffer>;
 }
\ No newline at end of file
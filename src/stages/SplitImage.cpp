@@ -0,0 +1,39 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <teetime/stages/SplitImage.h>
+#include <teetime/ports/OutputPort.h>
+
+using namespace teetime;
+
+SplitImage::SplitImage(size_t tileSize, size_t halo, ImageTileTarget mode, const char* debugName)
+  : AbstractFilterStage<Image, ImageTile>(debugName)
+  , m_tileSize(tileSize)
+  , m_halo(halo)
+  , m_mode(mode)
+{
+  assert(m_tileSize > 0);
+}
+
+void SplitImage::execute(Image&& value)
+{
+  //pixels are moved, not copied
+  auto source = std::make_shared<const Image>(std::move(value));
+
+  for (auto& tile : createImageTiles(source, m_tileSize, m_halo, m_mode))
+  {
+    getOutputPort().send(std::move(tile));
+  }
+}
@@ -0,0 +1,182 @@
+/**
+ * Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/DistributorStage.h>
+#include <teetime/stages/MergerStage.h>
+#include <teetime/stages/FunctionStage.h>
+#include "stages/IntProducerStage.h"
+#include "stages/IntConsumerStage.h"
+#include <climits>
+#include <thread>
+#include <chrono>
+
+using namespace teetime;
+using namespace teetime::test;
+
+namespace
+{
+  class LimitStage : public AbstractConsumerStage<int>
+  {
+  public:
+    explicit LimitStage(size_t limit)
+      : AbstractConsumerStage<int>("LimitStage")
+      , m_limit(limit)
+    {
+    }
+
+    std::vector<int> valuesConsumed;
+
+  private:
+    virtual void execute(int&& value) override
+    {
+      valuesConsumed.push_back(value);
+
+      if (valuesConsumed.size() == m_limit)
+      {
+        cancel();
+      }
+    }
+
+    size_t m_limit;
+  };
+
+  class CancelTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<IntProducerStage> producer;
+    shared_ptr<LimitStage> limit;
+
+    explicit CancelTestConfig(bool multithreaded)
+    {
+      producer = createStage<IntProducerStage>();
+      limit = createStage<LimitStage>(10);
+
+      declareStageActive(producer);
+
+      if (multithreaded)
+      {
+        declareStageActive(limit);
+      }
+
+      connectPorts(producer->getOutputPort(), limit->getInputPort());
+    }
+  };
+
+  class CancelFarmTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<IntProducerStage> producer;
+    shared_ptr<LimitStage> limit;
+
+    explicit CancelFarmTestConfig(unsigned numWorkers)
+    {
+      producer = createStage<IntProducerStage>();
+      auto distributor = createStage<DistributorStage<int>>();
+      auto merger = createStage<MergerStage<int>>();
+      limit = createStage<LimitStage>(10);
+
+      declareStageActive(producer);
+      declareStageActive(merger);
+
+      connectPorts(producer->getOutputPort(), distributor->getInputPort());
+
+      for (unsigned i = 0; i < numWorkers; ++i)
+      {
+        auto worker = createStageFromLambda([](int value) { return value * 2; });
+        declareStageActive(worker);
+
+        connectPorts(distributor->getNewOutputPort(), worker->getInputPort());
+        connectPorts(worker->getOutputPort(), merger->getNewInputPort());
+      }
+
+      connectPorts(merger->getOutputPort(), limit->getInputPort());
+    }
+  };
+
+  class CancelFromOutsideTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<IntProducerStage> producer;
+    shared_ptr<IntConsumerStage> consumer;
+
+    CancelFromOutsideTestConfig()
+    {
+      producer = createStage<IntProducerStage>();
+      consumer = createStage<IntConsumerStage>();
+
+      declareStageActive(producer);
+      declareStageActive(consumer);
+
+      connectPorts(producer->getOutputPort(), consumer->getInputPort());
+    }
+  };
+}
+
+TEST(CancelTest, singlethreaded)
+{
+  CancelTestConfig config(false);
+  config.producer->numValues = INT_MAX;
+
+  config.executeBlocking();
+
+  ASSERT_EQ((size_t)10, config.limit->valuesConsumed.size());
+  EXPECT_EQ(0, config.limit->valuesConsumed[0]);
+  EXPECT_EQ(9, config.limit->valuesConsumed[9]);
+  EXPECT_TRUE(config.producer->isCanceled());
+}
+
+TEST(CancelTest, multithreaded)
+{
+  CancelTestConfig config(true);
+  config.producer->numValues = INT_MAX;
+
+  config.executeBlocking();
+
+  ASSERT_EQ((size_t)10, config.limit->valuesConsumed.size());
+  EXPECT_EQ(0, config.limit->valuesConsumed[0]);
+  EXPECT_EQ(9, config.limit->valuesConsumed[9]);
+  EXPECT_TRUE(config.producer->isCanceled());
+}
+
+TEST(CancelTest, farm)
+{
+  CancelFarmTestConfig config(4);
+  config.producer->numValues = INT_MAX;
+
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)10, config.limit->valuesConsumed.size());
+  EXPECT_TRUE(config.producer->isCanceled());
+}
+
+TEST(CancelTest, configuration)
+{
+  CancelFromOutsideTestConfig config;
+  config.producer->numValues = INT_MAX;
+
+  std::thread t([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    config.cancel();
+  });
+
+  config.executeBlocking();
+  t.join();
+
+  EXPECT_TRUE(config.producer->isCanceled());
+  EXPECT_TRUE(config.consumer->isCanceled());
+  EXPECT_LT(config.consumer->valuesConsumed.size(), (size_t)INT_MAX);
+}
@@ -17,6 +17,9 @@
 #include <teetime/Configuration.h>
 #include "stages/IntProducerStage.h"
 #include "stages/IntConsumerStage.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 using namespace teetime;
 using namespace teetime::test;
@@ -91,6 +94,41 @@ TEST(ConfigurationTest, simple2)
   EXPECT_EQ(104, config.consumer->valuesConsumed[4]);
 }
 
+namespace
+{
+  class ByteCapacityTestConfiguration : public Configuration
+  {
+  public:
+    shared_ptr<IntProducerStage> producer;
+    shared_ptr<IntConsumerStage> consumer;
+
+    ByteCapacityTestConfiguration()
+    {
+      producer = createStage<IntProducerStage>();
+      consumer = createStage<IntConsumerStage>();
+
+      declareStageActive(producer);
+      declareStageActive(consumer);
+
+      connectPorts(producer->getOutputPort(), consumer->getInputPort(), 1024, 2, [](const int&) { return size_t(1); });
+    }
+  };
+}
+
+TEST(ConfigurationTest, byteCapacity)
+{
+  ByteCapacityTestConfiguration config;
+  config.producer->numValues = 100;
+  config.producer->startValue = 0;
+
+  config.executeBlocking();
+
+  ASSERT_EQ((size_t)100, config.consumer->valuesConsumed.size());
+  for (int i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(i, config.consumer->valuesConsumed[i]);
+  }
+}
 
 namespace
 {
@@ -194,4 +232,240 @@ TEST(ConfigurationTest, DISABLED_loop)
 
   ASSERT_EQ((size_t)1, config.consumer->valuesConsumed.size());
   EXPECT_EQ(0, config.consumer->valuesConsumed[0]);
-}
\ No newline at end of file
+}
+namespace
+{
+  class FanOutFanInConfiguration : public Configuration
+  {
+  public:
+    shared_ptr<IntProducerStage> producer;
+    shared_ptr<IntConsumerStage> consumer;
+
+    FanOutFanInConfiguration(unsigned numWorkers, size_t fanOut)
+    {
+      producer = createStage<IntProducerStage>();
+      consumer = createStage<IntConsumerStage>();
+
+      declareStageActive(producer);
+      declareStageActive(consumer);
+
+      std::vector<InputPort<int>*> workerInputs;
+      std::vector<OutputPort<int>*> workerOutputs;
+
+      for (unsigned i = 0; i < numWorkers; ++i)
+      {
+        auto worker = createStage<TestProcessingStage>();
+        declareStageActive(worker);
+
+        workerInputs.push_back(&worker->getInputPort());
+        workerOutputs.push_back(&worker->getOutputPort());
+      }
+
+      connectPortsFanOut(producer->getOutputPort(), workerInputs, fanOut);
+      connectPortsFanIn(workerOutputs, consumer->getInputPort(), fanOut);
+    }
+  };
+}
+
+TEST(ConfigurationTest, fanOutFanIn)
+{
+  FanOutFanInConfiguration config(20, 3);
+  config.producer->numValues = 1000;
+  config.producer->startValue = 1;
+
+  config.executeBlocking();
+
+  auto values = config.consumer->valuesConsumed;
+  ASSERT_EQ((size_t)1000, values.size());
+
+  std::sort(values.begin(), values.end());
+  for (int i = 0; i < 1000; ++i)
+  {
+    EXPECT_EQ(i, values[i]);
+  }
+}
+
+TEST(ConfigurationTest, fanOutFanInSingleWorker)
+{
+  FanOutFanInConfiguration config(1, 8);
+  config.producer->numValues = 10;
+  config.producer->startValue = 1;
+
+  config.executeBlocking();
+
+  ASSERT_EQ((size_t)10, config.consumer->valuesConsumed.size());
+  EXPECT_EQ(0, config.consumer->valuesConsumed[0]);
+  EXPECT_EQ(9, config.consumer->valuesConsumed[9]);
+}
+
+namespace
+{
+  class FanOutAffinityConfiguration : public Configuration
+  {
+  public:
+    explicit FanOutAffinityConfiguration(const std::vector<unsigned>& workerCpus)
+    {
+      auto producer = createStage<IntProducerStage>();
+      auto consumer = createStage<IntConsumerStage>();
+
+      declareStageActive(producer);
+      declareStageActive(consumer);
+
+      std::vector<InputPort<int>*> workerInputs;
+      std::vector<OutputPort<int>*> workerOutputs;
+
+      for (unsigned cpus : workerCpus)
+      {
+        auto worker = createStage<TestProcessingStage>();
+        declareStageActive(worker, cpus);
+
+        workerInputs.push_back(&worker->getInputPort());
+        workerOutputs.push_back(&worker->getOutputPort());
+      }
+
+      connectPortsFanOut(producer->getOutputPort(), workerInputs, 2);
+      connectPortsFanIn(workerOutputs, consumer->getInputPort(), 2);
+    }
+
+    //affinities of all distributors and mergers of the trees
+    std::vector<unsigned> treeAffinities() const
+    {
+      std::vector<unsigned> affinities;
+
+      for (const auto& stage : getStages())
+      {
+        const std::string name = stage->debugName();
+        if (name == "FanOutDistributorStage" || name == "FanInMergerStage")
+        {
+          affinities.push_back(getCpuAffinity(stage.get()));
+        }
+      }
+
+      return affinities;
+    }
+  };
+}
+
+TEST(ConfigurationTest, fanOutFanInAffinity)
+{
+  //all workers pinned: tree nodes follow the union of their workers
+  FanOutAffinityConfiguration pinned({ 1, 2, 4, 8 });
+  auto affinities = pinned.treeAffinities();
+  ASSERT_EQ((size_t)6, affinities.size());
+  EXPECT_EQ((size_t)2, std::count(affinities.begin(), affinities.end(), 15u));
+  EXPECT_EQ((size_t)2, std::count(affinities.begin(), affinities.end(), 3u));
+  EXPECT_EQ((size_t)2, std::count(affinities.begin(), affinities.end(), 12u));
+
+  //one worker pinned, the others unpinned: no tree node must be restricted to the pinned CPU
+  FanOutAffinityConfiguration mixed({ 2, 0, 0, 0 });
+  affinities = mixed.treeAffinities();
+  ASSERT_EQ((size_t)6, affinities.size());
+  for (unsigned cpus : affinities)
+  {
+    EXPECT_EQ(0u, cpus);
+  }
+
+  //pinned subtree keeps its affinity, only nodes above unpinned workers are unrestricted
+  FanOutAffinityConfiguration half({ 1, 2, 0, 0 });
+  affinities = half.treeAffinities();
+  ASSERT_EQ((size_t)6, affinities.size());
+  EXPECT_EQ((size_t)2, std::count(affinities.begin(), affinities.end(), 3u));
+  EXPECT_EQ((size_t)4, std::count(affinities.begin(), affinities.end(), 0u));
+}
+
+namespace
+{
+  //turns each int into several big blocks, like File2FileBuffer turns file names into file contents
+  class ExpandingStage : public AbstractConsumerStage<int>
+  {
+  public:
+    static const size_t BlockSize = 1000;
+    static const int BlocksPerValue = 10;
+
+    ExpandingStage()
+      : AbstractConsumerStage<int>("ExpandingStage")
+    {
+      m_outputPort = AbstractStage::addNewOutputPort<std::vector<uint8>>();
+    }
+
+    OutputPort<std::vector<uint8>>& getOutputPort()
+    {
+      return *m_outputPort;
+    }
+
+  private:
+    virtual void execute(int&& value) override
+    {
+      for (int i = 0; i < BlocksPerValue; ++i)
+      {
+        m_outputPort->send(std::vector<uint8>(BlockSize, static_cast<uint8>(value)));
+      }
+    }
+
+    OutputPort<std::vector<uint8>>* m_outputPort;
+  };
+
+  class SlowBlockConsumerStage : public AbstractConsumerStage<std::vector<uint8>>
+  {
+  public:
+    SlowBlockConsumerStage()
+      : AbstractConsumerStage<std::vector<uint8>>("SlowBlockConsumerStage")
+      , budget(nullptr)
+      , maxUsed(0)
+      , numBlocks(0)
+    {
+    }
+
+    const MemoryBudget* budget;
+    size_t maxUsed;
+    size_t numBlocks;
+
+  private:
+    virtual void execute(std::vector<uint8>&& value) override
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      maxUsed = (std::max)(maxUsed, budget->used());
+      numBlocks += (value.size() == ExpandingStage::BlockSize) ? 1 : 0;
+    }
+  };
+
+  class ExpandingBudgetConfiguration : public Configuration
+  {
+  public:
+    shared_ptr<IntProducerStage> producer;
+    shared_ptr<SlowBlockConsumerStage> consumer;
+
+    explicit ExpandingBudgetConfiguration(size_t budget)
+    {
+      producer = createStage<IntProducerStage>();
+      auto expand = createStage<ExpandingStage>();
+      consumer = createStage<SlowBlockConsumerStage>();
+
+      declareStageActive(producer);
+      declareStageActive(expand);
+      declareStageActive(consumer);
+
+      connectPorts(producer->getOutputPort(), expand->getInputPort());
+      connectPorts(expand->getOutputPort(), consumer->getInputPort(), 1024, 0, [](const std::vector<uint8>& block) { return block.size(); });
+      setMemoryBudget(budget);
+
+      consumer->budget = getMemoryBudget().get();
+    }
+  };
+}
+
+TEST(ConfigurationTest, memoryBudgetExpandingStage)
+{
+  const size_t budget = 4 * ExpandingStage::BlockSize;
+
+  ExpandingBudgetConfiguration config(budget);
+  config.producer->numValues = 20;
+
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)(20 * ExpandingStage::BlocksPerValue), config.consumer->numBlocks);
+
+  //the expanding stage is stalled as well: at most one element per pipe beyond the budget
+  EXPECT_LE(config.consumer->maxUsed, budget + ExpandingStage::BlockSize + sizeof(int));
+  EXPECT_EQ((size_t)0, config.getMemoryBudget()->used());
+}
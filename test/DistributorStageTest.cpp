@@ -17,6 +17,7 @@
 #include <teetime/Configuration.h>
 #include <teetime/stages/DistributorStage.h>
 #include <teetime/stages/DelayStage.h>
+#include <teetime/stages/InitialElementProducer.h>
 #include "stages/IntProducerStage.h"
 #include "stages/IntConsumerStage.h"
 
@@ -230,7 +231,57 @@ TEST(DistributorCopyTest, singlethreaded)
 }
 
 
+namespace
+{
+  //the value of an int is its cost
+  struct IntCost
+  {
+    uint64 operator()(int value) const
+    {
+      return static_cast<uint64>(value);
+    }
+  };
 
+  class LeastLoadedTestConfig : public Configuration
+  {
+  public:
+    std::vector<shared_ptr<IntConsumerStage>> consumer;
 
+    LeastLoadedTestConfig(const std::vector<int>& values, unsigned numOutputPorts)
+    {
+      auto producer = createStage<InitialElementProducer<int>>(values);
+      declareStageActive(producer);
 
+      auto distributor = createStage<DistributorStage<int, LeastLoadedDistribution<int, IntCost>>>();
+      connectPorts(producer->getOutputPort(), distributor->getInputPort());
 
+      for (unsigned i = 0; i < numOutputPorts; ++i)
+      {
+        consumer.push_back(createStage<IntConsumerStage>());
+        connectPorts(distributor->getNewOutputPort(), consumer[i]->getInputPort());
+      }
+    }
+  };
+}
+
+TEST(LeastLoadedTest, longestFirst)
+{
+  LeastLoadedTestConfig config({ 9, 8, 7, 3, 2, 1 }, 2);
+  config.executeBlocking();
+
+  const std::vector<int> expected0 = { 9, 3, 2, 1 };
+  const std::vector<int> expected1 = { 8, 7 };
+  EXPECT_EQ(expected0, config.consumer[0]->valuesConsumed);
+  EXPECT_EQ(expected1, config.consumer[1]->valuesConsumed);
+}
+
+TEST(LeastLoadedTest, zeroCost)
+{
+  LeastLoadedTestConfig config({ 0, 0, 0, 0, 0, 0 }, 3);
+  config.executeBlocking();
+
+  for (const auto& c : config.consumer)
+  {
+    EXPECT_EQ((size_t)2, c->valuesConsumed.size());
+  }
+}
@@ -0,0 +1,242 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/ImageFilters.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace teetime;
+
+namespace
+{
+  Image createImage(size_t width, size_t height, PixelFormat format)
+  {
+    Image image;
+    image.setSize(width, height, format);
+
+    const size_t size = width * height * numChannels(format);
+    for (size_t i = 0; i < size; ++i)
+    {
+      image.getPixels()[i] = static_cast<uint8>(i * 37 + (i >> 3));
+    }
+
+    return image;
+  }
+
+  PlanarImage createConstant(size_t width, size_t height, PixelFormat format, float value)
+  {
+    PlanarImage image;
+    image.setSize(width, height, format);
+
+    for (unsigned p = 0; p < image.getNumPlanes(); ++p)
+    {
+      std::fill(image.getPlane(p), image.getPlane(p) + width * height, value);
+    }
+
+    return image;
+  }
+
+  //straight forward 2D convolution with clamped edges
+  float naiveBlur(const float* plane, size_t width, size_t height, size_t x, size_t y, float sigma)
+  {
+    const int radius = static_cast<int>(std::ceil(3 * sigma));
+    float sum = 0;
+    float weightSum = 0;
+
+    for (int dy = -radius; dy <= radius; ++dy)
+    {
+      for (int dx = -radius; dx <= radius; ++dx)
+      {
+        const int sx = (std::min)((std::max)(static_cast<int>(x) + dx, 0), static_cast<int>(width) - 1);
+        const int sy = (std::min)((std::max)(static_cast<int>(y) + dy, 0), static_cast<int>(height) - 1);
+        const float w = std::exp(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+
+        sum += w * plane[sy * width + sx];
+        weightSum += w;
+      }
+    }
+
+    return sum / weightSum;
+  }
+}
+
+TEST(ImageFiltersTest, roundtrip)
+{
+  const PixelFormat formats[] = { PixelFormat::Gray8, PixelFormat::GrayAlpha8, PixelFormat::Rgb8, PixelFormat::Rgba8 };
+
+  for (PixelFormat format : formats)
+  {
+    Image image = createImage(13, 7, format);
+
+    PlanarImage planar;
+    planar.deinterleave(image);
+    EXPECT_EQ(numChannels(format), planar.getNumPlanes());
+    EXPECT_EQ(hasAlpha(format), planar.hasAlpha());
+
+    Image result;
+    planar.interleave(result);
+    ASSERT_EQ(format, result.getFormat());
+    ASSERT_EQ(image.getWidth(), result.getWidth());
+    ASSERT_EQ(image.getHeight(), result.getHeight());
+    EXPECT_EQ(0, memcmp(image.getPixels(), result.getPixels(), 13 * 7 * numChannels(format)));
+  }
+}
+
+TEST(ImageFiltersTest, blurConstant)
+{
+  PlanarImage src = createConstant(31, 17, PixelFormat::Rgb8, 0.25f);
+  PlanarImage dst;
+  gaussianBlur(src, dst, 2.0f);
+
+  ASSERT_EQ((size_t)31, dst.getWidth());
+  ASSERT_EQ((size_t)17, dst.getHeight());
+
+  for (unsigned p = 0; p < dst.getNumPlanes(); ++p)
+  {
+    for (size_t i = 0; i < 31 * 17; ++i)
+    {
+      EXPECT_NEAR(0.25f, dst.getPlane(p)[i], 1e-5f);
+    }
+  }
+}
+
+TEST(ImageFiltersTest, blurReference)
+{
+  PlanarImage src;
+  src.deinterleave(createImage(23, 11, PixelFormat::GrayAlpha8));
+
+  const float sigma = 1.5f;
+  PlanarImage dst;
+  gaussianBlur(src, dst, sigma);
+
+  //color is blurred premultiplied by alpha
+  std::vector<float> premultiplied(23 * 11);
+  for (size_t i = 0; i < premultiplied.size(); ++i)
+  {
+    premultiplied[i] = src.getPlane(0)[i] * src.getPlane(1)[i];
+  }
+
+  for (size_t y = 0; y < 11; ++y)
+  {
+    for (size_t x = 0; x < 23; ++x)
+    {
+      const float alpha = naiveBlur(src.getPlane(1), 23, 11, x, y, sigma);
+      EXPECT_NEAR(alpha, dst.getPlane(1)[y * 23 + x], 1e-4f);
+      EXPECT_NEAR(naiveBlur(premultiplied.data(), 23, 11, x, y, sigma) / alpha, dst.getPlane(0)[y * 23 + x], 1e-4f);
+    }
+  }
+}
+
+TEST(ImageFiltersTest, blurTransparent)
+{
+  //opaque red next to transparent green
+  PlanarImage src = createConstant(16, 4, PixelFormat::Rgba8, 0.0f);
+  for (size_t y = 0; y < 4; ++y)
+  {
+    for (size_t x = 0; x < 16; ++x)
+    {
+      const bool opaque = x < 8;
+      src.getPlane(opaque ? 0 : 1)[y * 16 + x] = 1.0f;
+      src.getPlane(3)[y * 16 + x] = opaque ? 1.0f : 0.0f;
+    }
+  }
+
+  PlanarImage dst;
+  gaussianBlur(src, dst, 2.0f);
+
+  //no green halo, alpha fades out
+  for (size_t i = 0; i < 16 * 4; ++i)
+  {
+    EXPECT_NEAR(dst.getPlane(3)[i] > 0 ? 1.0f : 0.0f, dst.getPlane(0)[i], 1e-5f);
+    EXPECT_NEAR(0.0f, dst.getPlane(1)[i], 1e-5f);
+  }
+
+  EXPECT_LT(dst.getPlane(3)[8], 1.0f);
+  EXPECT_GT(dst.getPlane(3)[8], 0.0f);
+
+  //sharpening doesn't see the transparent color either
+  sharpen(src, dst, 1.0f, 2.0f);
+  for (size_t i = 0; i < 16 * 4; ++i)
+  {
+    if (src.getPlane(3)[i] > 0)
+    {
+      EXPECT_NEAR(1.0f, dst.getPlane(0)[i], 1e-5f);
+      EXPECT_NEAR(0.0f, dst.getPlane(1)[i], 1e-5f);
+    }
+
+    EXPECT_EQ(src.getPlane(3)[i], dst.getPlane(3)[i]);
+  }
+}
+
+TEST(ImageFiltersTest, grayscale)
+{
+  Image image;
+  image.setSize(2, 1, PixelFormat::Rgba8);
+  image.getRgba()[0] = Image::Rgba{ 255, 0, 0, 10 };
+  image.getRgba()[1] = Image::Rgba{ 255, 255, 255, 200 };
+
+  PlanarImage src;
+  src.deinterleave(image);
+
+  PlanarImage dst;
+  grayscale(src, dst);
+
+  Image result;
+  dst.interleave(result);
+  ASSERT_EQ(PixelFormat::GrayAlpha8, result.getFormat());
+
+  EXPECT_NEAR(77, result.getPixels()[0], 1);
+  EXPECT_EQ(10, result.getPixels()[1]);
+  EXPECT_EQ(255, result.getPixels()[2]);
+  EXPECT_EQ(200, result.getPixels()[3]);
+
+  src.deinterleave(createImage(4, 4, PixelFormat::Rgb8));
+  grayscale(src, dst);
+  EXPECT_EQ(PixelFormat::Gray8, dst.getFormat());
+}
+
+TEST(ImageFiltersTest, sharpen)
+{
+  PlanarImage src = createConstant(20, 20, PixelFormat::Rgba8, 0.5f);
+  std::fill(src.getPlane(3), src.getPlane(3) + 20 * 20, 0.75f);
+
+  PlanarImage dst;
+  sharpen(src, dst, 1.0f, 2.0f);
+
+  for (size_t i = 0; i < 20 * 20; ++i)
+  {
+    EXPECT_NEAR(0.5f, dst.getPlane(0)[i], 1e-5f);
+    EXPECT_EQ(0.75f, dst.getPlane(3)[i]);
+  }
+}
+
+TEST(ImageFiltersTest, gamma)
+{
+  Image image = createImage(9, 9, PixelFormat::Rgb8);
+
+  PlanarImage planar;
+  planar.deinterleave(image);
+  gammaCorrect(planar, 1.0f);
+
+  Image result;
+  planar.interleave(result);
+  EXPECT_EQ(0, memcmp(image.getPixels(), result.getPixels(), 9 * 9 * 3));
+
+  planar.deinterleave(image);
+  gammaCorrect(planar, 2.2f);
+  EXPECT_NEAR(std::pow(image.getPixels()[5] / 255.0f, 1 / 2.2f), planar.getPlane(2)[1], 1e-5f);
+}
@@ -0,0 +1,194 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/ImageKernels.h>
+#include <teetime/Image.h>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace teetime;
+
+namespace
+{
+  Image createRandomImage(size_t width, size_t height)
+  {
+    std::mt19937 generator(static_cast<unsigned>(width * 1000 + height));
+    std::uniform_int_distribution<int> distr(0, 255);
+
+    Image image;
+    image.setSize(width, height);
+
+    uint8* p = reinterpret_cast<uint8*>(image.getRgba());
+    for (size_t i = 0; i < width * height * 4; ++i)
+    {
+      p[i] = static_cast<uint8>(distr(generator));
+    }
+
+    return image;
+  }
+
+  //straightforward reference: each destination pixel averages a 2x2 block (3 rows/columns at odd edges)
+  std::vector<Image::Rgba> referenceDownsample(const Image& image)
+  {
+    const size_t srcWidth = image.getWidth();
+    const size_t srcHeight = image.getHeight();
+    const size_t width = halfSize(srcWidth);
+    const size_t height = halfSize(srcHeight);
+
+    std::vector<Image::Rgba> result(width * height);
+
+    for (size_t y = 0; y < height; ++y)
+    {
+      const size_t y1 = (y + 1 == height) ? srcHeight : 2 * y + 2;
+
+      for (size_t x = 0; x < width; ++x)
+      {
+        const size_t x1 = (x + 1 == width) ? srcWidth : 2 * x + 2;
+        unsigned sum[4] = { 0, 0, 0, 0 };
+        unsigned n = 0;
+
+        for (size_t sy = 2 * y; sy < y1; ++sy)
+        {
+          for (size_t sx = 2 * x; sx < x1; ++sx)
+          {
+            const Image::Rgba& p = image.getRgba()[sy * srcWidth + sx];
+            sum[0] += p.r;
+            sum[1] += p.g;
+            sum[2] += p.b;
+            sum[3] += p.a;
+            ++n;
+          }
+        }
+
+        Image::Rgba& d = result[y * width + x];
+        d.r = static_cast<uint8>((sum[0] + n / 2) / n);
+        d.g = static_cast<uint8>((sum[1] + n / 2) / n);
+        d.b = static_cast<uint8>((sum[2] + n / 2) / n);
+        d.a = static_cast<uint8>((sum[3] + n / 2) / n);
+      }
+    }
+
+    return result;
+  }
+}
+
+TEST(ImageKernelsTest, halvingSteps)
+{
+  EXPECT_EQ(1u, countHalvingSteps(64, 64, 32, 32));
+  EXPECT_EQ(3u, countHalvingSteps(64, 64, 8, 8));
+  EXPECT_EQ(2u, countHalvingSteps(65, 31, 16, 7));
+  EXPECT_EQ(3u, countHalvingSteps(64, 4, 8, 1));
+  EXPECT_EQ(0u, countHalvingSteps(64, 64, 64, 64));
+  EXPECT_EQ(0u, countHalvingSteps(64, 64, 48, 48));
+  EXPECT_EQ(0u, countHalvingSteps(64, 64, 32, 16));
+}
+
+TEST(ImageKernelsTest, downsampleMatchesReference)
+{
+  const size_t sizes[][2] = { { 1, 1 }, { 2, 2 }, { 3, 3 }, { 7, 5 }, { 16, 16 }, { 33, 17 }, { 9, 1 }, { 1, 9 }, { 100, 3 }, { 130, 66 } };
+
+  for (const auto& size : sizes)
+  {
+    Image image = createRandomImage(size[0], size[1]);
+    auto expected = referenceDownsample(image);
+
+    const size_t width = halfSize(size[0]);
+    std::vector<Image::Rgba> actual(expected.size());
+    downsample2x2(image.getRgba(), size[0], size[1], size[0], actual.data(), width);
+
+    ASSERT_EQ(0, memcmp(expected.data(), actual.data(), expected.size() * sizeof(Image::Rgba))) << size[0] << "x" << size[1];
+  }
+}
+
+TEST(ImageKernelsTest, strides)
+{
+  Image image = createRandomImage(40, 20);
+
+  //downsample the right half (20x20) of the image into the middle of a wider destination
+  std::vector<Image::Rgba> dst(30 * 10);
+  downsample2x2(image.getRgba() + 20, 20, 20, 40, dst.data() + 10, 30);
+
+  for (size_t y = 0; y < 10; ++y)
+  {
+    for (size_t x = 0; x < 10; ++x)
+    {
+      const Image::Rgba* src = image.getRgba() + 2 * y * 40 + 20 + 2 * x;
+      EXPECT_EQ((src[0].g + src[1].g + src[40].g + src[41].g + 2) / 4, dst[y * 30 + 10 + x].g);
+    }
+  }
+}
+
+TEST(ImageKernelsTest, resizeUsesHalving)
+{
+  Image image = createRandomImage(64, 48);
+
+  Image half;
+  ASSERT_TRUE(image.resizeInto(half, 32, 24));
+  Image quarter;
+  ASSERT_TRUE(half.resizeInto(quarter, 16, 12));
+
+  //two halving steps at once give the same result
+  Image direct = image.resize(16, 12);
+  ASSERT_EQ((size_t)16, direct.getWidth());
+  ASSERT_EQ((size_t)12, direct.getHeight());
+  EXPECT_EQ(0, memcmp(quarter.getRgba(), direct.getRgba(), 16 * 12 * sizeof(Image::Rgba)));
+
+  auto expected = referenceDownsample(image);
+  EXPECT_EQ(0, memcmp(expected.data(), half.getRgba(), expected.size() * sizeof(Image::Rgba)));
+}
+
+TEST(ImageKernelsTest, downsamplePixelFormats)
+{
+  const size_t sizes[][2] = { { 1, 1 }, { 3, 3 }, { 7, 5 }, { 33, 17 }, { 100, 3 }, { 130, 66 } };
+
+  for (auto format : { PixelFormat::Gray8, PixelFormat::GrayAlpha8, PixelFormat::Rgb8 })
+  {
+    for (const auto& size : sizes)
+    {
+      const Image image = createRandomImage(size[0], size[1]).convert(format);
+      ASSERT_EQ(format, image.getFormat());
+
+      //gray channels are replicated and missing alpha is opaque, so the RGBA reference (converted back) is exact
+      const auto rgba = referenceDownsample(image.convert(PixelFormat::Rgba8));
+      Image reference;
+      reference.setSize(halfSize(size[0]), halfSize(size[1]));
+      memcpy(reference.getRgba(), rgba.data(), rgba.size() * sizeof(Image::Rgba));
+      const Image expected = reference.convert(format);
+
+      Image actual;
+      actual.setSize(expected.getWidth(), expected.getHeight(), format);
+      downsample2x2(image.getPixels(), size[0], size[1], size[0], actual.getPixels(), actual.getWidth(), format);
+
+      ASSERT_EQ(0, memcmp(expected.getPixels(), actual.getPixels(), expected.getWidth() * expected.getHeight() * image.getChannels()))
+        << numChannels(format) << " channels, " << size[0] << "x" << size[1];
+    }
+  }
+}
+
+TEST(ImageKernelsTest, resizeKeepsPixelFormat)
+{
+  const Image image = createRandomImage(64, 48).convert(PixelFormat::Gray8);
+
+  Image half;
+  ASSERT_TRUE(image.resizeInto(half, 32, 24));
+  EXPECT_EQ(PixelFormat::Gray8, half.getFormat());
+
+  Image other;
+  ASSERT_TRUE(image.resizeInto(other, 40, 30));
+  EXPECT_EQ(PixelFormat::Gray8, other.getFormat());
+  EXPECT_EQ(sizeof(Image) + 40 * 30, elementSize(other));
+}
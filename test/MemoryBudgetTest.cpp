@@ -0,0 +1,154 @@
+/**
+ * Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/MemoryBudget.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/pipes/SynchedPipe.h>
+#include <teetime/stages/AbstractConsumerStage.h>
+#include "stages/IntProducerStage.h"
+#include <thread>
+#include <chrono>
+
+using namespace teetime;
+using namespace teetime::test;
+
+TEST(MemoryBudgetTest, simple)
+{
+  MemoryBudget budget(100);
+
+  EXPECT_TRUE(budget.tryAcquire(60));
+  EXPECT_FALSE(budget.tryAcquire(60));
+  EXPECT_TRUE(budget.tryAcquire(40));
+  EXPECT_EQ((size_t)100, budget.used());
+
+  budget.release(100);
+  EXPECT_EQ((size_t)0, budget.used());
+}
+
+TEST(MemoryBudgetTest, oversizedElement)
+{
+  MemoryBudget budget(100);
+
+  //empty budget always admits one element
+  EXPECT_TRUE(budget.tryAcquire(1000));
+  EXPECT_FALSE(budget.tryAcquire(1));
+
+  budget.release(1000);
+  EXPECT_TRUE(budget.tryAcquire(1));
+}
+
+TEST(MemoryBudgetTest, elementSize)
+{
+  FileBuffer buffer;
+  buffer.bytes.resize(1000);
+
+  EXPECT_EQ(sizeof(int), elementSize(42));
+  EXPECT_EQ(sizeof(FileBuffer) + 1000, elementSize(buffer));
+}
+
+TEST(MemoryBudgetTest, synchedPipe)
+{
+  auto budget = std::make_shared<MemoryBudget>(2 * sizeof(int));
+  SynchedPipe<int> pipe(1024, budget);
+
+  EXPECT_TRUE(pipe.tryAdd(1));
+  EXPECT_TRUE(pipe.tryAdd(2));
+  EXPECT_FALSE(pipe.tryAdd(3));
+  EXPECT_EQ(2 * sizeof(int), budget->used());
+
+  EXPECT_EQ(1, *pipe.removeLast());
+  EXPECT_EQ(sizeof(int), budget->used());
+
+  EXPECT_TRUE(pipe.tryAdd(3));
+  EXPECT_EQ(2, *pipe.removeLast());
+  EXPECT_EQ(3, *pipe.removeLast());
+  EXPECT_EQ((size_t)0, budget->used());
+}
+
+TEST(MemoryBudgetTest, synchedPipeNoThrottle)
+{
+  auto budget = std::make_shared<MemoryBudget>(sizeof(int));
+  SynchedPipe<int> pipe(1024, budget, false);
+
+  EXPECT_TRUE(pipe.tryAdd(1));
+  EXPECT_TRUE(pipe.tryAdd(2));
+  EXPECT_EQ(2 * sizeof(int), budget->used());
+}
+
+namespace
+{
+  class SlowConsumerStage : public AbstractConsumerStage<int>
+  {
+  public:
+    SlowConsumerStage()
+      : AbstractConsumerStage<int>("SlowConsumerStage")
+      , budget(nullptr)
+      , maxUsed(0)
+    {
+    }
+
+    const MemoryBudget* budget;
+    size_t maxUsed;
+    std::vector<int> valuesConsumed;
+
+  private:
+    virtual void execute(int&& value) override
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      maxUsed = std::max(maxUsed, budget->used());
+      valuesConsumed.push_back(value);
+    }
+  };
+
+  class MemoryBudgetTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<IntProducerStage> producer;
+    shared_ptr<SlowConsumerStage> consumer;
+
+    explicit MemoryBudgetTestConfig(size_t budget)
+    {
+      producer = createStage<IntProducerStage>();
+      consumer = createStage<SlowConsumerStage>();
+
+      declareStageActive(producer);
+      declareStageActive(consumer);
+
+      connectPorts(producer->getOutputPort(), consumer->getInputPort());
+      setMemoryBudget(budget);
+
+      consumer->budget = getMemoryBudget().get();
+    }
+  };
+}
+
+TEST(MemoryBudgetTest, configuration)
+{
+  MemoryBudgetTestConfig config(4 * sizeof(int));
+  config.producer->numValues = 100;
+
+  config.executeBlocking();
+
+  ASSERT_EQ((size_t)100, config.consumer->valuesConsumed.size());
+  for (int i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(i, config.consumer->valuesConsumed[i]);
+  }
+
+  EXPECT_LE(config.consumer->maxUsed, 4 * sizeof(int));
+  EXPECT_EQ((size_t)0, config.getMemoryBudget()->used());
+}
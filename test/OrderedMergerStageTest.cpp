@@ -0,0 +1,106 @@
+/**
+ * Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/OrderedMergerStage.h>
+#include "stages/IntConsumerStage.h"
+#include <algorithm>
+
+using namespace teetime;
+using namespace teetime::test;
+
+namespace
+{
+  template<typename TCompare = std::less<int>>
+  class OrderedMergerTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<IntConsumerStage> consumer;
+
+    explicit OrderedMergerTestConfig(const std::vector<std::vector<int>>& inputs)
+    {
+      auto merger = createStage<OrderedMergerStage<int, TCompare>>();
+      consumer = createStage<IntConsumerStage>();
+
+      declareStageActive(merger);
+
+      for (const auto& input : inputs)
+      {
+        auto producer = createStage<InitialElementProducer<int>>(input);
+        declareStageActive(producer);
+
+        connectPorts(producer->getOutputPort(), merger->getNewInputPort());
+      }
+
+      connectPorts(merger->getOutputPort(), consumer->getInputPort());
+    }
+  };
+
+  std::vector<int> sortedValues(int start, int step, int count)
+  {
+    std::vector<int> values;
+    for (int i = 0; i < count; ++i)
+    {
+      values.push_back(start + i * step);
+    }
+    return values;
+  }
+}
+
+TEST(OrderedMergerStageTest, singleInput)
+{
+  OrderedMergerTestConfig<> config({ sortedValues(0, 1, 100) });
+  config.executeBlocking();
+
+  EXPECT_EQ(sortedValues(0, 1, 100), config.consumer->valuesConsumed);
+}
+
+TEST(OrderedMergerStageTest, multipleInput)
+{
+  std::vector<std::vector<int>> inputs;
+  std::vector<int> expected;
+
+  for (int i = 0; i < 8; ++i)
+  {
+    inputs.push_back(sortedValues(i, 8, 1000));
+    expected.insert(expected.end(), inputs.back().begin(), inputs.back().end());
+  }
+
+  //one empty and one short input
+  inputs.push_back(std::vector<int>());
+  inputs.push_back(sortedValues(500, 1, 3));
+  expected.insert(expected.end(), inputs.back().begin(), inputs.back().end());
+
+  std::sort(expected.begin(), expected.end());
+
+  OrderedMergerTestConfig<> config(inputs);
+  config.executeBlocking();
+
+  EXPECT_EQ(expected, config.consumer->valuesConsumed);
+}
+
+TEST(OrderedMergerStageTest, customCompare)
+{
+  std::vector<int> a = { 9, 7, 5, 3, 1 };
+  std::vector<int> b = { 8, 6, 4, 2, 0 };
+
+  OrderedMergerTestConfig<std::greater<int>> config({ a, b });
+  config.executeBlocking();
+
+  std::vector<int> expected = { 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+  EXPECT_EQ(expected, config.consumer->valuesConsumed);
+}
@@ -0,0 +1,193 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/PixelPool.h>
+#include <teetime/Image.h>
+#include <cstring>
+
+using namespace teetime;
+
+TEST(PixelPoolTest, reuseBlocks)
+{
+  PixelPool pool(1024 * 1024);
+
+  void* a = pool.allocate(5000);
+  ASSERT_NE(nullptr, a);
+  EXPECT_EQ((size_t)5120, PixelPool::blockSize(a));
+
+  pool.release(a);
+  EXPECT_EQ((size_t)5120, pool.pooledBytes());
+
+  //same size class
+  void* b = pool.allocate(5120);
+  EXPECT_EQ(a, b);
+  EXPECT_EQ((size_t)0, pool.pooledBytes());
+
+  //different size class
+  void* c = pool.allocate(6000);
+  EXPECT_NE(b, c);
+
+  pool.release(b);
+  pool.release(c);
+  EXPECT_EQ((size_t)(5120 + 6144), pool.pooledBytes());
+
+  pool.clear();
+  EXPECT_EQ((size_t)0, pool.pooledBytes());
+}
+
+TEST(PixelPoolTest, sizeClasses)
+{
+  PixelPool pool;
+
+  //4 size classes per octave
+  const size_t sizes[][2] = {
+    { 4096, 4096 }, { 4097, 5120 }, { 5121, 6144 }, { 7000, 7168 }, { 7169, 8192 },
+    { 1000000, 1048576 }, { 1048577, 1310720 }, { 1400000, 1572864 }, { 1600000, 1835008 }
+  };
+
+  for (const auto& s : sizes)
+  {
+    void* block = pool.allocate(s[0]);
+    ASSERT_NE(nullptr, block);
+    EXPECT_EQ(s[1], PixelPool::blockSize(block)) << "size " << s[0];
+    pool.release(block);
+  }
+
+  pool.clear();
+}
+
+TEST(PixelPoolTest, smallBlocks)
+{
+  PixelPool pool;
+
+  //small blocks are never pooled
+  void* a = pool.allocate(100);
+  ASSERT_NE(nullptr, a);
+  EXPECT_EQ((size_t)100, PixelPool::blockSize(a));
+
+  pool.release(a);
+  EXPECT_EQ((size_t)0, pool.pooledBytes());
+
+  auto p = static_cast<uint8*>(pool.allocate(10));
+  for (int i = 0; i < 10; ++i)
+  {
+    p[i] = static_cast<uint8>(i);
+  }
+
+  p = static_cast<uint8*>(pool.reallocate(p, 1000));
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ((size_t)1000, PixelPool::blockSize(p));
+  for (int i = 0; i < 10; ++i)
+  {
+    EXPECT_EQ(static_cast<uint8>(i), p[i]);
+  }
+
+  pool.release(p);
+  EXPECT_EQ((size_t)0, pool.pooledBytes());
+}
+
+TEST(PixelPoolTest, capacity)
+{
+  PixelPool pool(4096);
+
+  void* a = pool.allocate(4096);
+  void* b = pool.allocate(4096);
+  pool.release(a);
+  pool.release(b);
+  EXPECT_EQ((size_t)4096, pool.pooledBytes());
+
+  pool.setCapacity(0);
+  EXPECT_EQ((size_t)0, pool.pooledBytes());
+
+  pool.release(pool.allocate(5000));
+  EXPECT_EQ((size_t)0, pool.pooledBytes());
+}
+
+TEST(PixelPoolTest, reallocate)
+{
+  PixelPool pool;
+
+  auto p = static_cast<uint8*>(pool.allocate(5000));
+  for (int i = 0; i < 100; ++i)
+  {
+    p[i] = static_cast<uint8>(i);
+  }
+
+  //fits into block
+  EXPECT_EQ(p, pool.reallocate(p, 5100));
+
+  auto q = static_cast<uint8*>(pool.reallocate(p, 10000));
+  ASSERT_NE(nullptr, q);
+  EXPECT_GE(PixelPool::blockSize(q), (size_t)10000);
+  for (int i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(static_cast<uint8>(i), q[i]);
+  }
+
+  pool.release(q);
+}
+
+TEST(PixelPoolTest, usedBytes)
+{
+  PixelPool pool;
+
+  void* a = pool.allocate(5000);
+  void* b = pool.allocate(100);
+  EXPECT_EQ((size_t)(5120 + 100), pool.usedBytes());
+
+  pool.release(a);
+  EXPECT_EQ((size_t)100, pool.usedBytes());
+  EXPECT_EQ((size_t)(5120 + 100), pool.peakUsedBytes());
+
+  pool.resetPeakUsedBytes();
+  EXPECT_EQ((size_t)100, pool.peakUsedBytes());
+
+  //reused blocks count again
+  a = pool.allocate(5000);
+  b = pool.reallocate(b, 200);
+  EXPECT_EQ((size_t)(5120 + 200), pool.usedBytes());
+  EXPECT_EQ((size_t)(5120 + 200), pool.peakUsedBytes());
+
+  pool.release(a);
+  pool.release(b);
+  EXPECT_EQ((size_t)0, pool.usedBytes());
+}
+
+TEST(PixelPoolTest, imageResizeInto)
+{
+  Image source;
+  source.setSize(64, 64);
+  for (size_t i = 0; i < 64 * 64; ++i)
+  {
+    source.getRgba()[i] = Image::Rgba{ 10, 20, 30, 255 };
+  }
+
+  Image target;
+  ASSERT_TRUE(source.resizeInto(target, 32, 32));
+  EXPECT_EQ((size_t)32, target.getWidth());
+  EXPECT_EQ((size_t)32, target.getHeight());
+  EXPECT_EQ(20, target.getRgba()[0].g);
+
+  //smaller image fits into the existing buffer
+  const Image::Rgba* pixels = target.getRgba();
+  ASSERT_TRUE(source.resizeInto(target, 16, 16));
+  EXPECT_EQ(pixels, target.getRgba());
+  EXPECT_EQ(30, target.getRgba()[16 * 16 - 1].b);
+
+  Image copy(target);
+  EXPECT_EQ((size_t)16, copy.getWidth());
+  EXPECT_EQ(0, memcmp(copy.getRgba(), target.getRgba(), 16 * 16 * sizeof(Image::Rgba)));
+}
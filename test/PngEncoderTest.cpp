@@ -0,0 +1,137 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/PngEncoder.h>
+#include <teetime/Image.h>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace teetime;
+
+namespace
+{
+  //gradient with some noise, so both literals and matches are produced
+  Image createTestImage(size_t width, size_t height)
+  {
+    std::mt19937 generator(static_cast<unsigned>(width * 1000 + height));
+    std::uniform_int_distribution<int> distr(0, 3);
+
+    Image image;
+    image.setSize(width, height);
+
+    Image::Rgba* p = image.getRgba();
+    for (size_t y = 0; y < height; ++y)
+    {
+      for (size_t x = 0; x < width; ++x)
+      {
+        Image::Rgba& pixel = p[y * width + x];
+        pixel.r = static_cast<uint8>(x + distr(generator));
+        pixel.g = static_cast<uint8>(y);
+        pixel.b = static_cast<uint8>((x / 16 + y / 16) % 2 ? 200 : 50);
+        pixel.a = static_cast<uint8>(255 - distr(generator));
+      }
+    }
+
+    return image;
+  }
+
+  void expectRoundtrip(const Image& image, const PngEncodeOptions& options)
+  {
+    std::vector<uint8> png;
+    ASSERT_TRUE(encodePng(image, options, png));
+
+    Image decoded;
+    ASSERT_TRUE(decoded.loadFromMemory(png.data(), png.size(), "test.png", 1, true));
+    ASSERT_EQ(image.getWidth(), decoded.getWidth());
+    ASSERT_EQ(image.getHeight(), decoded.getHeight());
+    ASSERT_EQ(image.getFormat(), decoded.getFormat());
+    EXPECT_EQ(0, std::memcmp(image.getPixels(), decoded.getPixels(), image.getWidth() * image.getHeight() * image.getChannels()));
+  }
+}
+
+TEST(PngEncoderTest, filters)
+{
+  const Image image = createTestImage(67, 45);
+
+  for (auto filter : { PngFilter::None, PngFilter::Sub, PngFilter::Up, PngFilter::Average, PngFilter::Paeth, PngFilter::Adaptive, PngFilter::AdaptiveFast })
+  {
+    PngEncodeOptions options;
+    options.filter = filter;
+    options.numThreads = 1;
+    expectRoundtrip(image, options);
+  }
+}
+
+TEST(PngEncoderTest, compressionLevels)
+{
+  const Image image = createTestImage(300, 200);
+
+  for (int level : { 0, 1, 6, 9 })
+  {
+    PngEncodeOptions options;
+    options.compressionLevel = level;
+    options.bandRows = 16;
+    options.numThreads = 4;
+    expectRoundtrip(image, options);
+  }
+}
+
+TEST(PngEncoderTest, bands)
+{
+  //bands of a single row and bands larger than the 32KiB window
+  const Image image = createTestImage(1024, 97);
+
+  for (size_t bandRows : { 1, 7, 50, 1000 })
+  {
+    PngEncodeOptions options;
+    options.bandRows = bandRows;
+    options.numThreads = 3;
+    expectRoundtrip(image, options);
+  }
+}
+
+TEST(PngEncoderTest, pixelFormats)
+{
+  const Image image = createTestImage(57, 40);
+
+  for (auto format : { PixelFormat::Gray8, PixelFormat::GrayAlpha8, PixelFormat::Rgb8 })
+  {
+    PngEncodeOptions options;
+    options.bandRows = 8;
+    options.filter = PngFilter::AdaptiveFast;
+    expectRoundtrip(image.convert(format), options);
+  }
+}
+
+TEST(PngEncoderTest, compresses)
+{
+  const Image image = createTestImage(256, 256);
+
+  PngEncodeOptions options;
+  options.bandRows = 32;
+
+  std::vector<uint8> png;
+  ASSERT_TRUE(encodePng(image, options, png));
+  EXPECT_LT(png.size(), 256 * 256 * sizeof(Image::Rgba) / 2);
+}
+
+TEST(PngEncoderTest, emptyImage)
+{
+  Image image;
+  std::vector<uint8> png;
+  EXPECT_FALSE(encodePng(image, PngEncodeOptions(), png));
+}
@@ -0,0 +1,205 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/QoiCodec.h>
+#include <teetime/Image.h>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace teetime;
+
+namespace
+{
+  inline std::string getFilePath(const std::string& name)
+  {
+    return std::string(TEETIME_LOCAL_TEST_DIR "/stages/ReadImageTest/") + name;
+  }
+
+  //smooth gradient with noise and flat areas, so all chunk types are produced
+  Image createTestImage(size_t width, size_t height, PixelFormat format)
+  {
+    std::mt19937 generator(static_cast<unsigned>(width * 1000 + height));
+    std::uniform_int_distribution<int> distr(0, 40);
+
+    Image image;
+    image.setSize(width, height, format);
+
+    const unsigned channels = numChannels(format);
+    uint8* p = image.getPixels();
+    for (size_t y = 0; y < height; ++y)
+    {
+      for (size_t x = 0; x < width; ++x)
+      {
+        const bool flat = (x / 8) % 3 == 0;
+        const int noise = distr(generator);
+
+        for (unsigned c = 0; c < channels; ++c)
+        {
+          p[c] = flat ? static_cast<uint8>(c * 50) : static_cast<uint8>(x * (c + 1) + y + (noise > 30 ? noise * c : 0));
+        }
+
+        p += channels;
+      }
+    }
+
+    return image;
+  }
+
+  void expectEqual(const Image& expected, const Image& actual)
+  {
+    ASSERT_EQ(expected.getFormat(), actual.getFormat());
+    ASSERT_EQ(expected.getWidth(), actual.getWidth());
+    ASSERT_EQ(expected.getHeight(), actual.getHeight());
+    EXPECT_EQ(0, memcmp(expected.getPixels(), actual.getPixels(), expected.getWidth() * expected.getHeight() * expected.getChannels()));
+  }
+}
+
+TEST(QoiCodecTest, chunks)
+{
+  Image image;
+  image.setSize(7, 1);
+
+  Image::Rgba* p = image.getRgba();
+  p[0] = Image::Rgba{ 0, 0, 0, 255 };
+  p[1] = Image::Rgba{ 0, 0, 0, 255 };
+  p[2] = Image::Rgba{ 1, 1, 1, 255 };    //diff
+  p[3] = Image::Rgba{ 0, 0, 0, 255 };    //diff (initial pixel is not indexed)
+  p[4] = Image::Rgba{ 10, 20, 30, 40 };  //rgba
+  p[5] = Image::Rgba{ 0, 0, 0, 255 };    //index
+  p[6] = Image::Rgba{ 15, 20, 27, 255 }; //luma
+
+  std::vector<uint8> qoi;
+  ASSERT_TRUE(encodeQoi(image, qoi));
+
+  const uint8 expected[] = {
+    'q', 'o', 'i', 'f', 0, 0, 0, 7, 0, 0, 0, 1, 4, 0,
+    0xc1, 0x7f, 0x55, 0xff, 10, 20, 30, 40, 0x35, 0x80 | 52, 0x3f,
+    0, 0, 0, 0, 0, 0, 0, 1
+  };
+
+  ASSERT_EQ(sizeof(expected), qoi.size());
+  EXPECT_EQ(0, memcmp(expected, qoi.data(), sizeof(expected)));
+
+  Image decoded;
+  ASSERT_TRUE(decodeQoi(qoi.data(), qoi.size(), decoded, false));
+  expectEqual(image, decoded);
+}
+
+TEST(QoiCodecTest, roundtrip)
+{
+  const size_t sizes[][2] = { { 1, 1 }, { 100, 1 }, { 1, 100 }, { 257, 131 } };
+
+  for (const auto& size : sizes)
+  {
+    Image rgba = createTestImage(size[0], size[1], PixelFormat::Rgba8);
+    Image rgb = createTestImage(size[0], size[1], PixelFormat::Rgb8);
+
+    std::vector<uint8> qoi;
+    Image decoded;
+
+    ASSERT_TRUE(encodeQoi(rgba, qoi));
+    ASSERT_TRUE(decodeQoi(qoi.data(), qoi.size(), decoded, true));
+    expectEqual(rgba, decoded);
+
+    ASSERT_TRUE(encodeQoi(rgb, qoi));
+    ASSERT_TRUE(decodeQoi(qoi.data(), qoi.size(), decoded, true));
+    expectEqual(rgb, decoded);
+
+    ASSERT_TRUE(decodeQoi(qoi.data(), qoi.size(), decoded, false));
+    expectEqual(rgb.convert(PixelFormat::Rgba8), decoded);
+  }
+}
+
+TEST(QoiCodecTest, gray)
+{
+  Image gray = createTestImage(64, 32, PixelFormat::Gray8);
+  Image grayAlpha = createTestImage(64, 32, PixelFormat::GrayAlpha8);
+
+  std::vector<uint8> qoi;
+  Image decoded;
+
+  ASSERT_TRUE(encodeQoi(gray, qoi));
+  ASSERT_TRUE(decodeQoi(qoi.data(), qoi.size(), decoded, true));
+  expectEqual(gray.convert(PixelFormat::Rgb8), decoded);
+
+  ASSERT_TRUE(encodeQoi(grayAlpha, qoi));
+  ASSERT_TRUE(decodeQoi(qoi.data(), qoi.size(), decoded, true));
+  expectEqual(grayAlpha.convert(PixelFormat::Rgba8), decoded);
+}
+
+TEST(QoiCodecTest, invalid)
+{
+  Image image = createTestImage(16, 16, PixelFormat::Rgba8);
+
+  std::vector<uint8> qoi;
+  ASSERT_TRUE(encodeQoi(image, qoi));
+
+  Image decoded;
+  EXPECT_FALSE(decodeQoi(qoi.data(), 10, decoded, false));
+
+  std::vector<uint8> broken = qoi;
+  broken[12] = 5;
+  EXPECT_FALSE(decodeQoi(broken.data(), broken.size(), decoded, false));
+
+  broken = qoi;
+  broken[0] = 'x';
+  EXPECT_FALSE(decodeQoi(broken.data(), broken.size(), decoded, false));
+
+  //truncated chunks
+  EXPECT_FALSE(decodeQoi(qoi.data(), qoi.size() / 2, decoded, false));
+  EXPECT_EQ((size_t)0, decoded.getWidth());
+  EXPECT_FALSE(decodeQoi(qoi.data(), qoi.size() - 1, decoded, false));
+  EXPECT_FALSE(decoded.loadFromMemory(qoi.data(), qoi.size() / 2, "truncated.qoi"));
+  EXPECT_TRUE(decoded.loadFromMemory(qoi.data(), qoi.size(), "complete.qoi"));
+
+  Image empty;
+  EXPECT_FALSE(encodeQoi(empty, qoi));
+}
+
+TEST(QoiCodecTest, image)
+{
+  Image lena;
+  ASSERT_TRUE(lena.loadFromFile(getFilePath("lena.png")));
+
+  const std::string filename = "QoiCodecTest_lena.qoi";
+  ASSERT_TRUE(lena.saveToFile(filename));
+
+  ImageInfo info;
+  ASSERT_TRUE(Image::probe(filename, info));
+  EXPECT_EQ(lena.getWidth(), info.width);
+  EXPECT_EQ(lena.getHeight(), info.height);
+  EXPECT_EQ(4u, info.channels);
+
+  Image loaded;
+  ASSERT_TRUE(loaded.loadFromFile(filename));
+  expectEqual(lena, loaded);
+  EXPECT_EQ(filename, loaded.getFilename());
+
+  ASSERT_TRUE(loaded.loadFromFile(filename, 2));
+  expectEqual(lena.resize(lena.getWidth() / 2, lena.getHeight() / 2), loaded);
+
+  std::vector<uint8> qoi;
+  ASSERT_TRUE(lena.saveToMemory(ImageFileFormat::Qoi, qoi));
+  ASSERT_TRUE(Image::probe(qoi.data(), qoi.size(), info));
+  EXPECT_EQ(lena.getWidth(), info.width);
+
+  ASSERT_TRUE(loaded.loadFromMemory(qoi.data(), qoi.size(), "lena.qoi"));
+  expectEqual(lena, loaded);
+
+  std::remove(filename.c_str());
+}
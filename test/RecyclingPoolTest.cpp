@@ -0,0 +1,117 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/RecyclingPool.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/File.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/AbstractConsumerStage.h>
+#include <teetime/stages/File2FileBuffer.h>
+
+using namespace teetime;
+
+TEST(RecyclingPoolTest, simple)
+{
+  RecyclingPool<std::vector<int>> pool(2);
+
+  std::vector<int> v;
+  EXPECT_FALSE(pool.take(v));
+
+  std::vector<int> a(100);
+  const int* data = a.data();
+
+  EXPECT_TRUE(pool.recycle(std::move(a)));
+  EXPECT_EQ((size_t)1, pool.size());
+
+  EXPECT_TRUE(pool.take(v));
+  EXPECT_EQ(data, v.data());
+  EXPECT_EQ((size_t)100, v.size());
+  EXPECT_EQ((size_t)0, pool.size());
+}
+
+TEST(RecyclingPoolTest, capacity)
+{
+  RecyclingPool<std::vector<int>> pool(2);
+
+  EXPECT_TRUE(pool.recycle(std::vector<int>(1)));
+  EXPECT_TRUE(pool.recycle(std::vector<int>(1)));
+  EXPECT_FALSE(pool.recycle(std::vector<int>(1)));
+  EXPECT_EQ((size_t)2, pool.size());
+}
+
+namespace
+{
+  class RecyclingSink : public AbstractConsumerStage<FileBuffer>
+  {
+  public:
+    explicit RecyclingSink(shared_ptr<FileBufferPool> pool)
+      : AbstractConsumerStage<FileBuffer>("RecyclingSink")
+      , pool(pool)
+    {
+    }
+
+    shared_ptr<FileBufferPool> pool;
+    std::vector<const uint8*> buffers;
+
+  private:
+    virtual void execute(FileBuffer&& value) override
+    {
+      EXPECT_EQ((size_t)11, value.bytes.size());
+      buffers.push_back(value.bytes.data());
+      pool->recycle(std::move(value.bytes));
+    }
+  };
+
+  class RecyclingTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<FileBufferPool> pool;
+    shared_ptr<RecyclingSink> sink;
+
+    explicit RecyclingTestConfig(size_t numFiles)
+    {
+      std::vector<File> files(numFiles, File(TEETIME_LOCAL_TEST_DIR "/stages/File2FileBufferTest/file1.txt"));
+
+      pool = std::make_shared<FileBufferPool>();
+
+      auto producer = createStage<InitialElementProducer<File>>(files);
+      auto file2buffer = createStage<File2FileBuffer>();
+      sink = createStage<RecyclingSink>(pool);
+
+      file2buffer->setRecyclingPool(pool);
+
+      declareStageActive(producer);
+      connectPorts(producer->getOutputPort(), file2buffer->getInputPort());
+      connectPorts(file2buffer->getOutputPort(), sink->getInputPort());
+    }
+  };
+}
+
+TEST(RecyclingPoolTest, file2FileBuffer)
+{
+  //single threaded, so each buffer is recycled before next file is read
+  RecyclingTestConfig config(10);
+  config.executeBlocking();
+
+  ASSERT_EQ((size_t)10, config.sink->buffers.size());
+  for (auto p : config.sink->buffers)
+  {
+    EXPECT_EQ(config.sink->buffers[0], p);
+  }
+
+  EXPECT_EQ((size_t)1, config.pool->size());
+}
@@ -18,6 +18,8 @@
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <string>
+#include <vector>
 
 using namespace teetime;
 
@@ -86,4 +88,75 @@ TEST(SynchedPipeTest, concurrent)
   {
     EXPECT_EQ((int)i, dst[i]);
   }
-}
\ No newline at end of file
+}
+
+TEST(SynchedPipeTest, byteCapacity)
+{
+  SynchedPipe<std::string> pipe(1024);
+  pipe.setByteCapacity(10, [](const std::string& s) { return s.size(); });
+
+  EXPECT_TRUE(pipe.tryAdd("12345"));
+  EXPECT_TRUE(pipe.tryAdd("1234"));
+  EXPECT_FALSE(pipe.tryAdd("12"));
+  EXPECT_TRUE(pipe.tryAdd("1"));
+  EXPECT_EQ((size_t)10, pipe.bytes());
+
+  EXPECT_EQ(std::string("12345"), *pipe.removeLast());
+  EXPECT_EQ((size_t)5, pipe.bytes());
+
+  EXPECT_TRUE(pipe.tryAdd("12"));
+  EXPECT_EQ(std::string("1234"), *pipe.removeLast());
+  EXPECT_EQ(std::string("1"), *pipe.removeLast());
+  EXPECT_EQ(std::string("12"), *pipe.removeLast());
+  EXPECT_EQ((size_t)0, pipe.bytes());
+}
+
+TEST(SynchedPipeTest, byteCapacityOversizedElement)
+{
+  SynchedPipe<std::string> pipe(1024);
+  pipe.setByteCapacity(10, [](const std::string& s) { return s.size(); });
+
+  //empty pipe accepts one element, no matter how big it is
+  EXPECT_TRUE(pipe.tryAdd("this is more than 10 bytes"));
+  EXPECT_FALSE(pipe.tryAdd("1"));
+
+  pipe.removeLast();
+  EXPECT_TRUE(pipe.tryAdd("1"));
+}
+
+TEST(SynchedPipeTest, byteCapacityConcurrent)
+{
+  SynchedPipe<std::vector<int>> pipe(1024);
+  pipe.setByteCapacity(100, [](const std::vector<int>& v) { return v.size(); });
+
+  std::vector<size_t> dst;
+  size_t maxBytes = 0;
+
+  std::thread producer([&]() {
+    for (size_t i = 0; i < 1000; ++i)
+    {
+      pipe.add(std::vector<int>(i % 50));
+    }
+  });
+
+  std::thread consumer([&]() {
+    while (dst.size() < 1000)
+    {
+      maxBytes = std::max(maxBytes, pipe.bytes());
+      if (auto v = pipe.removeLast())
+      {
+        dst.push_back((*v).size());
+      }
+    }
+  });
+
+  producer.join();
+  consumer.join();
+
+  EXPECT_LE(maxBytes, (size_t)100);
+  ASSERT_EQ(size_t(1000), dst.size());
+  for (size_t i = 0; i < dst.size(); ++i)
+  {
+    EXPECT_EQ(i % 50, dst[i]);
+  }
+}
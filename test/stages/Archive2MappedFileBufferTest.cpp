@@ -0,0 +1,157 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/Directory2Files.h>
+#include <teetime/stages/File2FileBuffer.h>
+#include <teetime/stages/ArchiveSink.h>
+#include <teetime/stages/Archive2MappedFileBuffer.h>
+#include <teetime/MappedFileBuffer.h>
+#include <teetime/Archive.h>
+#include <teetime/platform.h>
+#include <cstring>
+
+using namespace teetime;
+
+namespace
+{
+  const char* testDirectory = TEETIME_LOCAL_TEST_DIR "/stages/File2FileBufferTest";
+
+  class PackTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<ArchiveSink> sink;
+
+    explicit PackTestConfig(const std::string& basePath)
+    {
+      auto producer = createStage<InitialElementProducer<std::string>>(testDirectory);
+      auto dir2files = createStage<Directory2Files>();
+      auto file2buffer = createStage<File2FileBuffer>();
+      sink = createStage<ArchiveSink>(basePath);
+      sink->setBaseDirectory(testDirectory);
+
+      declareStageActive(producer);
+      declareStageActive(sink);
+
+      connectPorts(producer->getOutputPort(), dir2files->getInputPort());
+      connectPorts(dir2files->getOutputPort(), file2buffer->getInputPort());
+      connectPorts(file2buffer->getOutputPort(), sink->getInputPort());
+    }
+  };
+
+  class UnpackTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<Archive2MappedFileBuffer> archive2buffer;
+    shared_ptr<CollectorSink<MappedFileBuffer>> collector;
+
+    explicit UnpackTestConfig(const std::string& basePath)
+    {
+      auto producer = createStage<InitialElementProducer<std::string>>(basePath);
+      archive2buffer = createStage<Archive2MappedFileBuffer>();
+      collector = createStage<CollectorSink<MappedFileBuffer>>();
+
+      declareStageActive(producer);
+
+      connectPorts(producer->getOutputPort(), archive2buffer->getInputPort());
+      connectPorts(archive2buffer->getOutputPort(), collector->getInputPort());
+    }
+  };
+}
+
+TEST(Archive2MappedFileBufferTest, packAndUnpack)
+{
+  const std::string basePath = "Archive2MappedFileBufferTest_archive";
+
+  PackTestConfig pack(basePath);
+  pack.executeBlocking();
+  EXPECT_EQ((size_t)2, pack.sink->numEntriesWritten());
+
+  UnpackTestConfig unpack(basePath);
+  unpack.executeBlocking();
+
+  auto buffers = unpack.collector->takeElements();
+  ASSERT_EQ((size_t)2, buffers.size());
+
+  EXPECT_EQ("empty.txt", buffers[0].path);
+  EXPECT_EQ((size_t)0, buffers[0].size());
+
+  EXPECT_EQ("file1.txt", buffers[1].path);
+  ASSERT_EQ((size_t)11, buffers[1].size());
+  EXPECT_EQ(0, strncmp("hello world", (const char*)buffers[1].data(), buffers[1].size()));
+
+  buffers.clear();
+  EXPECT_TRUE(platform::removeFile(archiveSegmentPath(basePath, 0)));
+  EXPECT_TRUE(platform::removeFile(archiveIndexPath(basePath)));
+}
+
+TEST(Archive2MappedFileBufferTest, missingArchive)
+{
+  UnpackTestConfig unpack("Archive2MappedFileBufferTest_missing");
+  unpack.executeBlocking();
+
+  EXPECT_TRUE(unpack.collector->takeElements().empty());
+}
+
+TEST(Archive2MappedFileBufferTest, missingSegment)
+{
+  const std::string basePath = "Archive2MappedFileBufferTest_segments";
+
+  //two entries per segment
+  ArchiveWriter writer(8, 4);
+  ASSERT_TRUE(writer.open(basePath));
+  ASSERT_TRUE(writer.add("a", (const uint8*)"aaaa", 4));
+  ASSERT_TRUE(writer.add("b", (const uint8*)"bbbb", 4));
+  ASSERT_TRUE(writer.add("c", (const uint8*)"cccc", 4));
+  ASSERT_TRUE(writer.add("d", (const uint8*)"dddd", 4));
+  ASSERT_TRUE(writer.add("e", (const uint8*)"eeee", 4));
+  ASSERT_TRUE(writer.close());
+
+  EXPECT_TRUE(platform::removeFile(archiveSegmentPath(basePath, 1)));
+
+  UnpackTestConfig unpack(basePath);
+  unpack.executeBlocking();
+
+  //entries of the missing segment are skipped, the others are still emitted
+  auto buffers = unpack.collector->takeElements();
+  ASSERT_EQ((size_t)3, buffers.size());
+  EXPECT_EQ("a", buffers[0].path);
+  EXPECT_EQ("b", buffers[1].path);
+  EXPECT_EQ("e", buffers[2].path);
+  EXPECT_EQ((size_t)2, unpack.archive2buffer->numEntriesSkipped());
+
+  buffers.clear();
+  EXPECT_TRUE(platform::removeFile(archiveSegmentPath(basePath, 0)));
+  EXPECT_TRUE(platform::removeFile(archiveSegmentPath(basePath, 2)));
+  EXPECT_TRUE(platform::removeFile(archiveIndexPath(basePath)));
+}
+
+TEST(Archive2MappedFileBufferTest, sliceOutlivesBuffer)
+{
+  MappedFileBuffer view;
+
+  {
+    MappedFileBuffer buffer;
+    ASSERT_TRUE(buffer.map(std::string(testDirectory) + "/file1.txt"));
+    view = buffer.slice(6, 5, "world");
+  }
+
+  EXPECT_EQ("world", view.path);
+  ASSERT_EQ((size_t)5, view.size());
+  EXPECT_EQ(0, strncmp("world", (const char*)view.data(), view.size()));
+}
@@ -0,0 +1,165 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/ArchiveSink.h>
+#include <teetime/Archive.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/platform.h>
+
+using namespace teetime;
+
+namespace
+{
+  std::vector<FileBuffer> createBuffers(size_t num)
+  {
+    std::vector<FileBuffer> buffers;
+    for (size_t i = 0; i < num; ++i)
+    {
+      FileBuffer buffer;
+      buffer.path = "dir/file" + std::to_string(i) + ".bin";
+
+      buffer.bytes.resize(i * 997);
+      for (size_t j = 0; j < buffer.bytes.size(); ++j)
+      {
+        buffer.bytes[j] = static_cast<uint8>(i + j);
+      }
+
+      buffers.push_back(std::move(buffer));
+    }
+
+    return buffers;
+  }
+
+  class ArchiveSinkTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<ArchiveSink> sink;
+
+    ArchiveSinkTestConfig(const std::vector<FileBuffer>& buffers, const std::string& basePath, uint64 segmentSize)
+    {
+      auto producer = createStage<InitialElementProducer<FileBuffer>>(buffers);
+      sink = createStage<ArchiveSink>(basePath, segmentSize);
+
+      declareStageActive(producer);
+      declareStageActive(sink);
+
+      connectPorts(producer->getOutputPort(), sink->getInputPort());
+    }
+  };
+
+  void removeArchive(const std::string& basePath, uint32 numSegments)
+  {
+    for (uint32 i = 0; i < numSegments; ++i)
+    {
+      EXPECT_TRUE(platform::removeFile(archiveSegmentPath(basePath, i)));
+    }
+
+    EXPECT_TRUE(platform::removeFile(archiveIndexPath(basePath)));
+  }
+}
+
+TEST(ArchiveSinkTest, simple)
+{
+  const std::string basePath = "ArchiveSinkTest_simple";
+  auto buffers = createBuffers(20);
+
+  ArchiveSinkTestConfig config(buffers, basePath, 64 * 1024);
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)20, config.sink->numEntriesWritten());
+  EXPECT_EQ((size_t)0, config.sink->numEntriesFailed());
+
+  ArchiveReader reader;
+  ASSERT_TRUE(reader.open(basePath));
+  ASSERT_EQ((size_t)20, reader.entries().size());
+
+  uint32 numSegments = 0;
+  for (size_t i = 0; i < buffers.size(); ++i)
+  {
+    const auto& entry = reader.entries()[i];
+    EXPECT_EQ(buffers[i].path, entry.name);
+    numSegments = std::max(numSegments, entry.segment + 1);
+
+    FileBuffer buffer;
+    ASSERT_TRUE(reader.read(buffers[i].path, buffer));
+    EXPECT_EQ(buffers[i].path, buffer.path);
+    EXPECT_EQ(buffers[i].bytes, buffer.bytes);
+  }
+
+  //about 190k bytes in total, so segment size must have been respected
+  EXPECT_GT(numSegments, (uint32)2);
+
+  FileBuffer buffer;
+  EXPECT_EQ(nullptr, reader.find("dir/missing.bin"));
+  EXPECT_FALSE(reader.read("dir/missing.bin", buffer));
+
+  reader.close();
+  removeArchive(basePath, numSegments);
+}
+
+TEST(ArchiveSinkTest, empty)
+{
+  const std::string basePath = "ArchiveSinkTest_empty";
+
+  ArchiveSinkTestConfig config({}, basePath, 64 * 1024);
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)0, config.sink->numEntriesWritten());
+
+  ArchiveReader reader;
+  ASSERT_TRUE(reader.open(basePath));
+  EXPECT_TRUE(reader.entries().empty());
+
+  reader.close();
+  removeArchive(basePath, 1);
+}
+
+TEST(ArchiveSinkTest, writerBypassesBuffer)
+{
+  const std::string basePath = "ArchiveSinkTest_writer";
+  auto buffers = createBuffers(8);
+
+  //buffer is smaller than most entries
+  ArchiveWriter writer(ArchiveWriter::DefaultSegmentSize, 1024);
+  ASSERT_TRUE(writer.open(basePath));
+  for (const auto& b : buffers)
+  {
+    ASSERT_TRUE(writer.add(b.path, b.bytes.data(), b.bytes.size()));
+  }
+  ASSERT_TRUE(writer.close());
+
+  ArchiveReader reader;
+  ASSERT_TRUE(reader.open(basePath));
+  ASSERT_EQ(buffers.size(), reader.entries().size());
+
+  for (const auto& b : buffers)
+  {
+    FileBuffer buffer;
+    ASSERT_TRUE(reader.read(b.path, buffer));
+    EXPECT_EQ(b.bytes, buffer.bytes);
+  }
+
+  reader.close();
+  removeArchive(basePath, 1);
+}
+
+TEST(ArchiveSinkTest, missingArchive)
+{
+  ArchiveReader reader;
+  EXPECT_FALSE(reader.open("ArchiveSinkTest_missing"));
+}
@@ -0,0 +1,121 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/AsyncFileReaderStage.h>
+#include <teetime/File.h>
+#include <teetime/FileBuffer.h>
+#include <algorithm>
+
+using namespace teetime;
+
+namespace
+{
+  inline std::string getFilePath(const std::string& name)
+  {
+    //reuse test data of File2FileBuffer
+    return std::string(TEETIME_LOCAL_TEST_DIR "/stages/File2FileBufferTest/") + name;
+  }
+
+  class AsyncFileReaderTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<FileBuffer>> collector;
+
+    AsyncFileReaderTestConfig(const std::vector<File>& files, size_t queueDepth, size_t numThreads, shared_ptr<FileBufferPool> pool = nullptr)
+    {
+      auto producer = createStage<InitialElementProducer<File>>(files);
+      auto reader = createStage<AsyncFileReaderStage>(queueDepth, numThreads);
+      reader->setRecyclingPool(pool);
+      collector = createStage<CollectorSink<FileBuffer>>();
+
+      declareStageActive(producer);
+      declareStageActive(reader);
+
+      connectPorts(producer->getOutputPort(), reader->getInputPort());
+      connectPorts(reader->getOutputPort(), collector->getInputPort());
+    }
+  };
+}
+
+TEST(AsyncFileReaderStageTest, simple)
+{
+  AsyncFileReaderTestConfig config({ File(getFilePath("file1.txt")) }, 16, 0);
+
+  config.executeBlocking();
+
+  std::vector<FileBuffer> files = config.collector->takeElements();
+
+  ASSERT_EQ((size_t)1, files.size());
+  EXPECT_EQ(getFilePath("file1.txt"), files[0].path);
+  ASSERT_EQ((size_t)11, files[0].bytes.size());
+  EXPECT_EQ(0, strncmp("hello world", (const char*)files[0].bytes.data(), files[0].bytes.size()));
+}
+
+TEST(AsyncFileReaderStageTest, manyFiles)
+{
+  std::vector<File> input;
+  for (int i = 0; i < 100; ++i)
+  {
+    input.push_back(File(getFilePath("file1.txt")));
+    input.push_back(File(getFilePath("empty.txt")));
+    input.push_back(File(getFilePath("missing.txt")));
+  }
+
+  AsyncFileReaderTestConfig config(input, 4, 2);
+
+  config.executeBlocking();
+
+  std::vector<FileBuffer> files = config.collector->takeElements();
+  ASSERT_EQ((size_t)200, files.size());
+
+  auto numEmpty = std::count_if(files.begin(), files.end(), [](const FileBuffer& b) { return b.bytes.empty(); });
+  EXPECT_EQ(100, numEmpty);
+
+  for (const auto& f : files)
+  {
+    if (f.bytes.empty())
+    {
+      EXPECT_EQ(getFilePath("empty.txt"), f.path);
+    }
+    else
+    {
+      EXPECT_EQ(getFilePath("file1.txt"), f.path);
+      EXPECT_EQ((size_t)11, f.bytes.size());
+    }
+  }
+}
+
+TEST(AsyncFileReaderStageTest, recycleOnFailure)
+{
+  auto pool = std::make_shared<FileBufferPool>();
+  for (int i = 0; i < 4; ++i)
+  {
+    pool->recycle(std::vector<uint8>(64));
+  }
+
+  std::vector<File> input(4, File(getFilePath("missing.txt")));
+
+  AsyncFileReaderTestConfig config(input, 4, 2, pool);
+  config.executeBlocking();
+
+  EXPECT_TRUE(config.collector->takeElements().empty());
+
+  //buffers taken for failed reads went back to the pool
+  EXPECT_EQ((size_t)4, pool->size());
+}
@@ -0,0 +1,236 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/CopyFileStage.h>
+#include <teetime/BufferedFile.h>
+#include <teetime/File.h>
+#include <teetime/platform.h>
+#include <cstring>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace teetime;
+
+namespace
+{
+  const char* outputDir = "CopyFileStageTest_output";
+
+  inline std::string getFilePath(const std::string& name)
+  {
+    //reuse test data of File2FileBuffer
+    return std::string(TEETIME_LOCAL_TEST_DIR "/stages/File2FileBufferTest/") + name;
+  }
+
+  class CopyFileStageTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CopyFileStage> copy;
+    shared_ptr<CollectorSink<File>> collector;
+
+    explicit CopyFileStageTestConfig(const std::vector<File>& files, const std::string& baseDirectory = "", bool overwrite = false)
+    {
+      platform::createDirectory(outputDir);
+
+      auto producer = createStage<InitialElementProducer<File>>(files);
+      copy = createStage<CopyFileStage>(outputDir);
+      copy->setBaseDirectory(baseDirectory);
+      copy->setOverwrite(overwrite);
+      collector = createStage<CollectorSink<File>>();
+
+      declareStageActive(producer);
+      connectPorts(producer->getOutputPort(), copy->getInputPort());
+      connectPorts(copy->getOutputPort(), collector->getInputPort());
+    }
+  };
+
+  void expectEqualFiles(const std::string& expected, const std::string& actual)
+  {
+    BufferedFile a;
+    BufferedFile b;
+    ASSERT_TRUE(a.load(expected));
+    ASSERT_TRUE(b.load(actual));
+    ASSERT_EQ(a.size(), b.size());
+    EXPECT_EQ(0, memcmp(a.data(), b.data(), a.size()));
+  }
+}
+
+TEST(CopyFileStageTest, simple)
+{
+  CopyFileStageTestConfig config({ File(getFilePath("file1.txt")), File(getFilePath("empty.txt")), File(getFilePath("missing.txt")) });
+  config.executeBlocking();
+
+  auto files = config.collector->takeElements();
+  ASSERT_EQ((size_t)2, files.size());
+  EXPECT_EQ(std::string(outputDir) + "/file1.txt", files[0].path);
+  EXPECT_EQ(std::string(outputDir) + "/empty.txt", files[1].path);
+  EXPECT_EQ((size_t)2, config.copy->numFilesCopied());
+  EXPECT_EQ((size_t)1, config.copy->numFilesFailed());
+
+  expectEqualFiles(getFilePath("file1.txt"), files[0].path);
+  expectEqualFiles(getFilePath("empty.txt"), files[1].path);
+
+  EXPECT_TRUE(platform::removeFile(files[0].path));
+  EXPECT_TRUE(platform::removeFile(files[1].path));
+  EXPECT_TRUE(platform::removeDirectory(outputDir, false));
+}
+
+TEST(CopyFileStageTest, largeFile)
+{
+  const std::string source = "CopyFileStageTest_large.bin";
+  const std::string target = "CopyFileStageTest_large_copy.bin";
+
+  std::vector<uint8> content(3 * 1024 * 1024 + 17);
+  for (size_t i = 0; i < content.size(); ++i)
+  {
+    content[i] = static_cast<uint8>(i * 31);
+  }
+
+  auto file = platform::createFile(source.c_str(), false);
+  ASSERT_NE(platform::InvalidFileHandle, file);
+  ASSERT_EQ(content.size(), platform::writeFile(file, 0, content.data(), content.size()));
+  platform::closeFile(file);
+
+  ASSERT_TRUE(platform::copyFile(source, target));
+  expectEqualFiles(source, target);
+
+  //existing files are overwritten
+  ASSERT_TRUE(platform::copyFile(getFilePath("file1.txt"), target));
+  expectEqualFiles(getFilePath("file1.txt"), target);
+
+  EXPECT_TRUE(platform::removeFile(source));
+  EXPECT_TRUE(platform::removeFile(target));
+}
+
+TEST(CopyFileStageTest, baseDirectory)
+{
+  CopyFileStageTestConfig config({ File(getFilePath("file1.txt")) }, TEETIME_LOCAL_TEST_DIR "/stages");
+  config.executeBlocking();
+
+  auto files = config.collector->takeElements();
+  ASSERT_EQ((size_t)1, files.size());
+  EXPECT_EQ(std::string(outputDir) + "/File2FileBufferTest/file1.txt", files[0].path);
+  EXPECT_EQ((size_t)1, config.copy->numFilesCopied());
+  EXPECT_EQ((size_t)0, config.copy->numFilesFailed());
+
+  expectEqualFiles(getFilePath("file1.txt"), files[0].path);
+
+  EXPECT_TRUE(platform::removeDirectory(outputDir, true));
+}
+
+TEST(CopyFileStageTest, invalidTarget)
+{
+  const std::string base = TEETIME_LOCAL_TEST_DIR "/stages/File2FileBufferTest";
+
+  //the base directory itself and paths leaving it have no target inside the target directory
+  CopyFileStageTestConfig config({ File(base), File(base + "/../File2FileBufferTest/file1.txt") }, base);
+  config.executeBlocking();
+
+  EXPECT_TRUE(config.collector->takeElements().empty());
+  EXPECT_EQ((size_t)0, config.copy->numFilesCopied());
+  EXPECT_EQ((size_t)2, config.copy->numFilesFailed());
+
+  EXPECT_TRUE(platform::removeDirectory(outputDir, true));
+}
+
+TEST(CopyFileStageTest, existingTarget)
+{
+  //same file name from different directories
+  const std::string other = "CopyFileStageTest_other";
+  platform::createDirectory(other);
+
+  auto file = platform::createFile((other + "/file1.txt").c_str(), false);
+  ASSERT_NE(platform::InvalidFileHandle, file);
+  ASSERT_EQ((size_t)5, platform::writeFile(file, 0, "other", 5));
+  platform::closeFile(file);
+
+  {
+    CopyFileStageTestConfig config({ File(getFilePath("file1.txt")), File(other + "/file1.txt") });
+    config.executeBlocking();
+
+    auto files = config.collector->takeElements();
+    ASSERT_EQ((size_t)1, files.size());
+    EXPECT_EQ((size_t)1, config.copy->numFilesCopied());
+    EXPECT_EQ((size_t)1, config.copy->numFilesFailed());
+
+    //first file wins
+    expectEqualFiles(getFilePath("file1.txt"), files[0].path);
+  }
+
+  {
+    CopyFileStageTestConfig config({ File(other + "/file1.txt") }, "", true);
+    config.executeBlocking();
+
+    auto files = config.collector->takeElements();
+    ASSERT_EQ((size_t)1, files.size());
+    EXPECT_EQ((size_t)1, config.copy->numFilesCopied());
+    EXPECT_EQ((size_t)0, config.copy->numFilesFailed());
+
+    expectEqualFiles(other + "/file1.txt", files[0].path);
+  }
+
+  //no overwriting by plain copies either
+  EXPECT_FALSE(platform::copyFile(getFilePath("file1.txt"), std::string(outputDir) + "/file1.txt", false));
+  expectEqualFiles(other + "/file1.txt", std::string(outputDir) + "/file1.txt");
+
+  EXPECT_TRUE(platform::removeDirectory(outputDir, true));
+  EXPECT_TRUE(platform::removeDirectory(other, true));
+}
+
+TEST(CopyFileStageTest, sameFile)
+{
+  const std::string source = "CopyFileStageTest_same.txt";
+  ASSERT_TRUE(platform::copyFile(getFilePath("file1.txt"), source));
+
+  //copying onto itself must not truncate the source
+  EXPECT_FALSE(platform::copyFile(source, source));
+  expectEqualFiles(getFilePath("file1.txt"), source);
+
+#ifndef _WIN32
+  const std::string hardlink = "CopyFileStageTest_same_link.txt";
+  ASSERT_EQ(0, link(source.c_str(), hardlink.c_str()));
+  EXPECT_FALSE(platform::copyFile(source, hardlink));
+  expectEqualFiles(getFilePath("file1.txt"), hardlink);
+  EXPECT_TRUE(platform::removeFile(hardlink));
+#endif
+
+  EXPECT_TRUE(platform::removeFile(source));
+}
+
+#ifndef _WIN32
+TEST(CopyFileStageTest, permissions)
+{
+  const std::string source = "CopyFileStageTest_mode.sh";
+  const std::string target = "CopyFileStageTest_mode_copy.sh";
+
+  ASSERT_TRUE(platform::copyFile(getFilePath("file1.txt"), source));
+  ASSERT_EQ(0, chmod(source.c_str(), 0750));
+
+  ASSERT_TRUE(platform::copyFile(source, target));
+
+  struct stat info;
+  ASSERT_EQ(0, stat(target.c_str(), &info));
+  EXPECT_EQ(0750u, static_cast<unsigned>(info.st_mode & 07777));
+
+  EXPECT_TRUE(platform::removeFile(source));
+  EXPECT_TRUE(platform::removeFile(target));
+}
+#endif
@@ -19,6 +19,7 @@
 #include <teetime/stages/CollectorSink.h>
 #include <teetime/stages/Directory2Files.h>
 #include <teetime/File.h>
+#include <algorithm>
 
 using namespace teetime;
 
@@ -39,6 +40,17 @@ namespace
       connectPorts(producer->getOutputPort(), dir2files->getInputPort());
       connectPorts(dir2files->getOutputPort(), collector->getInputPort());
     }
+
+    Directory2FilesTestConfig(const std::string& directory, bool sorted, size_t numThreads)
+    {
+      auto producer = createStage<InitialElementProducer<std::string>>(directory);
+      auto dir2files = createStage<Directory2Files>(sorted, numThreads);
+      collector = createStage<CollectorSink<File>>();
+
+      declareStageActive(producer);
+      connectPorts(producer->getOutputPort(), dir2files->getInputPort());
+      connectPorts(dir2files->getOutputPort(), collector->getInputPort());
+    }
   };
 
   inline std::string getFilePath(const char* name)
@@ -64,3 +76,53 @@ TEST(Directory2FilesTest, simple)
   EXPECT_EQ(getFilePath("file2.txt"), files[5].path);
 }
 
+namespace
+{
+  std::vector<std::string> sortedPaths(const std::vector<File>& files)
+  {
+    std::vector<std::string> paths;
+    for (const auto& f : files)
+    {
+      paths.push_back(f.path);
+    }
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+  }
+
+  const std::vector<std::string> allFiles = {
+    getFilePath("dir1/dir2/file5.txt"),
+    getFilePath("dir1/file3.txt"),
+    getFilePath("dir1/file4.txt"),
+    getFilePath("dir3/file6.txt"),
+    getFilePath("file1.txt"),
+    getFilePath("file2.txt")
+  };
+}
+
+TEST(Directory2FilesTest, unsorted)
+{
+  Directory2FilesTestConfig config(TEETIME_LOCAL_TEST_DIR "/stages/Directory2FilesTest", false, 1);
+
+  config.executeBlocking();
+
+  EXPECT_EQ(allFiles, sortedPaths(config.collector->takeElements()));
+}
+
+TEST(Directory2FilesTest, parallel)
+{
+  Directory2FilesTestConfig config(TEETIME_LOCAL_TEST_DIR "/stages/Directory2FilesTest", false, 4);
+
+  config.executeBlocking();
+
+  EXPECT_EQ(allFiles, sortedPaths(config.collector->takeElements()));
+}
+
+TEST(Directory2FilesTest, missingDirectory)
+{
+  Directory2FilesTestConfig config(TEETIME_LOCAL_TEST_DIR "/stages/Directory2FilesTest/missing", false, 4);
+
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)0, config.collector->takeElements().size());
+}
@@ -0,0 +1,142 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/AbstractConsumerStage.h>
+#include <teetime/stages/DirectoryWatchProducer.h>
+#include <teetime/File.h>
+#include <teetime/platform.h>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace teetime;
+
+namespace
+{
+  const std::string watchDir = "DirectoryWatchProducerTest_dir";
+
+  /**
+   * Collects distinct paths and cancels the pipeline once all expected files have been seen.
+   */
+  class ExpectFilesStage : public AbstractConsumerStage<File>
+  {
+  public:
+    explicit ExpectFilesStage(size_t numExpected)
+      : AbstractConsumerStage<File>("ExpectFilesStage")
+      , m_numExpected(numExpected)
+    {
+    }
+
+    std::set<std::string> paths()
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_paths;
+    }
+
+  private:
+    virtual void execute(File&& value) override
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_paths.insert(value.path);
+
+      if (m_paths.size() == m_numExpected)
+      {
+        cancel();
+      }
+    }
+
+    size_t                m_numExpected;
+    std::mutex            m_mutex;
+    std::set<std::string> m_paths;
+  };
+
+  class DirectoryWatchProducerTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<ExpectFilesStage> consumer;
+
+    explicit DirectoryWatchProducerTestConfig(size_t numExpected)
+    {
+      auto producer = createStage<DirectoryWatchProducer>(watchDir, 10);
+      consumer = createStage<ExpectFilesStage>(numExpected);
+
+      declareStageActive(producer);
+      connectPorts(producer->getOutputPort(), consumer->getInputPort());
+    }
+  };
+
+  void writeFile(const std::string& path)
+  {
+    auto file = platform::createFile(path.c_str(), false);
+    ASSERT_NE(platform::InvalidFileHandle, file);
+    ASSERT_EQ((size_t)5, platform::writeFile(file, 0, "hello", 5));
+    platform::closeFile(file);
+  }
+}
+
+TEST(DirectoryWatchProducerTest, initialScanAndEvents)
+{
+  platform::createDirectory(watchDir);
+  writeFile(watchDir + "/existing.txt");
+
+  DirectoryWatchProducerTestConfig config(4);
+
+  std::thread writer([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    writeFile(watchDir + "/new.txt");
+
+    //files of new sub directories are picked up, even if written before the directory is watched
+    platform::createDirectory(watchDir + "/sub");
+    writeFile(watchDir + "/sub/nested.txt");
+
+    //moved into watched tree
+    writeFile("DirectoryWatchProducerTest_moved.txt");
+    std::rename("DirectoryWatchProducerTest_moved.txt", (watchDir + "/moved.txt").c_str());
+  });
+
+  //don't hang forever, if events get lost
+  std::thread watchdog([&]() {
+    for (int i = 0; i < 100 && config.consumer->paths().size() < 4; ++i)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    config.cancel();
+  });
+
+  config.executeBlocking();
+  writer.join();
+  watchdog.join();
+
+  std::set<std::string> expected = {
+    watchDir + "/existing.txt",
+    watchDir + "/new.txt",
+    watchDir + "/sub/nested.txt",
+    watchDir + "/moved.txt"
+  };
+
+  EXPECT_EQ(expected, config.consumer->paths());
+
+  for (const auto& path : expected)
+  {
+    EXPECT_TRUE(platform::removeFile(path));
+  }
+
+  EXPECT_TRUE(platform::removeDirectory(watchDir, true));
+}
@@ -0,0 +1,117 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/EncodeImage.h>
+#include <teetime/stages/ReadImage.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/QoiCodec.h>
+#include <teetime/Image.h>
+#include <cstring>
+
+using namespace teetime;
+
+namespace
+{
+  inline std::string getFilePath(const std::string& name)
+  {
+    return std::string(TEETIME_LOCAL_TEST_DIR "/stages/ReadImageTest/") + name;
+  }
+
+  class EncodeImageTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<Image>> images;
+
+    EncodeImageTestConfig(const std::vector<Image>& input, ImageFileFormat format)
+    {
+      auto producer = createStage<InitialElementProducer<Image>>(input);
+      auto encode = createStage<EncodeImage>(format);
+      auto decode = createStage<ReadImage>();
+      images = createStage<CollectorSink<Image>>();
+
+      declareStageActive(producer);
+      connectPorts(producer->getOutputPort(), encode->getInputPort());
+      connectPorts(encode->getOutputPort(), decode->getInputPort());
+      connectPorts(decode->getOutputPort(), images->getInputPort());
+    }
+  };
+
+  class EncodeImagePathConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<FileBuffer>> buffers;
+
+    EncodeImagePathConfig(const std::vector<Image>& input, ImageFileFormat format)
+    {
+      auto producer = createStage<InitialElementProducer<Image>>(input);
+      auto encode = createStage<EncodeImage>(format);
+      buffers = createStage<CollectorSink<FileBuffer>>();
+
+      declareStageActive(producer);
+      connectPorts(producer->getOutputPort(), encode->getInputPort());
+      connectPorts(encode->getOutputPort(), buffers->getInputPort());
+    }
+  };
+}
+
+TEST(EncodeImageTest, roundtrip)
+{
+  Image lena;
+  ASSERT_TRUE(lena.loadFromFile(getFilePath("lena.png")));
+
+  const ImageFileFormat formats[] = { ImageFileFormat::Qoi, ImageFileFormat::Png, ImageFileFormat::Tga, ImageFileFormat::Bmp };
+
+  for (ImageFileFormat format : formats)
+  {
+    EncodeImageTestConfig config({ lena }, format);
+    config.executeBlocking();
+
+    auto images = config.images->takeElements();
+    ASSERT_EQ((size_t)1, images.size());
+    ASSERT_EQ(lena.getWidth(), images[0].getWidth());
+    ASSERT_EQ(lena.getHeight(), images[0].getHeight());
+
+    //bmp has no alpha channel
+    if (format != ImageFileFormat::Bmp)
+    {
+      EXPECT_EQ(0, memcmp(lena.getPixels(), images[0].getPixels(), lena.getWidth() * lena.getHeight() * 4));
+    }
+  }
+}
+
+TEST(EncodeImageTest, path)
+{
+  Image image;
+  image.setSize(4, 4);
+  memset(image.getPixels(), 0, 4 * 4 * 4);
+
+  std::vector<Image> input(3, image);
+  ASSERT_TRUE(input[0].loadFromFile(getFilePath("lena.png")));
+  ASSERT_TRUE(input[1].loadFromFile(getFilePath("lena.jpg")));
+
+  EncodeImagePathConfig config(input, ImageFileFormat::Qoi);
+  config.executeBlocking();
+
+  auto buffers = config.buffers->takeElements();
+  ASSERT_EQ((size_t)3, buffers.size());
+  EXPECT_EQ(getFilePath("lena.qoi"), buffers[0].path);
+  EXPECT_EQ(getFilePath("lena.qoi"), buffers[1].path);
+  EXPECT_EQ(".qoi", buffers[2].path);
+  EXPECT_TRUE(isQoi(buffers[2].bytes.data(), buffers[2].bytes.size()));
+}
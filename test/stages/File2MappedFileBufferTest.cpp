@@ -0,0 +1,119 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/File2MappedFileBuffer.h>
+#include <teetime/stages/Md5Hashing.h>
+#include <teetime/BufferedFile.h>
+#include <teetime/File.h>
+#include <teetime/MappedFileBuffer.h>
+#include <teetime/Md5Hash.h>
+
+using namespace teetime;
+
+namespace
+{
+  inline std::string getFilePath(const std::string& name)
+  {
+    //reuse test data of File2FileBuffer
+    return std::string(TEETIME_LOCAL_TEST_DIR "/stages/File2FileBufferTest/") + name;
+  }
+
+  class File2MappedFileBufferTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<MappedFileBuffer>> collector;
+
+    explicit File2MappedFileBufferTestConfig(const std::vector<File>& files)
+    {
+      auto producer = createStage<InitialElementProducer<File>>(files);
+      auto file2buffer = createStage<File2MappedFileBuffer>();
+      collector = createStage<CollectorSink<MappedFileBuffer>>();
+
+      declareStageActive(producer);
+      connectPorts(producer->getOutputPort(), file2buffer->getInputPort());
+      connectPorts(file2buffer->getOutputPort(), collector->getInputPort());
+    }
+  };
+}
+
+TEST(File2MappedFileBuffer, simple)
+{
+  File2MappedFileBufferTestConfig config({ File(getFilePath("file1.txt")) });
+
+  config.executeBlocking();
+
+  std::vector<MappedFileBuffer> files = config.collector->takeElements();
+
+  ASSERT_EQ((size_t)1, files.size());
+  EXPECT_EQ(getFilePath("file1.txt"), files[0].path);
+  ASSERT_EQ((size_t)11, files[0].size());
+  EXPECT_EQ(0, strncmp("hello world", (const char*)files[0].data(), files[0].size()));
+}
+
+TEST(File2MappedFileBuffer, empty)
+{
+  File2MappedFileBufferTestConfig config({ File(getFilePath("empty.txt")) });
+
+  config.executeBlocking();
+
+  std::vector<MappedFileBuffer> files = config.collector->takeElements();
+
+  ASSERT_EQ((size_t)1, files.size());
+  EXPECT_EQ(getFilePath("empty.txt"), files[0].path);
+  EXPECT_EQ((size_t)0, files[0].size());
+}
+
+TEST(File2MappedFileBuffer, missing)
+{
+  File2MappedFileBufferTestConfig config({ File(getFilePath("missing.txt")), File(getFilePath("file1.txt")) });
+
+  config.executeBlocking();
+
+  std::vector<MappedFileBuffer> files = config.collector->takeElements();
+
+  ASSERT_EQ((size_t)1, files.size());
+  EXPECT_EQ(getFilePath("file1.txt"), files[0].path);
+}
+
+TEST(File2MappedFileBuffer, sharedMapping)
+{
+  MappedFileBuffer copy;
+
+  {
+    MappedFileBuffer buffer;
+    ASSERT_TRUE(buffer.map(getFilePath("file1.txt")));
+    copy = buffer;
+  }
+
+  //mapping must still be valid, after original buffer was destroyed
+  ASSERT_EQ((size_t)11, copy.size());
+  EXPECT_EQ(0, strncmp("hello world", (const char*)copy.data(), copy.size()));
+  EXPECT_EQ(Md5Hash::generate("hello world"), md5hash(copy));
+}
+
+TEST(File2MappedFileBuffer, bufferedFile)
+{
+  BufferedFile file;
+  ASSERT_TRUE(file.map(getFilePath("file1.txt")));
+  ASSERT_EQ((size_t)11, file.size());
+  EXPECT_EQ(0, strncmp("hello world", (const char*)file.data(), file.size()));
+
+  ASSERT_TRUE(file.load(getFilePath("empty.txt")));
+  EXPECT_EQ((size_t)0, file.size());
+}
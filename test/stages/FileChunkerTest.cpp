@@ -0,0 +1,142 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/FileChunker.h>
+#include <teetime/BufferedFile.h>
+#include <teetime/File.h>
+#include <teetime/FileChunk.h>
+
+using namespace teetime;
+
+namespace
+{
+  inline std::string getFilePath(const std::string& name)
+  {
+    return std::string(TEETIME_LOCAL_TEST_DIR "/stages/") + name;
+  }
+
+  class FileChunkerTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<FileChunk>> collector;
+
+    FileChunkerTestConfig(const std::string& path, size_t chunkSize, int delimiter = -1)
+    {
+      auto producer = createStage<InitialElementProducer<File>>(File(path));
+      auto chunker = createStage<FileChunker>(chunkSize);
+      collector = createStage<CollectorSink<FileChunk>>();
+
+      if (delimiter >= 0)
+      {
+        chunker->setDelimiter(static_cast<uint8>(delimiter));
+      }
+
+      declareStageActive(producer);
+      declareStageActive(collector);
+
+      connectPorts(producer->getOutputPort(), chunker->getInputPort());
+      connectPorts(chunker->getOutputPort(), collector->getInputPort());
+    }
+  };
+
+  std::vector<uint8> concat(const std::vector<FileChunk>& chunks)
+  {
+    std::vector<uint8> bytes;
+    for (const auto& c : chunks)
+    {
+      EXPECT_EQ(bytes.size(), c.offset);
+      bytes.insert(bytes.end(), c.bytes.begin(), c.bytes.end());
+    }
+    return bytes;
+  }
+}
+
+TEST(FileChunkerTest, fixedSize)
+{
+  const auto path = getFilePath("ReadImageTest/lena.tga");
+  FileChunkerTestConfig config(path, 100000);
+
+  config.executeBlocking();
+
+  auto chunks = config.collector->takeElements();
+
+  BufferedFile file;
+  ASSERT_TRUE(file.load(path));
+
+  ASSERT_EQ((file.size() + 99999) / 100000, chunks.size());
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    EXPECT_EQ(path, chunks[i].path);
+    EXPECT_EQ(i + 1 == chunks.size(), chunks[i].last);
+  }
+
+  auto bytes = concat(chunks);
+  ASSERT_EQ(file.size(), bytes.size());
+  EXPECT_EQ(0, memcmp(file.data(), bytes.data(), bytes.size()));
+}
+
+TEST(FileChunkerTest, empty)
+{
+  FileChunkerTestConfig config(getFilePath("File2FileBufferTest/empty.txt"), 100);
+
+  config.executeBlocking();
+
+  auto chunks = config.collector->takeElements();
+
+  ASSERT_EQ((size_t)1, chunks.size());
+  EXPECT_EQ((size_t)0, chunks[0].bytes.size());
+  EXPECT_TRUE(chunks[0].last);
+}
+
+TEST(FileChunkerTest, missing)
+{
+  FileChunkerTestConfig config(getFilePath("missing.txt"), 100);
+
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)0, config.collector->takeElements().size());
+}
+
+TEST(FileChunkerTest, delimiter)
+{
+  FileChunkerTestConfig config(getFilePath("FileChunkerTest/lines.txt"), 16, '\n');
+
+  config.executeBlocking();
+
+  auto chunks = config.collector->takeElements();
+
+  //lines longer than a chunk are split, all other chunks end with a complete line
+  std::vector<std::string> expected = {
+    "first line\n",
+    "second line\n",
+    "third\n",
+    "fourth line is a",
+    " bit longer\n",
+    "fifth\n"
+  };
+
+  ASSERT_EQ(expected.size(), chunks.size());
+  for (size_t i = 0; i < chunks.size(); ++i)
+  {
+    EXPECT_EQ(expected[i], std::string(chunks[i].bytes.begin(), chunks[i].bytes.end()));
+  }
+
+  EXPECT_TRUE(chunks.back().last);
+  concat(chunks);
+}
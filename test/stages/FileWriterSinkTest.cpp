@@ -0,0 +1,181 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/FileWriterSink.h>
+#include <teetime/stages/AbstractFilterStage.h>
+#include <teetime/BufferedFile.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/platform.h>
+#include <chrono>
+#include <thread>
+
+using namespace teetime;
+
+namespace
+{
+  const char* outputDir = "FileWriterSinkTest_output";
+
+  std::vector<FileBuffer> createBuffers(size_t num)
+  {
+    platform::createDirectory(outputDir);
+
+    std::vector<FileBuffer> buffers;
+    for (size_t i = 0; i < num; ++i)
+    {
+      FileBuffer buffer;
+      buffer.path = std::string(outputDir) + "/file" + std::to_string(i) + ".bin";
+
+      //sizes of 0 to about 20k, mostly not aligned to any block size
+      buffer.bytes.resize(i * 997);
+      for (size_t j = 0; j < buffer.bytes.size(); ++j)
+      {
+        buffer.bytes[j] = static_cast<uint8>(i + j);
+      }
+
+      buffers.push_back(std::move(buffer));
+    }
+
+    return buffers;
+  }
+
+  class FileWriterSinkTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<FileWriterSink> writer;
+
+    FileWriterSinkTestConfig(const std::vector<FileBuffer>& buffers, bool directIO, bool sync)
+    {
+      auto producer = createStage<InitialElementProducer<FileBuffer>>(buffers);
+      writer = createStage<FileWriterSink>(16 * 1024);
+      writer->setDirectIO(directIO);
+      writer->setSync(sync);
+
+      declareStageActive(producer);
+      declareStageActive(writer);
+
+      connectPorts(producer->getOutputPort(), writer->getInputPort());
+    }
+  };
+
+  void checkAndRemoveFiles(const std::vector<FileBuffer>& buffers)
+  {
+    for (const auto& b : buffers)
+    {
+      BufferedFile file;
+      ASSERT_TRUE(file.load(b.path));
+      ASSERT_EQ(b.bytes.size(), file.size());
+      EXPECT_EQ(0, memcmp(b.bytes.data(), file.data(), file.size()));
+
+      EXPECT_TRUE(platform::removeFile(b.path));
+    }
+
+    EXPECT_TRUE(platform::removeDirectory(outputDir, false));
+  }
+}
+
+TEST(FileWriterSinkTest, simple)
+{
+  auto buffers = createBuffers(20);
+
+  FileWriterSinkTestConfig config(buffers, false, false);
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)20, config.writer->numFilesWritten());
+  EXPECT_EQ((size_t)0, config.writer->numFilesFailed());
+  checkAndRemoveFiles(buffers);
+}
+
+TEST(FileWriterSinkTest, directIOAndSync)
+{
+  auto buffers = createBuffers(20);
+
+  FileWriterSinkTestConfig config(buffers, true, true);
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)20, config.writer->numFilesWritten());
+  EXPECT_EQ((size_t)0, config.writer->numFilesFailed());
+  checkAndRemoveFiles(buffers);
+}
+
+TEST(FileWriterSinkTest, invalidPath)
+{
+  FileBuffer buffer;
+  buffer.path = std::string(outputDir) + "/missing/file.bin";
+  buffer.bytes.resize(10);
+
+  FileWriterSinkTestConfig config({ buffer }, false, false);
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)0, config.writer->numFilesWritten());
+  EXPECT_EQ((size_t)1, config.writer->numFilesFailed());
+}
+
+namespace
+{
+  //forwards buffers slower than the writer can write them
+  class SlowForwardStage : public AbstractFilterStage<FileBuffer>
+  {
+  public:
+    SlowForwardStage()
+      : AbstractFilterStage<FileBuffer>("SlowForwardStage")
+    {
+    }
+
+  private:
+    virtual void execute(FileBuffer&& buffer) override
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      getOutputPort().send(std::move(buffer));
+    }
+  };
+
+  class SlowProducerConfig : public Configuration
+  {
+  public:
+    shared_ptr<FileWriterSink> writer;
+
+    explicit SlowProducerConfig(const std::vector<FileBuffer>& buffers)
+    {
+      auto producer = createStage<InitialElementProducer<FileBuffer>>(buffers);
+      auto slow = createStage<SlowForwardStage>();
+      writer = createStage<FileWriterSink>();
+
+      declareStageActive(producer);
+      declareStageActive(slow);
+      declareStageActive(writer);
+
+      connectPorts(producer->getOutputPort(), slow->getInputPort());
+      connectPorts(slow->getOutputPort(), writer->getInputPort());
+    }
+  };
+}
+
+TEST(FileWriterSinkTest, slowProducer)
+{
+  auto buffers = createBuffers(30);
+
+  SlowProducerConfig config(buffers);
+  config.executeBlocking();
+
+  EXPECT_EQ((size_t)30, config.writer->numFilesWritten());
+
+  //files trickling in are still coalesced, instead of one batch per file
+  EXPECT_GE(config.writer->numBatches(), (size_t)1);
+  EXPECT_LE(config.writer->numBatches(), (size_t)15);
+  checkAndRemoveFiles(buffers);
+}
@@ -0,0 +1,204 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/ImageFilterStages.h>
+#include <teetime/stages/SplitImage.h>
+#include <teetime/stages/GatherImage.h>
+#include <teetime/ImageFilters.h>
+#include "TestImage.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+using namespace teetime;
+using namespace teetime::test;
+
+namespace
+{
+  class ImageFilterTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<Image>> collector;
+
+    ImageFilterTestConfig(const std::vector<Image>& images, float gamma)
+    {
+      auto producer = createStage<InitialElementProducer<Image>>(images);
+      auto blur = createStage<GaussianBlurStage>(1.0f);
+      auto sharpen = createStage<SharpenStage>(1.0f, 0.5f);
+      auto gammaStage = createStage<GammaStage>(gamma);
+      auto gray = createStage<GrayscaleStage>();
+      collector = createStage<CollectorSink<Image>>();
+
+      declareStageActive(producer);
+
+      connectPorts(producer->getOutputPort(), blur->getInputPort());
+      connectPorts(blur->getOutputPort(), sharpen->getInputPort());
+      connectPorts(sharpen->getOutputPort(), gammaStage->getInputPort());
+      connectPorts(gammaStage->getOutputPort(), gray->getInputPort());
+      connectPorts(gray->getOutputPort(), collector->getInputPort());
+    }
+  };
+
+  template<typename TTileStage>
+  class TileFilterTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<Image>> collector;
+
+    template<typename... TArgs>
+    TileFilterTestConfig(const std::vector<Image>& images, size_t halo, TArgs... args)
+    {
+      auto producer = createStage<InitialElementProducer<Image>>(images);
+      auto split = createStage<SplitImage>(16, halo, ImageTileTarget::SameSize);
+      auto filter = createStage<TTileStage>(args...);
+      auto gather = createStage<GatherImage>();
+      collector = createStage<CollectorSink<Image>>();
+
+      declareStageActive(producer);
+
+      connectPorts(producer->getOutputPort(), split->getInputPort());
+      connectPorts(split->getOutputPort(), filter->getInputPort());
+      connectPorts(filter->getOutputPort(), gather->getInputPort());
+      connectPorts(gather->getOutputPort(), collector->getInputPort());
+    }
+  };
+
+  template<typename F>
+  Image filterWholeImage(const Image& image, F filter)
+  {
+    PlanarImage src;
+    PlanarImage dst;
+    src.deinterleave(image);
+    filter(src, dst);
+
+    Image result;
+    dst.interleave(result);
+    return result;
+  }
+
+  void expectSameImages(const std::vector<Image>& expected, const std::vector<Image>& results)
+  {
+    ASSERT_EQ(expected.size(), results.size());
+
+    for (const auto& image : expected)
+    {
+      auto it = std::find_if(results.begin(), results.end(), [&](const Image& r) {
+        return r.getWidth() == image.getWidth() && r.getHeight() == image.getHeight();
+      });
+
+      ASSERT_NE(results.end(), it);
+      EXPECT_EQ(0, memcmp(image.getRgba(), it->getRgba(), image.getWidth() * image.getHeight() * sizeof(Image::Rgba)));
+    }
+  }
+
+  class GammaTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<Image>> collector;
+
+    GammaTestConfig(const std::vector<Image>& images, float gamma)
+    {
+      auto producer = createStage<InitialElementProducer<Image>>(images);
+      auto gammaStage = createStage<GammaStage>(gamma);
+      collector = createStage<CollectorSink<Image>>();
+
+      declareStageActive(producer);
+
+      connectPorts(producer->getOutputPort(), gammaStage->getInputPort());
+      connectPorts(gammaStage->getOutputPort(), collector->getInputPort());
+    }
+  };
+}
+
+TEST(ImageFilterStagesTest, pipeline)
+{
+  std::vector<Image> images = { createImage(40, 30), createImage(1, 1) };
+
+  ImageFilterTestConfig config(images, 2.2f);
+  config.executeBlocking();
+
+  auto results = config.collector->takeElements();
+  ASSERT_EQ(images.size(), results.size());
+
+  for (size_t i = 0; i < images.size(); ++i)
+  {
+    EXPECT_EQ(PixelFormat::GrayAlpha8, results[i].getFormat());
+    EXPECT_EQ(images[i].getWidth(), results[i].getWidth());
+    EXPECT_EQ(images[i].getHeight(), results[i].getHeight());
+  }
+}
+
+TEST(ImageFilterStagesTest, gamma)
+{
+  std::vector<Image> images = { createImage(16, 16) };
+
+  GammaTestConfig config(images, 2.0f);
+  config.executeBlocking();
+
+  auto results = config.collector->takeElements();
+  ASSERT_EQ((size_t)1, results.size());
+
+  const Image& image = images[0];
+  const Image& result = results[0];
+  ASSERT_EQ(PixelFormat::Rgba8, result.getFormat());
+
+  for (size_t i = 0; i < 16 * 16; ++i)
+  {
+    const Image::Rgba& a = image.getRgba()[i];
+    const Image::Rgba& b = result.getRgba()[i];
+
+    EXPECT_NEAR(std::sqrt(a.r / 255.0f) * 255.0f, b.r, 0.5f);
+    EXPECT_EQ(a.a, b.a);
+  }
+}
+
+TEST(ImageFilterStagesTest, tiledBlur)
+{
+  const float sigma = 1.5f;
+  std::vector<Image> images = { createImage(70, 45), createImage(33, 16), createImage(1, 1) };
+
+  std::vector<Image> expected;
+  for (const auto& image : images)
+  {
+    expected.push_back(filterWholeImage(image, [&](const PlanarImage& src, PlanarImage& dst) { gaussianBlur(src, dst, sigma); }));
+  }
+
+  TileFilterTestConfig<GaussianBlurTileStage> config(images, gaussianRadius(sigma), sigma);
+  config.executeBlocking();
+
+  expectSameImages(expected, config.collector->takeElements());
+}
+
+TEST(ImageFilterStagesTest, tiledSharpen)
+{
+  const float sigma = 1.0f;
+  const float amount = 0.5f;
+  std::vector<Image> images = { createImage(70, 45), createImage(1, 1) };
+
+  std::vector<Image> expected;
+  for (const auto& image : images)
+  {
+    expected.push_back(filterWholeImage(image, [&](const PlanarImage& src, PlanarImage& dst) { sharpen(src, dst, sigma, amount); }));
+  }
+
+  TileFilterTestConfig<SharpenTileStage> config(images, gaussianRadius(sigma), sigma, amount);
+  config.executeBlocking();
+
+  expectSameImages(expected, config.collector->takeElements());
+}
@@ -0,0 +1,127 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/DistributorStage.h>
+#include <teetime/stages/MergerStage.h>
+#include <teetime/stages/SplitImage.h>
+#include <teetime/stages/GatherImage.h>
+#include <teetime/stages/ResizeImage.h>
+#include <teetime/ImageKernels.h>
+#include <teetime/ImageTile.h>
+#include "TestImage.h"
+#include <cstring>
+
+using namespace teetime;
+using namespace teetime::test;
+
+namespace
+{
+  Image downsample(const Image& image)
+  {
+    Image result;
+    result.setSize(halfSize(image.getWidth()), halfSize(image.getHeight()));
+    downsample2x2(image.getRgba(), image.getWidth(), image.getHeight(), image.getWidth(), result.getRgba(), result.getWidth());
+    return result;
+  }
+
+  class ImageTileTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<Image>> collector;
+
+    ImageTileTestConfig(const std::vector<Image>& images, int numWorkers)
+    {
+      auto producer = createStage<InitialElementProducer<Image>>(images);
+      auto split = createStage<SplitImage>(16, 0, ImageTileTarget::HalfSize);
+      auto distributor = createStage<DistributorStage<ImageTile>>();
+      auto merger = createStage<MergerStage<ImageTile>>();
+      auto gather = createStage<GatherImage>();
+      collector = createStage<CollectorSink<Image>>();
+
+      declareStageActive(producer);
+      declareStageActive(merger);
+
+      connectPorts(producer->getOutputPort(), split->getInputPort());
+      connectPorts(split->getOutputPort(), distributor->getInputPort());
+
+      for (int i = 0; i < numWorkers; ++i)
+      {
+        auto worker = createStage<DownsampleImageTile>();
+        declareStageActive(worker);
+
+        connectPorts(distributor->getNewOutputPort(), worker->getInputPort());
+        connectPorts(worker->getOutputPort(), merger->getNewInputPort());
+      }
+
+      connectPorts(merger->getOutputPort(), gather->getInputPort());
+      connectPorts(gather->getOutputPort(), collector->getInputPort());
+    }
+  };
+}
+
+TEST(ImageTileTest, createTiles)
+{
+  auto image = std::make_shared<const Image>(createImage(40, 20));
+
+  auto tiles = createImageTiles(image, 16, 2, ImageTileTarget::SameSize);
+  ASSERT_EQ((size_t)6, tiles.size());
+  EXPECT_EQ(tiles[0].target, tiles[5].target);
+
+  //inner tile: halo on all sides
+  EXPECT_EQ((size_t)16, tiles[1].x);
+  EXPECT_EQ((size_t)14, tiles[1].sourceX);
+  EXPECT_EQ((size_t)20, tiles[1].sourceWidth);
+  EXPECT_EQ((size_t)0, tiles[1].sourceY);
+  EXPECT_EQ((size_t)18, tiles[1].sourceHeight);
+
+  //last tile: clamped to image
+  EXPECT_EQ((size_t)8, tiles[5].width);
+  EXPECT_EQ((size_t)4, tiles[5].height);
+  EXPECT_EQ((size_t)14, tiles[5].sourceY);
+  EXPECT_EQ((size_t)6, tiles[5].sourceHeight);
+
+  auto halfTiles = createImageTiles(image, 16, 0, ImageTileTarget::HalfSize);
+  ASSERT_EQ((size_t)2, halfTiles.size());
+  EXPECT_EQ((size_t)20, halfTiles[0].target->getWidth());
+  EXPECT_EQ((size_t)32, halfTiles[1].sourceX);
+  EXPECT_EQ((size_t)8, halfTiles[1].sourceWidth);
+}
+
+TEST(ImageTileTest, farm)
+{
+  std::vector<Image> images = { createImage(70, 45), createImage(33, 33), createImage(1, 1) };
+
+  ImageTileTestConfig config(images, 3);
+  config.executeBlocking();
+
+  auto results = config.collector->takeElements();
+  ASSERT_EQ(images.size(), results.size());
+
+  for (const auto& image : images)
+  {
+    Image expected = downsample(image);
+
+    auto it = std::find_if(results.begin(), results.end(), [&](const Image& r) {
+      return r.getWidth() == expected.getWidth() && r.getHeight() == expected.getHeight();
+    });
+
+    ASSERT_NE(results.end(), it);
+    EXPECT_EQ(0, memcmp(expected.getRgba(), it->getRgba(), expected.getWidth() * expected.getHeight() * sizeof(Image::Rgba)));
+  }
+}
@@ -35,7 +35,7 @@ namespace test {
   private:
     virtual void execute() override
     {
-      for(int i=0; i<numValues; ++i)
+      for(int i=0; i<numValues && !isCanceled(); ++i)
       {
         getOutputPort().send(startValue + i);
       }
@@ -0,0 +1,181 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/DistributorStage.h>
+#include <teetime/stages/MergerStage.h>
+#include <teetime/stages/FunctionStage.h>
+#include <teetime/stages/LargestFirstStage.h>
+#include <teetime/WorkCost.h>
+#include <teetime/File.h>
+#include <teetime/FileBuffer.h>
+#include <teetime/MappedFileBuffer.h>
+#include <teetime/Image.h>
+#include <algorithm>
+
+using namespace teetime;
+
+namespace
+{
+  inline std::string getFilePath(const std::string& name)
+  {
+    return std::string(TEETIME_LOCAL_TEST_DIR "/stages/ReadImageTest/") + name;
+  }
+
+  //the value of an int is its cost
+  struct IntCost
+  {
+    uint64 operator()(int value) const
+    {
+      return static_cast<uint64>(value);
+    }
+  };
+
+  class LargestFirstTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<int>> collector;
+
+    LargestFirstTestConfig(const std::vector<int>& values, size_t lookahead)
+    {
+      auto producer = createStage<InitialElementProducer<int>>(values);
+      auto largestFirst = createStage<LargestFirstStage<int, IntCost>>(lookahead);
+      collector = createStage<CollectorSink<int>>();
+
+      declareStageActive(producer);
+      declareStageActive(largestFirst);
+
+      connectPorts(producer->getOutputPort(), largestFirst->getInputPort());
+      connectPorts(largestFirst->getOutputPort(), collector->getInputPort());
+    }
+  };
+
+  class LargestFirstFarmConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<int>> collector;
+
+    LargestFirstFarmConfig(const std::vector<int>& values, int numWorkers)
+    {
+      auto producer = createStage<InitialElementProducer<int>>(values);
+      auto largestFirst = createStage<LargestFirstStage<int, IntCost>>(values.size());
+      auto distributor = createStage<DistributorStage<int, LeastLoadedDistribution<int, IntCost>>>();
+      auto merger = createStage<MergerStage<int>>();
+      collector = createStage<CollectorSink<int>>();
+
+      declareStageActive(producer);
+      declareStageActive(largestFirst);
+      declareStageActive(merger);
+
+      connectPorts(producer->getOutputPort(), largestFirst->getInputPort());
+      connectPorts(largestFirst->getOutputPort(), distributor->getInputPort());
+
+      for (int i = 0; i < numWorkers; ++i)
+      {
+        auto worker = createStageFromLambda([](int value) { return value * 2; });
+        declareStageActive(worker);
+
+        connectPorts(distributor->getNewOutputPort(), worker->getInputPort(), 2);
+        connectPorts(worker->getOutputPort(), merger->getNewInputPort());
+      }
+
+      connectPorts(merger->getOutputPort(), collector->getInputPort());
+    }
+  };
+}
+
+TEST(LargestFirstStageTest, lookahead)
+{
+  LargestFirstTestConfig config({ 1, 5, 3, 9, 2, 8, 7 }, 3);
+  config.executeBlocking();
+
+  const std::vector<int> expected = { 9, 5, 8, 7, 3, 2, 1 };
+  EXPECT_EQ(expected, config.collector->takeElements());
+}
+
+TEST(LargestFirstStageTest, sorted)
+{
+  std::vector<int> values = { 4, 1, 4, 6, 0, 2, 6, 3 };
+
+  LargestFirstTestConfig config(values, 100);
+  config.executeBlocking();
+
+  std::sort(values.begin(), values.end(), [](int a, int b) { return a > b; });
+  EXPECT_EQ(values, config.collector->takeElements());
+}
+
+TEST(LargestFirstStageTest, passThrough)
+{
+  const std::vector<int> values = { 1, 5, 3, 9 };
+
+  LargestFirstTestConfig config(values, 0);
+  config.executeBlocking();
+
+  EXPECT_EQ(values, config.collector->takeElements());
+}
+
+TEST(LargestFirstStageTest, farm)
+{
+  std::vector<int> values;
+  for (int i = 0; i < 100; ++i)
+  {
+    values.push_back((i * 37) % 101);
+  }
+
+  LargestFirstFarmConfig config(values, 4);
+  config.executeBlocking();
+
+  auto results = config.collector->takeElements();
+  std::sort(results.begin(), results.end());
+  std::sort(values.begin(), values.end());
+
+  ASSERT_EQ(values.size(), results.size());
+  for (size_t i = 0; i < values.size(); ++i)
+  {
+    EXPECT_EQ(values[i] * 2, results[i]);
+  }
+}
+
+TEST(LargestFirstStageTest, cost)
+{
+  const File png(getFilePath("lena.png"));
+  const File jpg(getFilePath("lena.jpg"));
+  const File missing(getFilePath("missing.png"));
+
+  FileBuffer buffer;
+  EXPECT_EQ(0u, FileSizeCost()(missing));
+  EXPECT_EQ(512u * 512u, ImagePixelCost()(png));
+  EXPECT_EQ(512u * 512u, ImagePixelCost()(jpg));
+
+  MappedFileBuffer mapped;
+  ASSERT_TRUE(mapped.map(png.path));
+  EXPECT_EQ(mapped.size(), FileSizeCost()(png));
+  EXPECT_EQ(512u * 512u, ImagePixelCost()(mapped));
+
+  buffer.bytes.assign(mapped.data(), mapped.data() + mapped.size());
+  EXPECT_EQ(512u * 512u, ImagePixelCost()(buffer));
+
+  //not an image: file size
+  buffer.bytes.assign(100, 'x');
+  EXPECT_EQ(100u, ImagePixelCost()(buffer));
+
+  Image image;
+  image.setSize(30, 20);
+  EXPECT_EQ(600u, ImagePixelCost()(image));
+  EXPECT_EQ(elementSize(image), ElementCost<Image>()(image));
+}
@@ -0,0 +1,117 @@
+/**
+* Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*         http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include <teetime/Configuration.h>
+#include <teetime/stages/InitialElementProducer.h>
+#include <teetime/stages/CollectorSink.h>
+#include <teetime/stages/MipChainStage.h>
+#include <teetime/ImageKernels.h>
+#include <teetime/Image.h>
+#include "TestImage.h"
+#include <cstring>
+
+using namespace teetime;
+using namespace teetime::test;
+
+namespace
+{
+  class MipChainStageTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<MipLevel>> levelOne;
+    shared_ptr<CollectorSink<MipLevel>> others;
+
+    explicit MipChainStageTestConfig(const std::vector<Image>& images)
+    {
+      auto producer = createStage<InitialElementProducer<Image>>(images);
+      auto mipChain = createStage<MipChainStage>();
+      levelOne = createStage<CollectorSink<MipLevel>>();
+      others = createStage<CollectorSink<MipLevel>>();
+
+      declareStageActive(producer);
+
+      connectPorts(producer->getOutputPort(), mipChain->getInputPort());
+      connectPorts(mipChain->getLevelOutputPort(1), levelOne->getInputPort());
+      connectPorts(mipChain->getOutputPort(), others->getInputPort());
+    }
+  };
+}
+
+TEST(MipChainStageTest, chainMatchesRepeatedHalving)
+{
+  const size_t sizes[][2] = { { 64, 64 }, { 37, 23 }, { 1, 9 }, { 100, 3 } };
+
+  for (const auto& size : sizes)
+  {
+    Image source = createImage(size[0], size[1], true);
+
+    std::vector<Image> levels;
+    createMipChain(source, levels);
+
+    const Image* previous = &source;
+    for (const auto& level : levels)
+    {
+      Image expected;
+      expected.setSize(halfSize(previous->getWidth()), halfSize(previous->getHeight()));
+      downsample2x2(previous->getRgba(), previous->getWidth(), previous->getHeight(), previous->getWidth(), expected.getRgba(), expected.getWidth());
+
+      ASSERT_EQ(expected.getWidth(), level.getWidth());
+      ASSERT_EQ(expected.getHeight(), level.getHeight());
+      ASSERT_EQ(0, memcmp(expected.getRgba(), level.getRgba(), level.getWidth() * level.getHeight() * sizeof(Image::Rgba)));
+
+      previous = &level;
+    }
+
+    ASSERT_FALSE(levels.empty());
+    EXPECT_EQ((size_t)1, levels.back().getWidth());
+    EXPECT_EQ((size_t)1, levels.back().getHeight());
+  }
+}
+
+TEST(MipChainStageTest, maxLevels)
+{
+  std::vector<Image> levels;
+  createMipChain(createImage(64, 64, true), levels, 2);
+
+  ASSERT_EQ((size_t)2, levels.size());
+  EXPECT_EQ((size_t)16, levels[1].getWidth());
+
+  createMipChain(Image(), levels);
+  EXPECT_TRUE(levels.empty());
+}
+
+TEST(MipChainStageTest, levelPorts)
+{
+  MipChainStageTestConfig config({ createImage(16, 8, true), createImage(4, 4, true) });
+  config.executeBlocking();
+
+  auto levelOne = config.levelOne->takeElements();
+  auto others = config.others->takeElements();
+
+  ASSERT_EQ((size_t)2, levelOne.size());
+  EXPECT_EQ(1u, levelOne[0].level);
+  EXPECT_EQ((size_t)8, levelOne[0].image.getWidth());
+  EXPECT_EQ((size_t)4, levelOne[0].image.getHeight());
+  EXPECT_EQ((size_t)2, levelOne[1].image.getWidth());
+
+  //16x8: levels 2 to 4, 4x4: level 2
+  ASSERT_EQ((size_t)4, others.size());
+  EXPECT_EQ(2u, others[0].level);
+  EXPECT_EQ(4u, others[2].level);
+  EXPECT_EQ((size_t)1, others[2].image.getWidth());
+  EXPECT_EQ(2u, others[3].level);
+  EXPECT_EQ((size_t)1, others[3].image.getWidth());
+}
@@ -18,10 +18,14 @@
 #include <teetime/stages/InitialElementProducer.h>
 #include <teetime/stages/CollectorSink.h>
 #include <teetime/stages/File2FileBuffer.h>
+#include <teetime/stages/File2MappedFileBuffer.h>
 #include <teetime/stages/ReadImage.h>
 #include <teetime/File.h>
 #include <teetime/FileBuffer.h>
 #include <teetime/Image.h>
+#include <teetime/PixelPool.h>
+#include <cstdio>
+#include <cstdlib>
 
 using namespace teetime;
 
@@ -37,11 +41,13 @@ namespace
   public:
     shared_ptr<CollectorSink<Image>> images;
 
-    explicit ReadImageTestConfig(const File& files)
+    explicit ReadImageTestConfig(const File& files, unsigned scale = 1, bool nativeFormat = false)
     {
       auto producer = createStage<InitialElementProducer<File>>(files);
       auto file2buffer = createStage<File2FileBuffer>();
       auto readImage = createStage<ReadImage>();
+      readImage->setScale(scale);
+      readImage->setNativeFormat(nativeFormat);
       images = createStage<CollectorSink<Image>>();
 
       declareStageActive(producer);
@@ -91,3 +97,175 @@ TEST(ReadImageTest, tga)
   EXPECT_EQ(getFilePath("lena.tga"), images[0].getFilename());
 }
 
+namespace
+{
+  class ReadMappedImageTestConfig : public Configuration
+  {
+  public:
+    shared_ptr<CollectorSink<Image>> images;
+
+    explicit ReadMappedImageTestConfig(const File& files)
+    {
+      auto producer = createStage<InitialElementProducer<File>>(files);
+      auto file2buffer = createStage<File2MappedFileBuffer>();
+      auto readImage = createStage<ReadMappedImage>();
+      images = createStage<CollectorSink<Image>>();
+
+      declareStageActive(producer);
+      connectPorts(producer->getOutputPort(), file2buffer->getInputPort());
+      connectPorts(file2buffer->getOutputPort(), readImage->getInputPort());
+      connectPorts(readImage->getOutputPort(), images->getInputPort());
+    }
+  };
+}
+
+TEST(ReadImageTest, mappedPng)
+{
+  ReadMappedImageTestConfig config(File(getFilePath("lena.png")));
+  config.executeBlocking();
+
+  auto images = config.images->takeElements();
+
+  ASSERT_EQ((size_t)1, images.size());
+  EXPECT_EQ((size_t)512, images[0].getHeight());
+  EXPECT_EQ((size_t)512, images[0].getWidth());
+  EXPECT_EQ(getFilePath("lena.png"), images[0].getFilename());
+}
+
+namespace
+{
+  //mean absolute difference of all channels
+  double meanDifference(const Image& a, const Image& b)
+  {
+    const uint8* pa = a.getPixels();
+    const uint8* pb = b.getPixels();
+    const size_t size = a.getWidth() * a.getHeight() * a.getChannels();
+
+    double sum = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+      sum += std::abs(pa[i] - pb[i]);
+    }
+    return sum / size;
+  }
+}
+
+TEST(ReadImageTest, jpgScaled)
+{
+  Image full;
+  ASSERT_TRUE(full.loadFromFile(getFilePath("lena.jpg")));
+
+  for (unsigned scale : { 2, 4, 8 })
+  {
+    ReadImageTestConfig config(File(getFilePath("lena.jpg")), scale);
+    config.executeBlocking();
+
+    auto images = config.images->takeElements();
+
+    ASSERT_EQ((size_t)1, images.size());
+    EXPECT_EQ((size_t)512 / scale, images[0].getHeight());
+    EXPECT_EQ((size_t)512 / scale, images[0].getWidth());
+    EXPECT_EQ(getFilePath("lena.jpg"), images[0].getFilename());
+
+    //reduced decoding approximates the box filtered full image
+    Image reference = full.resize(512 / scale, 512 / scale);
+    EXPECT_LT(meanDifference(reference, images[0]), 4.0);
+  }
+}
+
+TEST(ReadImageTest, jpgScaledPeakMemory)
+{
+  //components are decoded at the reduced size: besides the result, the decoder allocates less
+  //than a single full size (512x512) component plane
+  PixelPool& pool = PixelPool::instance();
+
+  for (unsigned scale : { 2, 4, 8 })
+  {
+    const size_t usedBefore = pool.usedBytes();
+    pool.resetPeakUsedBytes();
+
+    Image image;
+    ASSERT_TRUE(image.loadFromFile(getFilePath("lena.jpg"), scale));
+    ASSERT_EQ((size_t)512 / scale, image.getWidth());
+
+    const size_t resultSize = image.getWidth() * image.getHeight() * image.getChannels();
+    EXPECT_LT(pool.peakUsedBytes() - usedBefore, resultSize + 512 * 512);
+  }
+}
+
+TEST(ReadImageTest, pngScaled)
+{
+  ReadImageTestConfig config(File(getFilePath("lena.png")), 4);
+  config.executeBlocking();
+
+  auto images = config.images->takeElements();
+
+  ASSERT_EQ((size_t)1, images.size());
+  EXPECT_EQ((size_t)128, images[0].getHeight());
+  EXPECT_EQ((size_t)128, images[0].getWidth());
+  EXPECT_EQ(getFilePath("lena.png"), images[0].getFilename());
+}
+
+TEST(ReadImageTest, probe)
+{
+  ImageInfo info;
+  ASSERT_TRUE(Image::probe(getFilePath("lena.jpg"), info));
+  EXPECT_EQ((size_t)512, info.width);
+  EXPECT_EQ((size_t)512, info.height);
+  EXPECT_EQ(3u, info.channels);
+
+  EXPECT_FALSE(Image::probe(getFilePath("missing.jpg"), info));
+
+  const uint8 garbage[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  EXPECT_FALSE(Image::probe(garbage, sizeof(garbage), info));
+}
+
+TEST(ReadImageTest, nativeFormat)
+{
+  Image rgba;
+  ASSERT_TRUE(rgba.loadFromFile(getFilePath("lena.jpg")));
+  EXPECT_EQ(PixelFormat::Rgba8, rgba.getFormat());
+
+  for (unsigned scale : { 1, 2, 8 })
+  {
+    ReadImageTestConfig config(File(getFilePath("lena.jpg")), scale, true);
+    config.executeBlocking();
+
+    auto images = config.images->takeElements();
+
+    ASSERT_EQ((size_t)1, images.size());
+    EXPECT_EQ(PixelFormat::Rgb8, images[0].getFormat());
+    EXPECT_EQ((size_t)512 / scale, images[0].getWidth());
+    EXPECT_EQ(sizeof(Image) + 512 / scale * 512 / scale * 3, elementSize(images[0]));
+
+    Image expected;
+    ASSERT_TRUE(expected.loadFromFile(getFilePath("lena.jpg"), scale));
+    EXPECT_EQ(0.0, meanDifference(expected, images[0].convert(PixelFormat::Rgba8)));
+  }
+}
+
+TEST(ReadImageTest, grayscale)
+{
+  Image rgba;
+  ASSERT_TRUE(rgba.loadFromFile(getFilePath("lena.png")));
+
+  //gray image written by the encoder loads as one channel
+  Image gray = rgba.convert(PixelFormat::Gray8);
+  const std::string filename = "ReadImageTest_gray.png";
+  ASSERT_TRUE(gray.saveToPngFile(filename));
+
+  ImageInfo info;
+  ASSERT_TRUE(Image::probe(filename, info));
+  EXPECT_EQ(1u, info.channels);
+
+  Image loaded;
+  ASSERT_TRUE(loaded.loadFromFile(filename, 1, true));
+  EXPECT_EQ(PixelFormat::Gray8, loaded.getFormat());
+  EXPECT_EQ(0.0, meanDifference(gray, loaded));
+
+  ASSERT_TRUE(loaded.loadFromFile(filename, 4, true));
+  EXPECT_EQ(PixelFormat::Gray8, loaded.getFormat());
+  EXPECT_EQ((size_t)128, loaded.getWidth());
+
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,39 @@
+/**
+ * Copyright (C) 2016 Johannes Ohlemacher (https://github.com/teetime-framework/TeeTime-Cpp)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *         http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <teetime/Image.h>
+
+namespace teetime {
+namespace test {
+
+  /**
+   * Rgba8 image with a pixel pattern that differs in every channel (alpha is 255, if 'opaque' is set).
+   */
+  inline Image createImage(size_t width, size_t height, bool opaque = false)
+  {
+    Image image;
+    image.setSize(width, height);
+
+    for (size_t i = 0; i < width * height; ++i)
+    {
+      image.getRgba()[i] = Image::Rgba{ static_cast<uint8>(i * 7), static_cast<uint8>(i * 13), static_cast<uint8>(i), opaque ? uint8(255) : static_cast<uint8>(i * 3) };
+    }
+
+    return image;
+  }
+
+}
+}